@@ -0,0 +1,215 @@
+﻿# include <cmath>
+# include "CollisionGrid.hpp"
+
+namespace
+{
+	[[nodiscard]]
+	constexpr s3d::uint64 CellKey(const s3d::int32 x, const s3d::int32 y) noexcept
+	{
+		return ((static_cast<s3d::uint64>(static_cast<s3d::uint32>(x)) << 32) | static_cast<s3d::uint32>(y));
+	}
+
+	[[nodiscard]]
+	constexpr bool Overlaps(const s3d::Rect& a, const s3d::RectF& b) noexcept
+	{
+		return ((a.x <= (b.x + b.w)) && (b.x <= (a.x + a.w))
+			&& (a.y <= (b.y + b.h)) && (b.y <= (a.y + a.h)));
+	}
+}
+
+CollisionGrid::CollisionGrid(const s3d::int32 cellSize)
+	: m_cellSize{ cellSize } {}
+
+CollisionGrid::ID CollisionGrid::insert(const s3d::Rect& rect)
+{
+	ID id;
+
+	if (m_freeIDs)
+	{
+		id = m_freeIDs.back();
+		m_freeIDs.pop_back();
+		m_rects[id] = rect;
+		m_alive[id] = true;
+	}
+	else
+	{
+		id = static_cast<ID>(m_rects.size());
+		m_rects.push_back(rect);
+		m_alive.push_back(true);
+		m_stamps.push_back(0);
+	}
+
+	link(id);
+
+	return id;
+}
+
+void CollisionGrid::update(const ID id, const s3d::Rect& rect)
+{
+	if (not contains(id))
+	{
+		return;
+	}
+
+	const CellRange oldRange = cellRange(m_rects[id]);
+	const CellRange newRange = cellRange(rect);
+
+	// Small moves usually stay within the same cells
+	if ((oldRange.x0 == newRange.x0) && (oldRange.y0 == newRange.y0)
+		&& (oldRange.x1 == newRange.x1) && (oldRange.y1 == newRange.y1))
+	{
+		m_rects[id] = rect;
+		return;
+	}
+
+	unlink(id);
+	m_rects[id] = rect;
+	link(id);
+}
+
+void CollisionGrid::remove(const ID id)
+{
+	if (not contains(id))
+	{
+		return;
+	}
+
+	unlink(id);
+	m_alive[id] = false;
+	m_freeIDs.push_back(id);
+}
+
+void CollisionGrid::clear()
+{
+	m_cells.clear();
+	m_rects.clear();
+	m_alive.clear();
+	m_freeIDs.clear();
+	m_stamps.clear();
+	m_currentStamp = 0;
+}
+
+const s3d::Rect& CollisionGrid::get(const ID id) const noexcept
+{
+	return m_rects[id];
+}
+
+bool CollisionGrid::contains(const ID id) const noexcept
+{
+	return ((id < m_alive.size()) && m_alive[id]);
+}
+
+size_t CollisionGrid::size() const noexcept
+{
+	return (m_rects.size() - m_freeIDs.size());
+}
+
+s3d::int32 CollisionGrid::cellSize() const noexcept
+{
+	return m_cellSize;
+}
+
+void CollisionGrid::query(const s3d::RectF& region, s3d::Array<ID>& results) const
+{
+	results.clear();
+
+	if (++m_currentStamp == 0)
+	{
+		// The stamp wrapped around; forget stale stamps
+		m_stamps.fill(0);
+		m_currentStamp = 1;
+	}
+
+	const CellRange range = cellRange(region);
+
+	for (s3d::int32 y = range.y0; y <= range.y1; ++y)
+	{
+		for (s3d::int32 x = range.x0; x <= range.x1; ++x)
+		{
+			const auto it = m_cells.find(CellKey(x, y));
+
+			if (it == m_cells.end())
+			{
+				continue;
+			}
+
+			for (const ID id : it->second)
+			{
+				if (m_stamps[id] == m_currentStamp)
+				{
+					continue;
+				}
+
+				m_stamps[id] = m_currentStamp;
+
+				if (Overlaps(m_rects[id], region))
+				{
+					results.push_back(id);
+				}
+			}
+		}
+	}
+
+	// Sort by ID so that collision response does not depend on the order of the rects within the cells
+	results.sort();
+}
+
+void CollisionGrid::query(const s3d::Circle& circle, s3d::Array<ID>& results) const
+{
+	query(s3d::RectF{ (circle.x - circle.r), (circle.y - circle.r), (circle.r * 2), (circle.r * 2) }, results);
+}
+
+CollisionGrid::CellRange CollisionGrid::cellRange(const s3d::RectF& rect) const noexcept
+{
+	return{
+		static_cast<s3d::int32>(std::floor(rect.x / m_cellSize)),
+		static_cast<s3d::int32>(std::floor(rect.y / m_cellSize)),
+		static_cast<s3d::int32>(std::floor((rect.x + rect.w) / m_cellSize)),
+		static_cast<s3d::int32>(std::floor((rect.y + rect.h) / m_cellSize)),
+	};
+}
+
+void CollisionGrid::link(const ID id)
+{
+	const CellRange range = cellRange(m_rects[id]);
+
+	for (s3d::int32 y = range.y0; y <= range.y1; ++y)
+	{
+		for (s3d::int32 x = range.x0; x <= range.x1; ++x)
+		{
+			m_cells[CellKey(x, y)].push_back(id);
+		}
+	}
+}
+
+void CollisionGrid::unlink(const ID id)
+{
+	const CellRange range = cellRange(m_rects[id]);
+
+	for (s3d::int32 y = range.y0; y <= range.y1; ++y)
+	{
+		for (s3d::int32 x = range.x0; x <= range.x1; ++x)
+		{
+			const auto it = m_cells.find(CellKey(x, y));
+
+			if (it == m_cells.end())
+			{
+				continue;
+			}
+
+			auto& ids = it->second;
+
+			if (const auto pos = std::find(ids.begin(), ids.end(), id);
+				pos != ids.end())
+			{
+				*pos = ids.back();
+				ids.pop_back();
+			}
+
+			if (not ids)
+			{
+				m_cells.erase(it);
+			}
+		}
+	}
+}
@@ -0,0 +1,80 @@
+﻿# pragma once
+# include <Siv3D/Array.hpp>
+# include <Siv3D/HashTable.hpp>
+# include <Siv3D/2DShapes.hpp>
+
+// Broad-phase index for level collision.
+// Rects are bucketed into a sparse uniform grid so that a query only visits the rects
+// stored in the cells it touches instead of scanning the whole level.
+class CollisionGrid
+{
+public:
+
+	using ID = s3d::uint32;
+
+	static constexpr s3d::int32 DefaultCellSize = 128;
+
+	CollisionGrid() = default;
+
+	explicit CollisionGrid(s3d::int32 cellSize);
+
+	// Adds a rect and returns the ID used to update or remove it later
+	ID insert(const s3d::Rect& rect);
+
+	// Moves an existing rect, e.g. for moving platforms. Does nothing if id is not stored
+	void update(ID id, const s3d::Rect& rect);
+
+	// Does nothing if id is not stored
+	void remove(ID id);
+
+	void clear();
+
+	[[nodiscard]]
+	const s3d::Rect& get(ID id) const noexcept;
+
+	// Whether id refers to a rect currently stored (IDs of removed rects are reused by insert)
+	[[nodiscard]]
+	bool contains(ID id) const noexcept;
+
+	// Number of rects currently stored
+	[[nodiscard]]
+	size_t size() const noexcept;
+
+	[[nodiscard]]
+	s3d::int32 cellSize() const noexcept;
+
+	// Replaces results with the IDs of the rects intersecting region, in ascending order
+	void query(const s3d::RectF& region, s3d::Array<ID>& results) const;
+
+	// Replaces results with the IDs of the rects intersecting the bounding rect of circle, in ascending order
+	void query(const s3d::Circle& circle, s3d::Array<ID>& results) const;
+
+private:
+
+	struct CellRange
+	{
+		s3d::int32 x0, y0, x1, y1;
+	};
+
+	s3d::int32 m_cellSize = DefaultCellSize;
+
+	s3d::HashTable<s3d::uint64, s3d::Array<ID>> m_cells;
+
+	s3d::Array<s3d::Rect> m_rects;
+
+	s3d::Array<bool> m_alive;
+
+	s3d::Array<ID> m_freeIDs;
+
+	// Per-rect query stamps used to report each rect once even if it spans several cells
+	mutable s3d::Array<s3d::uint32> m_stamps;
+
+	mutable s3d::uint32 m_currentStamp = 0;
+
+	[[nodiscard]]
+	CellRange cellRange(const s3d::RectF& rect) const noexcept;
+
+	void link(ID id);
+
+	void unlink(ID id);
+};
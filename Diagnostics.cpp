@@ -0,0 +1,582 @@
+﻿# include "Diagnostics.hpp"
+# include "CollisionGrid.hpp"
+# include "InputRecording.hpp"
+# include "PlatformerWorld.hpp"
+# include "Snapshot.hpp"
+# include "TileMap.hpp"
+# include "TileRects.hpp"
+
+namespace
+{
+	constexpr double StepSeconds = (1.0 / 120.0);
+
+	// Whether rects are aligned to the tiles and cover every solid tile exactly once and no other tile
+	[[nodiscard]]
+	bool CoversExactly(const s3d::Array<s3d::Rect>& rects, const s3d::Grid<bool>& solid, const s3d::int32 tileSize)
+	{
+		s3d::Grid<s3d::int32> coverage(solid.size(), 0);
+
+		for (const auto& rect : rects)
+		{
+			if ((rect.x % tileSize) || (rect.y % tileSize) || (rect.w % tileSize) || (rect.h % tileSize) || rect.isEmpty())
+			{
+				return false;
+			}
+
+			const s3d::Rect tiles{ (rect.x / tileSize), (rect.y / tileSize), (rect.w / tileSize), (rect.h / tileSize) };
+
+			for (auto p : s3d::step(tiles.pos, tiles.size))
+			{
+				if (not coverage.inBounds(p))
+				{
+					return false;
+				}
+
+				++coverage[p];
+			}
+		}
+
+		for (auto p : s3d::step(solid.size()))
+		{
+			if (coverage[p] != (solid[p] ? 1 : 0))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Drops the player at position, at rest, without changing the level
+	void PlacePlayer(PlatformerWorld& world, const s3d::Vec2& position)
+	{
+		PlatformerState state;
+		state.playerPosition = position;
+		state.isOnGround = false;
+		world.setState(state);
+	}
+
+	constexpr s3d::int32 BenchmarkRepeats = 10;
+
+	// Best time of BenchmarkRepeats runs of f, in seconds
+	template <class Fty>
+	[[nodiscard]]
+	double BestSeconds(Fty f)
+	{
+		double best = std::numeric_limits<double>::infinity();
+
+		for (s3d::int32 i = 0; i < BenchmarkRepeats; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+
+			f();
+
+			const auto end = std::chrono::steady_clock::now();
+
+			best = s3d::Min(best, std::chrono::duration<double>(end - start).count());
+		}
+
+		return best;
+	}
+
+	// The split Array::parallel_each used before ThreadPool: a new std::async thread per core on every call
+	template <class Fty>
+	void AsyncParallelEach(s3d::Array<double>& values, Fty f)
+	{
+		const size_t numThreads = s3d::Threading::GetConcurrency();
+
+		if (numThreads <= 1)
+		{
+			values.each(f);
+			return;
+		}
+
+		const size_t countPerthread = s3d::Max<size_t>(1, (values.size() + (numThreads - 1)) / numThreads);
+
+		s3d::Array<std::future<void>> futures;
+
+		auto it = values.begin();
+		size_t countLeft = values.size();
+
+		for (size_t i = 0; i < (numThreads - 1); ++i)
+		{
+			const size_t n = s3d::Min(countPerthread, countLeft);
+
+			if (n == 0)
+			{
+				break;
+			}
+
+			futures.emplace_back(std::async(std::launch::async, [=, &f]()
+				{
+					std::for_each(it, it + n, f);
+				}));
+
+			it += n;
+			countLeft -= n;
+		}
+
+		if (countLeft)
+		{
+			std::for_each(it, it + countLeft, f);
+		}
+
+		for (auto& future : futures)
+		{
+			future.get();
+		}
+	}
+
+	[[nodiscard]]
+	s3d::String FormatBenchmark(const BenchmarkResult& result)
+	{
+		return U"{}: {:.1f} us -> {:.1f} us (x{:.2f}){}"_fmt(result.name,
+			(result.baselineSeconds * 1e6), (result.seconds * 1e6), result.speedup(),
+			(result.resultsMatch ? U"" : U" RESULTS DIFFER"));
+	}
+
+	template <class Shape, class Type>
+	[[nodiscard]]
+	BenchmarkResult BenchmarkIntersect(s3d::String name, const Shape& shape, const s3d::Array<Type>& targets)
+	{
+		s3d::Array<bool> results(targets.size());
+
+		BenchmarkResult result{ .name = std::move(name) };
+
+		result.baselineSeconds = BestSeconds([&]()
+			{
+				for (size_t i = 0; i < targets.size(); ++i)
+				{
+					results[i] = s3d::Geometry2D::Intersect(shape, targets[i]);
+				}
+			});
+
+		result.seconds = BestSeconds([&]()
+			{
+				(void)s3d::Geometry2D::IntersectMany(shape, std::span<const Type>{ targets }, std::span<bool>{ results });
+			});
+
+		return result;
+	}
+}
+
+double BenchmarkResult::speedup() const noexcept
+{
+	return ((seconds == 0.0) ? 0.0 : (baselineSeconds / seconds));
+}
+
+bool CheckRestingPlayerCanJump()
+{
+	const s3d::Rect platform{ 200, 300, 200, 20 };
+	const double restY = (platform.y - PLAYER_RADIUS);
+
+	PlatformerWorld world{ { platform } };
+	PlacePlayer(world, s3d::Vec2{ 300, (restY - 50) });
+
+	// Fall onto the platform and stay there for a while
+	for (s3d::int32 i = 0; i < 120; ++i)
+	{
+		world.step(StepSeconds, InputFrame{});
+	}
+
+	if ((0.01 < s3d::Abs(world.state().playerPosition.y - restY)) || (not world.state().isOnGround))
+	{
+		return false;
+	}
+
+	InputFrame jump;
+	jump.jump = true;
+	jump.jumpDown = true;
+	world.step(StepSeconds, jump);
+
+	jump.jumpDown = false;
+
+	for (s3d::int32 i = 0; i < 10; ++i)
+	{
+		world.step(StepSeconds, jump);
+	}
+
+	return ((world.state().playerPosition.y < (restY - 10.0)) && (not world.state().isOnGround));
+}
+
+bool CheckStateSnapshotRoundTrip()
+{
+	PlatformerWorld world{ MakeDefaultLevel() };
+	InputFrame input;
+	input.right = true;
+	input.jump = true;
+
+	for (s3d::int32 i = 0; i < 30; ++i)
+	{
+		world.step(StepSeconds, input);
+	}
+
+	s3d::Blob snapshot;
+	{
+		SnapshotWriter writer{ snapshot };
+		world.saveState(writer);
+	}
+
+	const s3d::uint64 savedHash = HashState(world.state());
+
+	for (s3d::int32 i = 0; i < 30; ++i)
+	{
+		world.step(StepSeconds, InputFrame{});
+	}
+
+	const s3d::uint64 steppedHash = HashState(world.state());
+
+	// Truncated, or written by another version (the version comes first)
+	s3d::Blob truncated{ snapshot.data(), (snapshot.size() - 1) };
+	s3d::Blob otherVersion = snapshot;
+	otherVersion.data()[0] ^= s3d::Byte{ 1 };
+
+	for (const auto* invalid : { &truncated, &otherVersion })
+	{
+		SnapshotReader reader{ *invalid };
+
+		if (world.loadState(reader) || (HashState(world.state()) != steppedHash))
+		{
+			return false;
+		}
+	}
+
+	SnapshotReader reader{ snapshot };
+
+	return (world.loadState(reader)
+		&& (reader.remaining() == 0)
+		&& (HashState(world.state()) == savedHash));
+}
+
+bool CheckMergeSolidTilesCoverage()
+{
+	s3d::SmallRNG rng{ 12345 };
+
+	for (const double density : { 0.0, 0.2, 0.5, 0.9, 1.0 })
+	{
+		s3d::Grid<bool> solid(41, 29);
+
+		for (auto& tile : solid)
+		{
+			tile = s3d::RandomBool(density, rng);
+		}
+
+		const s3d::Array<s3d::Rect> rects = MergeSolidTiles(solid, 8, s3d::Point{ 0, 0 });
+
+		if (not CoversExactly(rects, solid, 8))
+		{
+			return false;
+		}
+
+		// A full map is a single rect
+		if ((density == 1.0) && (rects.size() != 1))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool CheckTileMapLevelRoundTrip()
+{
+	// Every rect of the hand-placed level is aligned to 10-pixel tiles
+	constexpr s3d::int32 TileSize = 10;
+	s3d::Grid<s3d::uint16> tiles(100, 50, StreamedTileMap::EmptyTile);
+	s3d::Grid<bool> solid(tiles.size(), false);
+
+	for (const auto& rect : MakeDefaultLevel())
+	{
+		for (auto p : s3d::step((rect.pos / TileSize), (rect.size / TileSize)))
+		{
+			tiles[p] = 1;
+			solid[p] = true;
+		}
+	}
+
+	const s3d::FilePath path = s3d::FileSystem::UniqueFilePath();
+
+	// A small chunk size so that the level spans several chunks, some of them empty
+	if (not SaveTileMap(path, tiles, TileSize, 16))
+	{
+		return false;
+	}
+
+	const s3d::Array<s3d::Rect> level = LoadTileMapLevel(path);
+	s3d::FileSystem::Remove(path);
+
+	return CoversExactly(level, solid, TileSize);
+}
+
+bool CheckGridParallelAndWindow()
+{
+	s3d::SmallRNG rng{ 12345 };
+
+	s3d::Grid<bool> grid(37, 23);
+
+	for (auto& cell : grid)
+	{
+		cell = s3d::RandomBool(0.3, rng);
+	}
+
+	const size_t expected = grid.count(true);
+
+	if (grid.parallel_count_if([](const bool cell) { return cell; }) != expected)
+	{
+		return false;
+	}
+
+	const s3d::Grid<bool> inverted = grid.parallel_map([](const bool cell) { return (not cell); });
+
+	grid.parallel_each([](bool& cell) { cell = (not cell); });
+
+	if ((grid != inverted) || (grid.count(false) != expected))
+	{
+		return false;
+	}
+
+	// Offsets beyond the radius from an interior position are clamped like those from the edges
+	s3d::Grid<s3d::int32> values(8, 8);
+
+	for (size_t i = 0; i < values.num_elements(); ++i)
+	{
+		values.data()[i] = static_cast<s3d::int32>(i);
+	}
+
+	s3d::GridWindow<s3d::int32> window{ values.data(), values.width(), values.height(), 1 };
+	window.moveTo(s3d::Point{ 3, 3 });
+
+	return (window.isInterior()
+		&& (window(1, -1) == values[2][4])
+		&& (window(100, 0) == values[3][7])
+		&& (window(-100, -100) == values[0][0])
+		&& (window(0, 100) == values[7][3]));
+}
+
+bool CheckIntersectManyMatchesScalar()
+{
+	s3d::SmallRNG rng{ 12345 };
+	const auto random = [&](const s3d::int32 max) { return s3d::Random(0, max, rng); };
+
+	s3d::Array<s3d::Rect> rects(64);
+	s3d::Array<s3d::Circle> circles(64);
+	s3d::Array<bool> results(64);
+
+	for (s3d::int32 i = 0; i < 10000; ++i)
+	{
+		for (auto& rect : rects)
+		{
+			rect = s3d::Rect{ random(50), random(50), random(12), random(12) };
+		}
+
+		for (auto& circle : circles)
+		{
+			circle = s3d::Circle{ random(50), random(50), random(12) };
+		}
+
+		s3d::Line line{ random(50), random(50), random(50), random(50) };
+
+		// Axis-aligned lines take a separate path in the kernel
+		if ((i % 8) == 0)
+		{
+			line.end.x = line.begin.x;
+		}
+		else if ((i % 8) == 1)
+		{
+			line.end.y = line.begin.y;
+		}
+
+		const s3d::Circle circle{ random(50), random(50), random(12) };
+
+		(void)s3d::Geometry2D::IntersectMany(line, std::span<const s3d::Rect>{ rects }, std::span<bool>{ results });
+
+		for (size_t k = 0; k < rects.size(); ++k)
+		{
+			if (results[k] != s3d::Geometry2D::Intersect(line, rects[k]))
+			{
+				return false;
+			}
+		}
+
+		(void)s3d::Geometry2D::IntersectMany(circle, std::span<const s3d::Rect>{ rects }, std::span<bool>{ results });
+
+		for (size_t k = 0; k < rects.size(); ++k)
+		{
+			if (results[k] != s3d::Geometry2D::Intersect(circle, rects[k]))
+			{
+				return false;
+			}
+		}
+
+		(void)s3d::Geometry2D::IntersectMany(circle, std::span<const s3d::Circle>{ circles }, std::span<bool>{ results });
+
+		for (size_t k = 0; k < circles.size(); ++k)
+		{
+			if (results[k] != s3d::Geometry2D::Intersect(circle, circles[k]))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+s3d::Array<BenchmarkResult> BenchmarkIntersectMany(const size_t count)
+{
+	s3d::SmallRNG rng{ 12345 };
+	const auto random = [&](const double max) { return s3d::Random(max, rng); };
+
+	s3d::Array<s3d::Rect> rects(count);
+	s3d::Array<s3d::RectF> rectFs(count);
+	s3d::Array<s3d::Circle> circles(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		rects[i] = s3d::Rect{ static_cast<s3d::int32>(random(1000)), static_cast<s3d::int32>(random(1000)), static_cast<s3d::int32>(random(60)), static_cast<s3d::int32>(random(60)) };
+		rectFs[i] = s3d::RectF{ random(1000), random(1000), random(60), random(60) };
+		circles[i] = s3d::Circle{ random(1000), random(1000), random(30) };
+	}
+
+	const s3d::Circle circle{ 500, 500, 40 };
+	const s3d::Line line{ 0, 0, 1000, 1000 };
+
+	return{
+		BenchmarkIntersect(U"Circle vs {} Rect"_fmt(count), circle, rects),
+		BenchmarkIntersect(U"Circle vs {} RectF"_fmt(count), circle, rectFs),
+		BenchmarkIntersect(U"Circle vs {} Circle"_fmt(count), circle, circles),
+		BenchmarkIntersect(U"Line vs {} Rect"_fmt(count), line, rects),
+	};
+}
+
+BenchmarkResult BenchmarkCollisionGrid(const size_t count)
+{
+	s3d::SmallRNG rng{ 12345 };
+	const auto random = [&](const s3d::int32 min, const s3d::int32 max) { return s3d::Random(min, max, rng); };
+
+	// Platform-sized rects, one per 150 x 150 area on average
+	const s3d::int32 worldSize = static_cast<s3d::int32>(std::sqrt(static_cast<double>(count)) * 150);
+
+	s3d::Array<s3d::Rect> rects(count);
+	CollisionGrid grid;
+
+	for (auto& rect : rects)
+	{
+		rect = s3d::Rect{ random(0, worldSize), random(0, worldSize), random(20, 100), random(10, 40) };
+		grid.insert(rect);
+	}
+
+	const size_t queryCount = s3d::Max<size_t>((1'000'000 / count), 100);
+	s3d::Array<s3d::Circle> circles(queryCount);
+
+	for (auto& circle : circles)
+	{
+		circle = s3d::Circle{ random(0, worldSize), random(0, worldSize), PLAYER_RADIUS };
+	}
+
+	s3d::Array<CollisionGrid::ID> candidates;
+	size_t baselineHits = 0;
+	size_t gridHits = 0;
+
+	BenchmarkResult result{ .name = U"{} circle queries vs {} level rects"_fmt(queryCount, count) };
+
+	result.baselineSeconds = BestSeconds([&]()
+		{
+			baselineHits = 0;
+
+			for (const auto& circle : circles)
+			{
+				for (const auto& rect : rects)
+				{
+					baselineHits += circle.intersects(rect);
+				}
+			}
+		});
+
+	result.seconds = BestSeconds([&]()
+		{
+			gridHits = 0;
+
+			for (const auto& circle : circles)
+			{
+				grid.query(circle, candidates);
+
+				for (const auto id : candidates)
+				{
+					gridHits += circle.intersects(grid.get(id));
+				}
+			}
+		});
+
+	// The grid only skips rects that cannot intersect, so both must find the same hits
+	result.resultsMatch = (baselineHits == gridHits);
+	result.name += U" ({} hits)"_fmt(gridHits);
+
+	return result;
+}
+
+BenchmarkResult BenchmarkThreadPool(const size_t count)
+{
+	s3d::Array<double> values(count, 1.0);
+
+	const auto f = [](double& value) { value = std::sqrt(value + 1.0); };
+
+	BenchmarkResult result{ .name = U"parallel each on {} doubles"_fmt(count) };
+
+	result.baselineSeconds = BestSeconds([&]()
+		{
+			AsyncParallelEach(values, f);
+		});
+
+	result.seconds = BestSeconds([&]()
+		{
+			s3d::ThreadPool::Global().parallelFor(0, values.size(), [&](const size_t first, const size_t last)
+				{
+					std::for_each((values.begin() + first), (values.begin() + last), f);
+				});
+		});
+
+	return result;
+}
+
+s3d::Array<s3d::String> RunDiagnostics()
+{
+	s3d::Array<s3d::String> lines;
+
+	const auto addCheck = [&](const s3d::StringView name, const bool passed)
+		{
+			lines << U"{}: {}"_fmt(name, (passed ? U"ok" : U"FAILED"));
+		};
+
+	const auto addBenchmarks = [&](const s3d::Array<BenchmarkResult>& results)
+		{
+			for (const auto& result : results)
+			{
+				lines << FormatBenchmark(result);
+			}
+		};
+
+	addCheck(U"CheckRestingPlayerCanJump", CheckRestingPlayerCanJump());
+	addCheck(U"CheckStateSnapshotRoundTrip", CheckStateSnapshotRoundTrip());
+	addCheck(U"CheckMergeSolidTilesCoverage", CheckMergeSolidTilesCoverage());
+	addCheck(U"CheckTileMapLevelRoundTrip", CheckTileMapLevelRoundTrip());
+	addCheck(U"CheckGridParallelAndWindow", CheckGridParallelAndWindow());
+	addCheck(U"CheckIntersectManyMatchesScalar", CheckIntersectManyMatchesScalar());
+
+	addBenchmarks(BenchmarkIntersectMany(1'000));
+	addBenchmarks({ BenchmarkCollisionGrid(100) });
+	addBenchmarks({ BenchmarkThreadPool(1'000), BenchmarkThreadPool(10'000) });
+
+	return lines;
+}
+
+s3d::Array<s3d::String> RunBenchmarks()
+{
+	s3d::Array<BenchmarkResult> results = BenchmarkIntersectMany(100'000);
+	results.append({
+		BenchmarkCollisionGrid(10'000), BenchmarkCollisionGrid(1'000'000),
+		BenchmarkThreadPool(100'000), BenchmarkThreadPool(1'000'000), BenchmarkThreadPool(10'000'000),
+	});
+
+	return results.map(FormatBenchmark);
+}
@@ -0,0 +1,71 @@
+﻿# pragma once
+# include <Siv3D.hpp>
+
+// Headless checks and micro-benchmarks of the simulation and the engine code it relies on
+// ([F9] in Main runs the checks and the quick benchmarks; the --benchmark command-line option runs the large ones
+// without entering the game loop. Build in Release for meaningful timings)
+
+// Time taken by the previous way of doing something (baseline) and by the current one
+struct BenchmarkResult
+{
+	s3d::String name;
+
+	// Best of several runs
+	double baselineSeconds = 0.0;
+
+	double seconds = 0.0;
+
+	// Whether both versions produced the same results
+	bool resultsMatch = true;
+
+	[[nodiscard]]
+	double speedup() const noexcept;
+};
+
+// A player dropped onto a platform comes to rest on it, is grounded, and leaves it when jumping
+[[nodiscard]]
+bool CheckRestingPlayerCanJump();
+
+// A state restored by loadState() equals the saved one, and truncated or foreign snapshots are rejected without changing the world
+[[nodiscard]]
+bool CheckStateSnapshotRoundTrip();
+
+// MergeSolidTiles() covers every solid tile of random maps exactly once and no other tile
+[[nodiscard]]
+bool CheckMergeSolidTilesCoverage();
+
+// The hand-placed level survives a round trip through SaveTileMap() and LoadTileMapLevel(), i.e. StreamedTileMap
+[[nodiscard]]
+bool CheckTileMapLevelRoundTrip();
+
+// Grid<bool> supports the parallel_* operations with the same results as the serial ones,
+// and GridWindow returns the nearest edge element for offsets beyond its radius
+[[nodiscard]]
+bool CheckGridParallelAndWindow();
+
+// Geometry2D::IntersectMany gives the same results as Geometry2D::Intersect for random small integer shapes,
+// which include many exact edge and corner contacts
+[[nodiscard]]
+bool CheckIntersectManyMatchesScalar();
+
+// Geometry2D::Intersect called in a loop versus Geometry2D::IntersectMany, against count shapes
+[[nodiscard]]
+s3d::Array<BenchmarkResult> BenchmarkIntersectMany(size_t count);
+
+// Checking every level rect against a circle versus querying CollisionGrid first, for count rects spread at a constant density
+// (the number of queries shrinks as count grows to keep the scan affordable)
+[[nodiscard]]
+BenchmarkResult BenchmarkCollisionGrid(size_t count);
+
+// The per-call std::async split that Array::parallel_* used before (one thread per core, started on every call)
+// versus ThreadPool::Global().parallelFor, applying a cheap function to count doubles
+[[nodiscard]]
+BenchmarkResult BenchmarkThreadPool(size_t count);
+
+// Runs every check and the benchmarks quick enough for the game loop; one line per result
+[[nodiscard]]
+s3d::Array<s3d::String> RunDiagnostics();
+
+// Runs the benchmarks on large inputs, which take seconds; one line per result
+[[nodiscard]]
+s3d::Array<s3d::String> RunBenchmarks();
@@ -0,0 +1,632 @@
+﻿# include <cmath>
+# include "DynamicAABBTree.hpp"
+
+namespace
+{
+	[[nodiscard]]
+	s3d::RectF Union(const s3d::RectF& a, const s3d::RectF& b) noexcept
+	{
+		const double left = s3d::Min(a.x, b.x);
+		const double top = s3d::Min(a.y, b.y);
+		const double right = s3d::Max((a.x + a.w), (b.x + b.w));
+		const double bottom = s3d::Max((a.y + a.h), (b.y + b.h));
+		return{ left, top, (right - left), (bottom - top) };
+	}
+
+	// Surface area heuristic cost of a box
+	[[nodiscard]]
+	constexpr double Perimeter(const s3d::RectF& rect) noexcept
+	{
+		return (2.0 * (rect.w + rect.h));
+	}
+
+	[[nodiscard]]
+	constexpr bool Contains(const s3d::RectF& outer, const s3d::RectF& inner) noexcept
+	{
+		return ((outer.x <= inner.x) && (outer.y <= inner.y)
+			&& ((inner.x + inner.w) <= (outer.x + outer.w))
+			&& ((inner.y + inner.h) <= (outer.y + outer.h)));
+	}
+
+	[[nodiscard]]
+	constexpr bool Overlaps(const s3d::RectF& a, const s3d::RectF& b) noexcept
+	{
+		return ((a.x <= (b.x + b.w)) && (b.x <= (a.x + a.w))
+			&& (a.y <= (b.y + b.h)) && (b.y <= (a.y + a.h)));
+	}
+
+	// Distance along the ray at which it enters rect, 0 if origin is already inside
+	[[nodiscard]]
+	s3d::Optional<double> RaycastRect(const s3d::RectF& rect, const s3d::Vec2& origin, const s3d::Vec2& direction, const double maxDistance) noexcept
+	{
+		double tMin = 0.0;
+		double tMax = maxDistance;
+
+		const auto clip = [&](const double o, const double d, const double lo, const double hi)
+			{
+				if (d == 0.0)
+				{
+					return ((lo <= o) && (o <= hi));
+				}
+
+				const double t0 = ((lo - o) / d);
+				const double t1 = ((hi - o) / d);
+				tMin = s3d::Max(tMin, s3d::Min(t0, t1));
+				tMax = s3d::Min(tMax, s3d::Max(t0, t1));
+				return (tMin <= tMax);
+			};
+
+		if (clip(origin.x, direction.x, rect.x, (rect.x + rect.w))
+			&& clip(origin.y, direction.y, rect.y, (rect.y + rect.h)))
+		{
+			return tMin;
+		}
+
+		return s3d::none;
+	}
+}
+
+DynamicAABBTree::DynamicAABBTree(const double margin)
+	: m_margin{ margin } {}
+
+DynamicAABBTree::ID DynamicAABBTree::insert(const s3d::RectF& rect)
+{
+	return insertProxy(rect, -1.0);
+}
+
+DynamicAABBTree::ID DynamicAABBTree::insert(const s3d::Circle& circle)
+{
+	return insertProxy(circle.boundingRect(), circle.r);
+}
+
+bool DynamicAABBTree::update(const ID id, const s3d::RectF& rect)
+{
+	return updateProxy(id, rect, -1.0);
+}
+
+bool DynamicAABBTree::update(const ID id, const s3d::Circle& circle)
+{
+	return updateProxy(id, circle.boundingRect(), circle.r);
+}
+
+void DynamicAABBTree::remove(const ID id)
+{
+	if (not contains(id))
+	{
+		return;
+	}
+
+	removeLeaf(id);
+	freeNode(id);
+	--m_proxyCount;
+}
+
+void DynamicAABBTree::clear()
+{
+	m_nodes.clear();
+	m_root = NullID;
+	m_freeList = NullID;
+	m_proxyCount = 0;
+}
+
+bool DynamicAABBTree::contains(const ID id) const noexcept
+{
+	// Internal nodes and unused nodes share the pool with the leaves
+	return ((id < m_nodes.size()) && (m_nodes[id].height == 0));
+}
+
+const s3d::RectF& DynamicAABBTree::getBounds(const ID id) const noexcept
+{
+	static constexpr s3d::RectF Empty{ 0, 0, 0, 0 };
+
+	if (not contains(id))
+	{
+		return Empty;
+	}
+
+	return m_nodes[id].bounds;
+}
+
+bool DynamicAABBTree::isCircle(const ID id) const noexcept
+{
+	return (contains(id) && (0.0 <= m_nodes[id].radius));
+}
+
+size_t DynamicAABBTree::size() const noexcept
+{
+	return m_proxyCount;
+}
+
+s3d::int32 DynamicAABBTree::height() const noexcept
+{
+	return ((m_root == NullID) ? 0 : m_nodes[m_root].height);
+}
+
+void DynamicAABBTree::query(const s3d::RectF& region, s3d::Array<ID>& results) const
+{
+	results.clear();
+
+	if (m_root == NullID)
+	{
+		return;
+	}
+
+	m_stack.clear();
+	m_stack.push_back(m_root);
+
+	while (m_stack)
+	{
+		const ID id = m_stack.back();
+		m_stack.pop_back();
+
+		const Node& node = m_nodes[id];
+
+		if (not Overlaps(node.fatBounds, region))
+		{
+			continue;
+		}
+
+		if (node.isLeaf())
+		{
+			if (intersects(node, region))
+			{
+				results.push_back(id);
+			}
+		}
+		else
+		{
+			m_stack.push_back(node.child1);
+			m_stack.push_back(node.child2);
+		}
+	}
+
+	// Sort by ID so that collision response does not depend on the tree layout (IDs are reused node slots, not insertion order)
+	results.sort();
+}
+
+void DynamicAABBTree::queryPairs(s3d::Array<std::pair<ID, ID>>& results) const
+{
+	results.clear();
+
+	if (m_root == NullID)
+	{
+		return;
+	}
+
+	for (ID a = 0; a < m_nodes.size(); ++a)
+	{
+		const Node& leaf = m_nodes[a];
+
+		if (leaf.height != 0)
+		{
+			continue;
+		}
+
+		m_stack.clear();
+		m_stack.push_back(m_root);
+
+		while (m_stack)
+		{
+			const ID id = m_stack.back();
+			m_stack.pop_back();
+
+			const Node& node = m_nodes[id];
+
+			if (not Overlaps(node.fatBounds, leaf.bounds))
+			{
+				continue;
+			}
+
+			if (not node.isLeaf())
+			{
+				m_stack.push_back(node.child1);
+				m_stack.push_back(node.child2);
+			}
+			else if ((a < id) && intersects(leaf, node))
+			{
+				// Each pair is found from both of its proxies; only the one with the smaller ID reports it
+				results.emplace_back(a, id);
+			}
+		}
+	}
+
+	results.sort();
+}
+
+s3d::Optional<DynamicAABBTree::RaycastHit> DynamicAABBTree::raycast(const s3d::Vec2& origin, const s3d::Vec2& direction, double maxDistance) const
+{
+	if ((m_root == NullID) || direction.isZero())
+	{
+		return s3d::none;
+	}
+
+	const s3d::Vec2 normalizedDirection = direction.normalized();
+	s3d::Optional<RaycastHit> closest;
+
+	m_stack.clear();
+	m_stack.push_back(m_root);
+
+	while (m_stack)
+	{
+		const ID id = m_stack.back();
+		m_stack.pop_back();
+
+		const Node& node = m_nodes[id];
+
+		// maxDistance shrinks to the closest hit so far, which prunes everything farther away
+		if (not RaycastRect(node.fatBounds, origin, normalizedDirection, maxDistance))
+		{
+			continue;
+		}
+
+		if (not node.isLeaf())
+		{
+			m_stack.push_back(node.child1);
+			m_stack.push_back(node.child2);
+		}
+		else if (const auto distance = raycastProxy(node, origin, normalizedDirection, maxDistance))
+		{
+			if ((not closest) || (*distance < closest->distance) || ((*distance == closest->distance) && (id < closest->id)))
+			{
+				closest = RaycastHit{ id, *distance, (origin + normalizedDirection * (*distance)) };
+				maxDistance = *distance;
+			}
+		}
+	}
+
+	return closest;
+}
+
+s3d::Optional<DynamicAABBTree::RaycastHit> DynamicAABBTree::raycast(const s3d::Line& segment) const
+{
+	const s3d::Vec2 direction = segment.vector();
+	const double length = direction.length();
+
+	// A zero-length segment is a point query
+	return raycast(segment.begin, ((length == 0.0) ? s3d::Vec2{ 1, 0 } : direction), length);
+}
+
+DynamicAABBTree::ID DynamicAABBTree::allocateNode()
+{
+	if (m_freeList == NullID)
+	{
+		m_nodes.emplace_back();
+		return static_cast<ID>(m_nodes.size() - 1);
+	}
+
+	const ID id = m_freeList;
+	m_freeList = m_nodes[id].parent;
+	m_nodes[id] = Node{};
+	return id;
+}
+
+void DynamicAABBTree::freeNode(const ID id)
+{
+	m_nodes[id].height = -1;
+	m_nodes[id].child1 = NullID;
+	m_nodes[id].child2 = NullID;
+	m_nodes[id].parent = m_freeList;
+	m_freeList = id;
+}
+
+DynamicAABBTree::ID DynamicAABBTree::insertProxy(const s3d::RectF& bounds, const double radius)
+{
+	const ID id = allocateNode();
+	Node& node = m_nodes[id];
+	node.bounds = bounds;
+	node.radius = radius;
+	node.fatBounds = bounds.stretched(m_margin);
+	node.height = 0;
+
+	insertLeaf(id);
+	++m_proxyCount;
+
+	return id;
+}
+
+bool DynamicAABBTree::updateProxy(const ID id, const s3d::RectF& bounds, const double radius)
+{
+	if (not contains(id))
+	{
+		return false;
+	}
+
+	Node& node = m_nodes[id];
+	node.bounds = bounds;
+	node.radius = radius;
+
+	// Small moves stay inside the grown AABB; a proxy that shrank a lot is refitted so that it stops producing false candidates
+	if (Contains(node.fatBounds, bounds)
+		&& Contains(bounds.stretched(m_margin * 4), node.fatBounds))
+	{
+		return false;
+	}
+
+	removeLeaf(id);
+	m_nodes[id].fatBounds = bounds.stretched(m_margin);
+	insertLeaf(id);
+
+	return true;
+}
+
+void DynamicAABBTree::insertLeaf(const ID leaf)
+{
+	if (m_root == NullID)
+	{
+		m_root = leaf;
+		m_nodes[leaf].parent = NullID;
+		return;
+	}
+
+	// Descend to the sibling that minimizes the total perimeter of the tree
+	const s3d::RectF leafBounds = m_nodes[leaf].fatBounds;
+	ID index = m_root;
+
+	while (not m_nodes[index].isLeaf())
+	{
+		const Node& node = m_nodes[index];
+		const double area = Perimeter(node.fatBounds);
+		const double combinedArea = Perimeter(Union(node.fatBounds, leafBounds));
+
+		// Cost of making a new parent of this node and the leaf
+		const double cost = (2.0 * combinedArea);
+
+		// Minimum cost of pushing the leaf further down
+		const double inheritanceCost = (2.0 * (combinedArea - area));
+
+		const auto descendCost = [&](const ID child)
+			{
+				const Node& c = m_nodes[child];
+				const double unionArea = Perimeter(Union(leafBounds, c.fatBounds));
+				return ((c.isLeaf() ? unionArea : (unionArea - Perimeter(c.fatBounds))) + inheritanceCost);
+			};
+
+		const double cost1 = descendCost(node.child1);
+		const double cost2 = descendCost(node.child2);
+
+		if ((cost < cost1) && (cost < cost2))
+		{
+			break;
+		}
+
+		index = ((cost1 < cost2) ? node.child1 : node.child2);
+	}
+
+	const ID sibling = index;
+	const ID oldParent = m_nodes[sibling].parent;
+	const ID newParent = allocateNode();
+
+	{
+		Node& parent = m_nodes[newParent];
+		parent.parent = oldParent;
+		parent.fatBounds = Union(leafBounds, m_nodes[sibling].fatBounds);
+		parent.height = (m_nodes[sibling].height + 1);
+		parent.child1 = sibling;
+		parent.child2 = leaf;
+	}
+
+	if (oldParent == NullID)
+	{
+		m_root = newParent;
+	}
+	else if (m_nodes[oldParent].child1 == sibling)
+	{
+		m_nodes[oldParent].child1 = newParent;
+	}
+	else
+	{
+		m_nodes[oldParent].child2 = newParent;
+	}
+
+	m_nodes[sibling].parent = newParent;
+	m_nodes[leaf].parent = newParent;
+
+	// Refit and rebalance the ancestors
+	for (index = m_nodes[leaf].parent; index != NullID; index = m_nodes[index].parent)
+	{
+		index = balance(index);
+
+		Node& node = m_nodes[index];
+		node.height = (1 + s3d::Max(m_nodes[node.child1].height, m_nodes[node.child2].height));
+		node.fatBounds = Union(m_nodes[node.child1].fatBounds, m_nodes[node.child2].fatBounds);
+	}
+}
+
+void DynamicAABBTree::removeLeaf(const ID leaf)
+{
+	if (leaf == m_root)
+	{
+		m_root = NullID;
+		return;
+	}
+
+	const ID parent = m_nodes[leaf].parent;
+	const ID grandParent = m_nodes[parent].parent;
+	const ID sibling = ((m_nodes[parent].child1 == leaf) ? m_nodes[parent].child2 : m_nodes[parent].child1);
+
+	freeNode(parent);
+
+	if (grandParent == NullID)
+	{
+		m_root = sibling;
+		m_nodes[sibling].parent = NullID;
+		return;
+	}
+
+	// The sibling takes the place of the removed parent
+	if (m_nodes[grandParent].child1 == parent)
+	{
+		m_nodes[grandParent].child1 = sibling;
+	}
+	else
+	{
+		m_nodes[grandParent].child2 = sibling;
+	}
+
+	m_nodes[sibling].parent = grandParent;
+
+	for (ID index = grandParent; index != NullID; index = m_nodes[index].parent)
+	{
+		index = balance(index);
+
+		Node& node = m_nodes[index];
+		node.fatBounds = Union(m_nodes[node.child1].fatBounds, m_nodes[node.child2].fatBounds);
+		node.height = (1 + s3d::Max(m_nodes[node.child1].height, m_nodes[node.child2].height));
+	}
+}
+
+DynamicAABBTree::ID DynamicAABBTree::balance(const ID iA)
+{
+	Node& A = m_nodes[iA];
+
+	if (A.isLeaf() || (A.height < 2))
+	{
+		return iA;
+	}
+
+	const ID iB = A.child1;
+	const ID iC = A.child2;
+	Node& B = m_nodes[iB];
+	Node& C = m_nodes[iC];
+
+	const s3d::int32 imbalance = (C.height - B.height);
+
+	// Replaces A with its child in A's parent
+	const auto replaceInParent = [&](const ID newChild)
+		{
+			if (m_nodes[newChild].parent == NullID)
+			{
+				m_root = newChild;
+			}
+			else if (m_nodes[m_nodes[newChild].parent].child1 == iA)
+			{
+				m_nodes[m_nodes[newChild].parent].child1 = newChild;
+			}
+			else
+			{
+				m_nodes[m_nodes[newChild].parent].child2 = newChild;
+			}
+		};
+
+	// Rotate C up
+	if (1 < imbalance)
+	{
+		const ID iF = C.child1;
+		const ID iG = C.child2;
+		Node& F = m_nodes[iF];
+		Node& G = m_nodes[iG];
+
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+		replaceInParent(iC);
+
+		// The taller grandchild stays under C, the shorter one moves under A
+		const bool keepF = (G.height < F.height);
+		const ID iKeep = (keepF ? iF : iG);
+		const ID iMove = (keepF ? iG : iF);
+
+		C.child2 = iKeep;
+		A.child2 = iMove;
+		m_nodes[iMove].parent = iA;
+
+		A.fatBounds = Union(B.fatBounds, m_nodes[iMove].fatBounds);
+		C.fatBounds = Union(A.fatBounds, m_nodes[iKeep].fatBounds);
+		A.height = (1 + s3d::Max(B.height, m_nodes[iMove].height));
+		C.height = (1 + s3d::Max(A.height, m_nodes[iKeep].height));
+
+		return iC;
+	}
+
+	// Rotate B up
+	if (imbalance < -1)
+	{
+		const ID iD = B.child1;
+		const ID iE = B.child2;
+		Node& D = m_nodes[iD];
+		Node& E = m_nodes[iE];
+
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+		replaceInParent(iB);
+
+		const bool keepD = (E.height < D.height);
+		const ID iKeep = (keepD ? iD : iE);
+		const ID iMove = (keepD ? iE : iD);
+
+		B.child2 = iKeep;
+		A.child1 = iMove;
+		m_nodes[iMove].parent = iA;
+
+		A.fatBounds = Union(C.fatBounds, m_nodes[iMove].fatBounds);
+		B.fatBounds = Union(A.fatBounds, m_nodes[iKeep].fatBounds);
+		A.height = (1 + s3d::Max(C.height, m_nodes[iMove].height));
+		B.height = (1 + s3d::Max(A.height, m_nodes[iKeep].height));
+
+		return iB;
+	}
+
+	return iA;
+}
+
+bool DynamicAABBTree::intersects(const Node& node, const s3d::RectF& region) const noexcept
+{
+	if (node.radius < 0.0)
+	{
+		return Overlaps(node.bounds, region);
+	}
+
+	return s3d::Geometry2D::Intersect(s3d::Circle{ node.bounds.center(), node.radius }, region);
+}
+
+bool DynamicAABBTree::intersects(const Node& a, const Node& b) const noexcept
+{
+	if (a.radius < 0.0)
+	{
+		return intersects(b, a.bounds);
+	}
+
+	const s3d::Circle circle{ a.bounds.center(), a.radius };
+
+	if (b.radius < 0.0)
+	{
+		return s3d::Geometry2D::Intersect(circle, b.bounds);
+	}
+
+	return s3d::Geometry2D::Intersect(circle, s3d::Circle{ b.bounds.center(), b.radius });
+}
+
+s3d::Optional<double> DynamicAABBTree::raycastProxy(const Node& node, const s3d::Vec2& origin, const s3d::Vec2& direction, const double maxDistance) const noexcept
+{
+	if (node.radius < 0.0)
+	{
+		return RaycastRect(node.bounds, origin, direction, maxDistance);
+	}
+
+	// |origin + direction * t - center| = radius with a normalized direction
+	const s3d::Vec2 m = (origin - node.bounds.center());
+	const double b = m.dot(direction);
+	const double c = (m.lengthSq() - (node.radius * node.radius));
+
+	if (c <= 0.0)
+	{
+		return 0.0;
+	}
+
+	const double discriminant = ((b * b) - c);
+
+	if ((0.0 < b) || (discriminant < 0.0))
+	{
+		return s3d::none;
+	}
+
+	const double t = (-b - std::sqrt(discriminant));
+
+	if (maxDistance < t)
+	{
+		return s3d::none;
+	}
+
+	return t;
+}
@@ -0,0 +1,150 @@
+﻿# pragma once
+# include <Siv3D/Array.hpp>
+# include <Siv3D/Optional.hpp>
+# include <Siv3D/2DShapes.hpp>
+
+// Broad-phase index for moving objects.
+// Each proxy (a RectF or a Circle) is stored in a leaf of a bounding volume hierarchy under an AABB
+// grown by a margin, so that small moves do not touch the tree at all and larger ones
+// are an O(log n) remove and reinsert. The tree is kept balanced with rotations as leaves are inserted and removed.
+class DynamicAABBTree
+{
+public:
+
+	using ID = s3d::uint32;
+
+	static constexpr ID NullID = 0xFFFFFFFF;
+
+	// How far the stored AABB is grown beyond the shape on each side
+	static constexpr double DefaultMargin = 8.0;
+
+	struct RaycastHit
+	{
+		ID id;
+
+		// Distance from the ray origin along the normalized direction
+		double distance;
+
+		s3d::Vec2 point;
+	};
+
+	DynamicAABBTree() = default;
+
+	explicit DynamicAABBTree(double margin);
+
+	// Adds a proxy and returns the ID used to update or remove it later
+	ID insert(const s3d::RectF& rect);
+
+	ID insert(const s3d::Circle& circle);
+
+	// Moves an existing proxy; returns true if it left its grown AABB and was reinserted, false if id is not stored
+	bool update(ID id, const s3d::RectF& rect);
+
+	bool update(ID id, const s3d::Circle& circle);
+
+	// Does nothing if id is not stored
+	void remove(ID id);
+
+	void clear();
+
+	// Whether id refers to a proxy currently stored (IDs are node slots, reused after remove)
+	[[nodiscard]]
+	bool contains(ID id) const noexcept;
+
+	// Tight bounding rect of a proxy, an empty rect at the origin if id is not stored
+	[[nodiscard]]
+	const s3d::RectF& getBounds(ID id) const noexcept;
+
+	[[nodiscard]]
+	bool isCircle(ID id) const noexcept;
+
+	// Number of proxies currently stored
+	[[nodiscard]]
+	size_t size() const noexcept;
+
+	// Height of the tree, 0 for a single leaf
+	[[nodiscard]]
+	s3d::int32 height() const noexcept;
+
+	// Replaces results with the IDs of the proxies intersecting region, in ascending order
+	void query(const s3d::RectF& region, s3d::Array<ID>& results) const;
+
+	// Replaces results with every pair of intersecting proxies (first < second), in ascending order
+	void queryPairs(s3d::Array<std::pair<ID, ID>>& results) const;
+
+	// Returns the closest proxy hit by the ray within maxDistance
+	[[nodiscard]]
+	s3d::Optional<RaycastHit> raycast(const s3d::Vec2& origin, const s3d::Vec2& direction, double maxDistance) const;
+
+	// Returns the proxy hit first when walking along the segment from begin to end
+	[[nodiscard]]
+	s3d::Optional<RaycastHit> raycast(const s3d::Line& segment) const;
+
+private:
+
+	struct Node
+	{
+		// Grown AABB for leaves, union of the children for internal nodes
+		s3d::RectF fatBounds;
+
+		// Tight AABB of the proxy
+		s3d::RectF bounds;
+
+		// Radius of a circle proxy, negative for a rect proxy
+		double radius = -1.0;
+
+		// Next free node while the node is unused
+		ID parent = NullID;
+
+		ID child1 = NullID;
+
+		ID child2 = NullID;
+
+		// 0 for leaves, -1 for unused nodes
+		s3d::int32 height = -1;
+
+		[[nodiscard]]
+		bool isLeaf() const noexcept
+		{
+			return (child1 == NullID);
+		}
+	};
+
+	double m_margin = DefaultMargin;
+
+	s3d::Array<Node> m_nodes;
+
+	ID m_root = NullID;
+
+	ID m_freeList = NullID;
+
+	size_t m_proxyCount = 0;
+
+	// Traversal stack reused between queries
+	mutable s3d::Array<ID> m_stack;
+
+	ID allocateNode();
+
+	void freeNode(ID id);
+
+	ID insertProxy(const s3d::RectF& bounds, double radius);
+
+	bool updateProxy(ID id, const s3d::RectF& bounds, double radius);
+
+	void insertLeaf(ID leaf);
+
+	void removeLeaf(ID leaf);
+
+	// Rotates the subtree rooted at a if it is imbalanced and returns the new subtree root
+	ID balance(ID a);
+
+	[[nodiscard]]
+	bool intersects(const Node& node, const s3d::RectF& region) const noexcept;
+
+	[[nodiscard]]
+	bool intersects(const Node& a, const Node& b) const noexcept;
+
+	// Distance along the ray to the proxy, if the ray hits it before maxDistance
+	[[nodiscard]]
+	s3d::Optional<double> raycastProxy(const Node& node, const s3d::Vec2& origin, const s3d::Vec2& direction, double maxDistance) const noexcept;
+};
@@ -0,0 +1,47 @@
+﻿# include <cmath>
+# include "FixedTimestep.hpp"
+
+FixedTimestep::FixedTimestep(const double stepsPerSecond, const s3d::int32 maxStepsPerFrame)
+	: m_stepSeconds{ (1.0 / stepsPerSecond) }
+	, m_maxStepsPerFrame{ maxStepsPerFrame } {}
+
+s3d::int32 FixedTimestep::advance(const double deltaTime)
+{
+	m_accumulator += deltaTime;
+
+	s3d::int32 steps = 0;
+
+	while ((m_stepSeconds <= m_accumulator) && (steps < m_maxStepsPerFrame))
+	{
+		m_accumulator -= m_stepSeconds;
+		++steps;
+	}
+
+	// Under load, drop the backlog instead of spending ever more time catching up
+	if (m_stepSeconds <= m_accumulator)
+	{
+		m_accumulator = std::fmod(m_accumulator, m_stepSeconds);
+	}
+
+	return steps;
+}
+
+double FixedTimestep::stepSeconds() const noexcept
+{
+	return m_stepSeconds;
+}
+
+s3d::int32 FixedTimestep::maxStepsPerFrame() const noexcept
+{
+	return m_maxStepsPerFrame;
+}
+
+double FixedTimestep::maxDeltaTime() const noexcept
+{
+	return (m_stepSeconds * m_maxStepsPerFrame);
+}
+
+double FixedTimestep::alpha() const noexcept
+{
+	return (m_accumulator / m_stepSeconds);
+}
@@ -0,0 +1,41 @@
+﻿# pragma once
+# include <Siv3D/Types.hpp>
+
+// Converts variable frame times into a whole number of fixed-length simulation steps.
+// Time that does not fill a complete step stays in the accumulator and is exposed as
+// alpha() so rendering can interpolate between the last two simulated states.
+class FixedTimestep
+{
+public:
+
+	FixedTimestep() = default;
+
+	FixedTimestep(double stepsPerSecond, s3d::int32 maxStepsPerFrame);
+
+	// Adds the frame time and returns how many fixed steps should run this frame
+	[[nodiscard]]
+	s3d::int32 advance(double deltaTime);
+
+	// Length of one simulation step in seconds
+	[[nodiscard]]
+	double stepSeconds() const noexcept;
+
+	[[nodiscard]]
+	s3d::int32 maxStepsPerFrame() const noexcept;
+
+	// Longest frame time that can be fully simulated; suitable for Scene::SetMaxDeltaTime()
+	[[nodiscard]]
+	double maxDeltaTime() const noexcept;
+
+	// Fraction of a step left over after advance(), in [0, 1)
+	[[nodiscard]]
+	double alpha() const noexcept;
+
+private:
+
+	double m_stepSeconds = (1.0 / 120.0);
+
+	s3d::int32 m_maxStepsPerFrame = 8;
+
+	double m_accumulator = 0.0;
+};
@@ -0,0 +1,48 @@
+﻿# pragma once
+# include <Siv3D/Types.hpp>
+
+// Player input for a single simulation step, decoupled from the keyboard
+struct InputFrame
+{
+	enum Bit : s3d::uint8
+	{
+		LeftBit		= (1 << 0),
+		RightBit	= (1 << 1),
+		JumpBit		= (1 << 2),
+		JumpDownBit	= (1 << 3),
+		DashBit		= (1 << 4),
+	};
+
+	bool left = false;
+
+	bool right = false;
+
+	// Jump key is held
+	bool jump = false;
+
+	// Jump key went down since the previous step
+	bool jumpDown = false;
+
+	bool dash = false;
+
+	// Packs the input into one byte for recording
+	[[nodiscard]]
+	constexpr s3d::uint8 toBits() const noexcept
+	{
+		return static_cast<s3d::uint8>((left ? LeftBit : 0)
+			| (right ? RightBit : 0)
+			| (jump ? JumpBit : 0)
+			| (jumpDown ? JumpDownBit : 0)
+			| (dash ? DashBit : 0));
+	}
+
+	[[nodiscard]]
+	static constexpr InputFrame FromBits(const s3d::uint8 bits) noexcept
+	{
+		return{ .left = ((bits & LeftBit) != 0),
+			.right = ((bits & RightBit) != 0),
+			.jump = ((bits & JumpBit) != 0),
+			.jumpDown = ((bits & JumpDownBit) != 0),
+			.dash = ((bits & DashBit) != 0) };
+	}
+};
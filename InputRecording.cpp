@@ -0,0 +1,98 @@
+﻿# include "InputRecording.hpp"
+
+namespace
+{
+	constexpr s3d::uint64 FNVOffsetBasis = 14695981039346656037ULL;
+
+	constexpr s3d::uint64 FNVPrime = 1099511628211ULL;
+
+	template <class Type>
+	void HashCombine(s3d::uint64& hash, const Type& value) noexcept
+	{
+		s3d::uint8 bytes[sizeof(Type)];
+		std::memcpy(bytes, &value, sizeof(Type));
+
+		for (const s3d::uint8 byte : bytes)
+		{
+			hash = ((hash ^ byte) * FNVPrime);
+		}
+	}
+}
+
+void InputRecording::record(const InputFrame& input)
+{
+	frames.push_back(input.toBits());
+}
+
+bool InputRecording::save(const s3d::FilePathView path) const
+{
+	s3d::Serializer<s3d::BinaryWriter> writer{ path };
+
+	if (not writer)
+	{
+		return false;
+	}
+
+	writer(*this);
+
+	return true;
+}
+
+bool InputRecording::load(const s3d::FilePathView path)
+{
+	s3d::Deserializer<s3d::BinaryReader> reader{ path };
+
+	if (not reader)
+	{
+		return false;
+	}
+
+	try
+	{
+		reader(*this);
+	}
+	catch (const cereal::Exception&)
+	{
+		*this = InputRecording{};
+		return false;
+	}
+
+	return true;
+}
+
+double ReplayResult::ticksPerSecond() const noexcept
+{
+	return ((elapsedSeconds == 0.0) ? 0.0 : (ticks / elapsedSeconds));
+}
+
+ReplayResult Replay(PlatformerWorld& world, const InputRecording& recording)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	for (const s3d::uint8 bits : recording.frames)
+	{
+		world.step(recording.stepSeconds, InputFrame::FromBits(bits));
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	return{ .ticks = recording.frames.size(),
+		.elapsedSeconds = std::chrono::duration<double>(end - start).count(),
+		.stateHash = HashState(world.state()) };
+}
+
+s3d::uint64 HashState(const PlatformerState& state) noexcept
+{
+	s3d::uint64 hash = FNVOffsetBasis;
+	HashCombine(hash, state.playerPosition.x);
+	HashCombine(hash, state.playerPosition.y);
+	HashCombine(hash, state.playerVelocity.x);
+	HashCombine(hash, state.playerVelocity.y);
+	HashCombine(hash, state.dashTimer);
+	HashCombine(hash, state.dashCooldownTimer);
+	HashCombine(hash, state.isDashing);
+	HashCombine(hash, state.isJumpingForKeyHold);
+	HashCombine(hash, state.currentJumpSustainTime);
+	HashCombine(hash, state.isOnGround);
+	return hash;
+}
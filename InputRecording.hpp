@@ -0,0 +1,49 @@
+﻿# pragma once
+# include <Siv3D.hpp>
+# include "PlatformerWorld.hpp"
+
+// Inputs of a play session, one byte per fixed simulation step
+struct InputRecording
+{
+	// Length of the step the inputs were recorded at
+	double stepSeconds = 0.0;
+
+	// InputFrame::toBits() of each step
+	s3d::Array<s3d::uint8> frames;
+
+	// HashState() of the state after the last frame; a replay must reproduce it
+	s3d::uint64 finalStateHash = 0;
+
+	void record(const InputFrame& input);
+
+	bool save(s3d::FilePathView path) const;
+
+	bool load(s3d::FilePathView path);
+
+	template <class Archive>
+	void SIV3D_SERIALIZE(Archive& archive)
+	{
+		archive(stepSeconds, frames, finalStateHash);
+	}
+};
+
+struct ReplayResult
+{
+	size_t ticks = 0;
+
+	double elapsedSeconds = 0.0;
+
+	// HashState() of the final state
+	s3d::uint64 stateHash = 0;
+
+	[[nodiscard]]
+	double ticksPerSecond() const noexcept;
+};
+
+// Steps world through every frame of recording as fast as possible, without rendering
+[[nodiscard]]
+ReplayResult Replay(PlatformerWorld& world, const InputRecording& recording);
+
+// Hash of the exact bit patterns of state; equal hashes mean a replay produced identical results
+[[nodiscard]]
+s3d::uint64 HashState(const PlatformerState& state) noexcept;
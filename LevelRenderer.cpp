@@ -0,0 +1,51 @@
+﻿# include "LevelRenderer.hpp"
+
+void LevelRenderer::draw(const CollisionGrid& grid, const s3d::RectF& region, const s3d::ColorF& color)
+{
+	grid.query(region, m_visible);
+	m_drawnCount = m_visible.size();
+
+	const s3d::Float4 vertexColor = color.toFloat4();
+
+	for (const auto id : m_visible)
+	{
+		if (MaxRectsPerBatch <= (m_buffer.vertices.size() / 4))
+		{
+			flush();
+		}
+
+		const s3d::Rect& rect = grid.get(id);
+		const float left = static_cast<float>(rect.x);
+		const float top = static_cast<float>(rect.y);
+		const float right = static_cast<float>(rect.x + rect.w);
+		const float bottom = static_cast<float>(rect.y + rect.h);
+		const auto base = static_cast<s3d::Vertex2D::IndexType>(m_buffer.vertices.size());
+
+		m_buffer.vertices.push_back(s3d::Vertex2D{ .pos = { left, top }, .tex = { 0.0f, 0.0f }, .color = vertexColor });
+		m_buffer.vertices.push_back(s3d::Vertex2D{ .pos = { right, top }, .tex = { 1.0f, 0.0f }, .color = vertexColor });
+		m_buffer.vertices.push_back(s3d::Vertex2D{ .pos = { left, bottom }, .tex = { 0.0f, 1.0f }, .color = vertexColor });
+		m_buffer.vertices.push_back(s3d::Vertex2D{ .pos = { right, bottom }, .tex = { 1.0f, 1.0f }, .color = vertexColor });
+
+		m_buffer.indices.push_back(s3d::TriangleIndex{ base, static_cast<s3d::Vertex2D::IndexType>(base + 1), static_cast<s3d::Vertex2D::IndexType>(base + 2) });
+		m_buffer.indices.push_back(s3d::TriangleIndex{ static_cast<s3d::Vertex2D::IndexType>(base + 2), static_cast<s3d::Vertex2D::IndexType>(base + 1), static_cast<s3d::Vertex2D::IndexType>(base + 3) });
+	}
+
+	flush();
+}
+
+size_t LevelRenderer::drawnCount() const noexcept
+{
+	return m_drawnCount;
+}
+
+void LevelRenderer::flush()
+{
+	if (m_buffer.indices)
+	{
+		m_buffer.draw();
+	}
+
+	// Keep the capacity for the next batch
+	m_buffer.vertices.clear();
+	m_buffer.indices.clear();
+}
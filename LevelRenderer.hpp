@@ -0,0 +1,31 @@
+﻿# pragma once
+# include <Siv3D.hpp>
+# include "CollisionGrid.hpp"
+
+// Draws the level geometry that is inside the view.
+// Visible rects are looked up through the broad-phase grid and submitted as one Buffer2D
+// per batch instead of one draw call per rect.
+class LevelRenderer
+{
+public:
+
+	// Draws the rects in grid that overlap region (usually Camera2D::getRegion())
+	void draw(const CollisionGrid& grid, const s3d::RectF& region, const s3d::ColorF& color);
+
+	// Number of rects drawn by the last draw()
+	[[nodiscard]]
+	size_t drawnCount() const noexcept;
+
+private:
+
+	// Vertex2D::IndexType is 16-bit, so one batch holds at most this many rects
+	static constexpr size_t MaxRectsPerBatch = (65536 / 4);
+
+	s3d::Array<CollisionGrid::ID> m_visible;
+
+	s3d::Buffer2D m_buffer;
+
+	size_t m_drawnCount = 0;
+
+	void flush();
+};
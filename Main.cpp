@@ -1,267 +1,316 @@
 ﻿# include <Siv3D.hpp> // Siv3D v0.6.16
 
-const double GRAVITY = 1000.0; // Pixels per second per second
-const double JUMP_VELOCITY = -500.0; // Negative for upward velocity
-const double GROUND_Y = 500.0;
-const double PLAYER_MOVE_SPEED = 200.0; // Horizontal speed
-const double DASH_SPEED_MULTIPLIER = 2.5;
-const double DASH_DURATION = 0.2; // seconds
-const double DASH_COOLDOWN = 0.5; // seconds
-const double JUMP_SUSTAIN_FORCE_REDUCTION_FACTOR = 0.5; // Reduce gravity by this factor while sustaining
-const double MAX_JUMP_SUSTAIN_DURATION = 0.25; // Max time player can sustain jump by holding key
+# include "Diagnostics.hpp"
+# include "FixedTimestep.hpp"
+# include "InputRecording.hpp"
+# include "LevelRenderer.hpp"
+# include "PlatformerWorld.hpp"
+# include "Snapshot.hpp"
+# include "TileMap.hpp"
 
 void Main()
 {
-	// 背景の色を設定する | Set the background color
-	s3d::Scene::SetBackground(s3d::ColorF{ 0.6, 0.8, 0.7 });
-
-	// Player and Camera state
-	s3d::Vec2 playerPosition{ 100, GROUND_Y - 30.0 }; // Start on main ground line
-	s3d::Vec2 playerVelocity{ 0.0, 0.0 };
-	s3d::Camera2D camera{ s3d::Vec2{ s3d::Scene::CenterF() }, 1.0 }; // Centered camera initial
+	const s3d::Array<s3d::String>& args = s3d::System::GetCommandLineArgs();
 
-	// Dash mechanic state
-	double dashTimer = 0.0; // How long current dash lasts
-	double dashCooldownTimer = 0.0; // Time until next dash is available
-	bool isDashing = false;
-
-	// Jump mechanic state
-	bool isJumpingForKeyHold = false; // True if jump key is held, allowing sustain
-	double currentJumpSustainTime = 0.0; // How long jump has been sustained
-
-	// Level Definition
-	s3d::Array<s3d::Rect> levelObjects; // Changed from RectF
-	// Platform 1
-	levelObjects.push_back(s3d::Rect{ 200, GROUND_Y - 100, 200, 20 }); // Changed from RectF
-	// Platform 2
-	levelObjects.push_back(s3d::Rect{ 500, GROUND_Y - 180, 150, 20 }); // Changed from RectF
-	// A small wall on top of platform 1
-	levelObjects.push_back(s3d::Rect{ 300, GROUND_Y - 100 - 50, 20, 50 }); // Changed from RectF
-	// Floating Platform
-	levelObjects.push_back(s3d::Rect{ 800, GROUND_Y - 120, 100, 20 }); // Changed from RectF
-
-	while (s3d::System::Update())
+	// --benchmark runs the large benchmarks and exits without entering the game loop
+	if (args.includes(U"--benchmark"))
 	{
-		const double deltaTime = s3d::Scene::DeltaTime();
+		s3d::Console.open();
 
-		// Update Dash Timers
-		if (dashTimer > 0.0)
+		for (const auto& line : RunBenchmarks())
 		{
-			dashTimer -= deltaTime;
-			if (dashTimer <= 0.0)
-			{
-				isDashing = false;
-			}
-		}
-		if (dashCooldownTimer > 0.0)
-		{
-			dashCooldownTimer -= deltaTime;
+			s3d::Console.writeln(line);
 		}
 
-		// Dash Input Handling
-		bool tryingToDash = s3d::KeyShift.pressed();
+		return;
+	}
 
-		if (tryingToDash && dashCooldownTimer <= 0.0 && !isDashing)
-		{
-			if (s3d::KeyA.pressed() || s3d::KeyD.pressed()) // Only dash if moving
-			{
-				isDashing = true;
-				dashTimer = DASH_DURATION;
-				// Cooldown starts after the current dash finishes plus the explicit cooldown period
-				dashCooldownTimer = DASH_COOLDOWN + DASH_DURATION;
-			}
-		}
+	// --level <path> plays a tilemap file (see TileMap.hpp) instead of the hand-placed level
+	s3d::Array<s3d::Rect> level;
 
-		// Horizontal Movement
-		playerVelocity.x = 0.0;
-		double actualMoveSpeed = PLAYER_MOVE_SPEED;
+	if (const auto it = std::find(args.begin(), args.end(), U"--level"); ((it != args.end()) && ((it + 1) != args.end())))
+	{
+		level = LoadTileMapLevel(*(it + 1));
+	}
+
+	if (not level)
+	{
+		level = MakeDefaultLevel();
+	}
+
+	// --replay <path> steps a fresh world through a recording saved with [F5] (on the same level) and checks that it ends in the recorded state
+	if (const auto it = std::find(args.begin(), args.end(), U"--replay"); (it != args.end()))
+	{
+		s3d::Console.open();
 
-		if (isDashing)
+		InputRecording replay;
+
+		if (((it + 1) == args.end()) || (not replay.load(*(it + 1))))
 		{
-			actualMoveSpeed *= DASH_SPEED_MULTIPLIER;
+			s3d::Console.writeln(U"Failed to load the recording");
+			return;
 		}
 
-		if (s3d::KeyA.pressed())
+		PlatformerWorld replayWorld{ level };
+		const ReplayResult result = Replay(replayWorld, replay);
+
+		s3d::Console.writeln(U"{} ticks in {:.3f} s ({:.0f} ticks/s)"_fmt(result.ticks, result.elapsedSeconds, result.ticksPerSecond()));
+
+		if (result.stateHash == replay.finalStateHash)
 		{
-			playerVelocity.x = -actualMoveSpeed;
+			s3d::Console.writeln(U"Final state matches the recording");
 		}
-		else if (s3d::KeyD.pressed())
+		else
 		{
-			playerVelocity.x = actualMoveSpeed;
+			s3d::Console.writeln(U"Final state DIFFERS from the recording ({:016X} != {:016X})"_fmt(result.stateHash, replay.finalStateHash));
 		}
 
-		// Determine if player is on ground (for jump initiation)
-		// This check is based on player's current position and if their vertical velocity is near zero (implies landed)
-		bool isOnGround = false;
-		if (s3d::Math::NearlyEquals(playerVelocity.y, 0.0, 0.1) ) // If y-velocity is practically zero
-		{
-			// Check against main ground with a small tolerance
-			if (playerPosition.y >= GROUND_Y - 30.0 - 1.0) {
-				isOnGround = true;
-			}
-			// Check against platforms if not on main ground
-			if(!isOnGround) {
-				s3d::Circle feetCircle{ playerPosition.movedBy(0, 1), 28 }; // Check slightly below current pos
-				for (const auto& platform : levelObjects)
-				{
-					if (feetCircle.intersects(platform) && playerPosition.y < platform.top() + 1) // Player slightly above or on platform top
-					{
-						isOnGround = true;
-						break;
-					}
-				}
-			}
-		}
+		return;
+	}
+
+	// 背景の色を設定する | Set the background color
+	s3d::Scene::SetBackground(s3d::ColorF{ 0.6, 0.8, 0.7 });
 
+	// Player physics, dash/jump state and platform collision
+	PlatformerWorld world{ std::move(level) };
+	s3d::Camera2D camera{ s3d::Vec2{ s3d::Scene::CenterF() }, 1.0 }; // Centered camera initial
+	LevelRenderer levelRenderer;
 
-		// Jump initiation
-		if (s3d::KeyW.down() && isOnGround)
-		{
-			playerVelocity.y = JUMP_VELOCITY;
-			isJumpingForKeyHold = true; // Enable jump sustain
-			currentJumpSustainTime = 0.0; // Reset sustain timer
-		}
+	// Simulate at a fixed rate regardless of the display refresh rate.
+	// Long frames are clamped so a single frame never runs more than maxStepsPerFrame steps.
+	FixedTimestep timestep{ 120.0, 8 };
+	s3d::Scene::SetMaxDeltaTime(timestep.maxDeltaTime());
 
-		// Jump sustain logic
-		if (!s3d::KeyW.pressed() || playerVelocity.y >= 0) // Stop sustaining if key released or player is falling/on apex
-		{
-			isJumpingForKeyHold = false;
-		}
+	// A jump press is kept until a step consumes it, even if this frame runs no steps
+	bool pendingJumpDown = false;
 
-		if (isJumpingForKeyHold && currentJumpSustainTime < MAX_JUMP_SUSTAIN_DURATION)
+	// Every step's input is recorded so that the session can be replayed headlessly ([F5] saves it)
+	InputRecording recording;
+	recording.stepSeconds = timestep.stepSeconds();
+
+	// A snapshot is taken after every step so that holding [R] can undo the last 10 seconds.
+	// Rewinding also drops the recorded inputs of the undone steps, so the replay stays in sync.
+	SnapshotRing rewindSnapshots{ static_cast<size_t>(10.0 / timestep.stepSeconds()) };
+	s3d::Blob snapshot;
+	bool rewinding = false;
+
+	const auto takeSnapshot = [&]()
 		{
-			currentJumpSustainTime += deltaTime; // Increment sustain timer
-		}
-		else
+			SnapshotWriter writer{ snapshot };
+			world.saveState(writer);
+			rewindSnapshots.push(snapshot);
+		};
+
+	takeSnapshot();
+
+	// Per-scope frame time percentiles ([F1] toggles the overlay)
+	bool showProfile = false;
+
+	// Dash trail; every effect in the world is updated on the thread pool and drawn in one batch per blend state
+	s3d::ParticleWorld2D particles;
+	s3d::ParticleSystem2DParameters dashTrailParameters;
+	dashTrailParameters.rate = 120.0;
+	dashTrailParameters.maxParticles = 200.0;
+	dashTrailParameters.startLifeTime = 0.4;
+	dashTrailParameters.startSpeed = 30.0;
+	dashTrailParameters.startColor = s3d::ColorF{ 1.0, 0.9, 0.4, 0.8 };
+	dashTrailParameters.startSize = 8.0;
+	dashTrailParameters.sizeOverLifeTimeFunc = [](const float startSize, const float startLifeTime, const float remainingLifeTime)
 		{
-			isJumpingForKeyHold = false; // Stop sustaining if max duration reached
-		}
-
-		// Apply gravity (potentially modified by jump sustain)
-		double effectiveGravity = GRAVITY;
-		if (isJumpingForKeyHold) // If sustaining jump (moving up, key held, within duration)
+			return (startSize * (remainingLifeTime / startLifeTime));
+		};
+	s3d::CircleEmitter2D dashTrailEmitter;
+	dashTrailEmitter.r = (PLAYER_RADIUS * 0.5);
+	const auto dashTrail = particles.add(s3d::Vec2{ 0, 0 }, dashTrailEmitter, dashTrailParameters);
+
+	// Per-frame update stages: input -> simulation -> (particles, camera) -> draw.
+	// Stages that read input or touch graphics stay on the main thread; the simulation and particles run on the thread pool.
+	InputFrame input;
+	double deltaTime = 0.0;
+	s3d::Vec2 playerPosition{ 0, 0 };
+	s3d::TaskGraph frameGraph;
+
+	const auto inputStage = frameGraph.add("input", [&]()
 		{
-			// Reduce gravity's effect to allow variable jump height
-			effectiveGravity *= (1.0 - JUMP_SUSTAIN_FORCE_REDUCTION_FACTOR);
-		}
-		playerVelocity.y += effectiveGravity * deltaTime;
+			deltaTime = s3d::Scene::DeltaTime();
+			pendingJumpDown |= s3d::KeyW.down();
 
-		// Update positions based on velocity
-		playerPosition.x += playerVelocity.x * deltaTime;
-		playerPosition.y += playerVelocity.y * deltaTime;
+			input.left = s3d::KeyA.pressed();
+			input.right = s3d::KeyD.pressed();
+			input.jump = s3d::KeyW.pressed();
+			input.dash = s3d::KeyShift.pressed();
 
+			rewinding = s3d::KeyR.pressed();
 
-		// Platform Collision Detection and Response
-		// Strategy: Check current player circle against each platform.
-		// To determine entry and side of collision, compare with player's position *before* this frame's movement.
-		// Resolve by pushing player out and zeroing velocity on the collision axis.
-		s3d::Circle playerCollisionCircle{ playerPosition, 30 };
-		s3d::Vec2 previousPlayerPositionForCollision = playerPosition - playerVelocity * deltaTime; // Position before this frame's physics update
+			if (s3d::KeyF5.down())
+			{
+				recording.finalStateHash = HashState(world.state());
+				recording.save(U"replay.bin");
+			}
 
-		for (const auto& platform : levelObjects) // platform is now s3d::Rect
-		{
-			if (playerCollisionCircle.intersects(platform)) // Circle intersects Rect (double) is fine
+			// Quicksave ([F6]) and quickload ([F7]); the inputs so far are saved too, so that [F5] still saves a valid replay after loading
+			if (s3d::KeyF6.down())
 			{
-				s3d::Circle previousFrameCircle{ previousPlayerPositionForCollision, 30 };
-				s3d::Line platformTopEdge{ platform.tl(), platform.tr() };       // Changed from LineF
-				s3d::Line platformBottomEdge{ platform.bl(), platform.br() };   // Changed from LineF
-				s3d::Line platformLeftEdge{ platform.tl(), platform.bl() };     // Changed from LineF
-				s3d::Line platformRightEdge{ platform.tr(), platform.br() };    // Changed from LineF
-
-				// Check vertical collision (landing on top or hitting bottom)
-				if (playerVelocity.y > 0 && !previousFrameCircle.intersects(platformTopEdge) && playerCollisionCircle.intersects(platformTopEdge)) // Moving down & was above
-				{
-					if (playerCollisionCircle.right().x > platform.left().x && playerCollisionCircle.left().x < platform.right().x) // Horizontal overlap
-					{
-						playerPosition.y = platform.top().y - 30;
-						playerVelocity.y = 0;
-					}
-				}
-				else if (playerVelocity.y < 0 && !previousFrameCircle.intersects(platformBottomEdge) && playerCollisionCircle.intersects(platformBottomEdge)) // Moving up & was below
-				{
-					if (playerCollisionCircle.right().x > platform.left().x && playerCollisionCircle.left().x < platform.right().x) // Horizontal overlap
-					{
-						playerPosition.y = platform.bottom().y + 30;
-						playerVelocity.y = 0;
-					}
-				}
-				// Update collision circle for horizontal check after potential vertical correction
-				playerCollisionCircle.setPos(playerPosition);
-
-				// Check horizontal collision (hitting sides)
-				// Important: only resolve horizontal if not primarily a vertical collision solved above.
-				// This simple check might still allow some corner clipping / incorrect resolution priority.
-				// Also, ensure that the player wasn't already pushed by a vertical collision response this frame
-				// in a way that would make horizontal collision invalid.
-				if (playerVelocity.x > 0 && !previousFrameCircle.intersects(platformLeftEdge) && playerCollisionCircle.intersects(platformLeftEdge)) // Moving right & was to the left
+				s3d::Blob quicksave;
+				SnapshotWriter writer{ quicksave };
+				writer.write(recording.frames);
+				world.saveState(writer);
+				SaveSnapshot(U"quicksave.bin", quicksave);
+			}
+
+			if (s3d::KeyF7.down())
+			{
+				s3d::Blob quicksave;
+				s3d::Array<s3d::uint8> frames;
+
+				if (LoadSnapshot(U"quicksave.bin", quicksave))
 				{
-					if (playerCollisionCircle.bottom().y > platform.top().y && playerCollisionCircle.top().y < platform.bottom().y) // Vertical overlap
+					SnapshotReader reader{ quicksave };
+
+					if (reader.read(frames) && world.loadState(reader))
 					{
-						playerPosition.x = platform.left().x - 30;
-						playerVelocity.x = 0;
+						recording.frames = std::move(frames);
+						rewindSnapshots.clear();
+						takeSnapshot();
 					}
 				}
-				else if (playerVelocity.x < 0 && !previousFrameCircle.intersects(platformRightEdge) && playerCollisionCircle.intersects(platformRightEdge)) // Moving left & was to the right
+			}
+		}, s3d::TaskAffinity::MainThread);
+
+	const auto simulationStage = frameGraph.add("simulation", [&]()
+		{
+			for (s3d::int32 i = timestep.advance(deltaTime); 0 < i; --i)
+			{
+				input.jumpDown = pendingJumpDown;
+				pendingJumpDown = false;
+
+				if (rewinding)
 				{
-					if (playerCollisionCircle.bottom().y > platform.top().y && playerCollisionCircle.top().y < platform.bottom().y) // Vertical overlap
+					// Each step undoes one earlier step instead of simulating
+					if (rewindSnapshots.rewind())
 					{
-						playerPosition.x = platform.right().x + 30;
-						playerVelocity.x = 0;
+						SnapshotReader reader{ rewindSnapshots.latest() };
+						world.loadState(reader);
+						recording.frames.pop_back();
 					}
+
+					continue;
 				}
-				playerCollisionCircle.setPos(playerPosition); // Update for next platform check
+
+				world.step(timestep.stepSeconds(), input);
+				recording.record(input);
+				takeSnapshot();
 			}
-		}
 
-		// Main Ground Collision (Fallback)
-		if (playerPosition.y >= GROUND_Y - 30.0)
+			playerPosition = world.interpolatedPlayerPosition(timestep.alpha());
+		});
+
+	const auto particleStage = frameGraph.add("particles", [&]()
 		{
-			playerPosition.y = GROUND_Y - 30.0;
-			playerVelocity.y = 0.0;
-		}
+			particles.setPosition(dashTrail, playerPosition);
+			particles.setEmitting(dashTrail, world.state().isDashing);
+			particles.update(deltaTime);
+		});
 
-		// Update camera
-		// Camera follows player's X, Y is positioned to keep ground in lower third of screen
-		camera.setCenter(s3d::Vec2{ playerPosition.x, GROUND_Y - (s3d::Scene::Height() / 3.0) });
-		camera.update();
+	const auto cameraStage = frameGraph.add("camera", [&]()
+		{
+			// Update camera
+			// Camera follows player's X, Y is positioned to keep ground in lower third of screen
+			camera.setCenter(s3d::Vec2{ playerPosition.x, GROUND_Y - (s3d::Scene::Height() / 3.0) });
+			camera.update();
+		}, s3d::TaskAffinity::MainThread);
 
-		{ // Start Transformer2D scope
+	const auto drawStage = frameGraph.add("draw", [&]()
+		{
+			const PlatformerState& state = world.state();
 			const auto t = camera.createTransformer();
 
-			// Draw Ground (extended)
-			s3d::Line(-10000, GROUND_Y, 10000, GROUND_Y).draw(2, s3d::Palette::Gray);
+			// Only what is inside the camera view is drawn
+			const s3d::RectF viewRegion = camera.getRegion();
 
-			// Draw Level Objects
-			for (const auto& obj : levelObjects)
-			{
-				obj.draw(s3d::Palette::Green); // Example color
-			}
+			// Draw Ground (across the view)
+			s3d::Line(viewRegion.leftX(), GROUND_Y, viewRegion.rightX(), GROUND_Y).draw(2, s3d::Palette::Gray);
+
+			// Draw Level Objects (one batch for all visible rects)
+			levelRenderer.draw(world.collisionGrid(), viewRegion, s3d::Palette::Green);
 
 			// Draw Player (with animation placeholder)
 			s3d::ColorF playerColor = s3d::Palette::Orange;
-			// Re-evaluate finalIsOnGround based on current, possibly corrected, position and velocity
-			bool finalIsOnGround = (s3d::Math::NearlyEquals(playerVelocity.y, 0.0, 0.1) &&
-									(playerPosition.y >= GROUND_Y - 30.0 - 1.0));
-			if (!finalIsOnGround && s3d::Math::NearlyEquals(playerVelocity.y, 0.0, 0.1)) {
-				s3d::Circle feetCircle{ playerPosition.movedBy(0, 1), 28 };
-				for (const auto& platform : levelObjects) {
-					if (feetCircle.intersects(platform) && playerPosition.y < platform.top() +1) {
-						finalIsOnGround = true;
-						break;
-					}
-				}
-			}
 
-			if (isDashing)
+			if (state.isDashing)
 			{
 				playerColor = s3d::Palette::Yellow;
 			}
-			else if (playerVelocity.y < 0 && !finalIsOnGround) // Moving upwards and not on ground
+			else if ((state.playerVelocity.y < 0) && (not state.isOnGround)) // Moving upwards and not on ground
 			{
 				playerColor = s3d::Palette::Lightblue;
 			}
-			s3d::Circle(playerPosition, 30).draw(playerColor);
-		} // Transformer2D scope ends
+			particles.draw();
+			s3d::Circle(playerPosition, PLAYER_RADIUS).draw(playerColor);
+		}, s3d::TaskAffinity::MainThread);
+
+	frameGraph
+		.precede(inputStage, simulationStage)
+		.precede(simulationStage, particleStage)
+		.precede(simulationStage, cameraStage)
+		.succeed(drawStage, { particleStage, cameraStage });
+
+	while (s3d::System::Update())
+	{
+		// Timeline of individual frames for chrome://tracing or Perfetto ([F2] starts recording, [F2] again saves trace.json)
+		if (s3d::KeyF2.down())
+		{
+			if (s3d::TraceRecorder::IsRecording())
+			{
+				s3d::TraceRecorder::Stop();
+				s3d::TraceRecorder::Save(U"trace.json");
+			}
+			else
+			{
+				s3d::TraceRecorder::Start();
+			}
+		}
+
+		if (s3d::TraceRecorder::IsRecording())
+		{
+			// Draw statistics are those of the previous frame
+			const s3d::ProfilerStat stat = s3d::Profiler::GetStat();
+			s3d::TraceRecorder::MarkFrame(s3d::Scene::FrameCount());
+			s3d::TraceRecorder::Counter("drawCalls", stat.drawCalls);
+			s3d::TraceRecorder::Counter("triangleCount", stat.triangleCount);
+		}
+
+		// Each stage is profiled under its own name
+		frameGraph.run();
+
+		if (s3d::KeyF1.down())
+		{
+			showProfile = (not showProfile);
+			s3d::ClearPrint();
+		}
+
+		// Headless checks of the simulation ([F9])
+		if (s3d::KeyF9.down())
+		{
+			s3d::ClearPrint();
+			showProfile = false;
+
+			for (const auto& line : RunDiagnostics())
+			{
+				s3d::Print << line;
+			}
+		}
+
+		if (showProfile)
+		{
+			s3d::ClearPrint();
+
+			for (const auto& stat : s3d::ScopeProfiler::GetStats())
+			{
+				s3d::Print << U"{}: p50 {:.1f} / p95 {:.1f} / p99 {:.1f} us"_fmt(s3d::Unicode::Widen(stat.name),
+					(stat.p50NS / 1000.0), (stat.p95NS / 1000.0), (stat.p99NS / 1000.0));
+			}
+		}
 	}
 }
 
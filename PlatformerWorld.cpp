@@ -0,0 +1,281 @@
+﻿# include <Siv3D/ScopeProfiler.hpp>
+# include "PlatformerWorld.hpp"
+# include "Snapshot.hpp"
+
+namespace
+{
+	// Bounded so that a player wedged into a corner cannot stall the step
+	constexpr s3d::int32 MaxSlideIterations = 4;
+
+	// A surface counts as ground when its normal points at most about 45 degrees away from straight up
+	constexpr double MinGroundNormalUp = 0.7;
+
+	// Bumped whenever saveState() changes what it writes
+	constexpr s3d::uint32 StateVersion = 1;
+
+	// Bytes saveState() writes after the version and size; the fields are written one by one, so there is no padding
+	constexpr s3d::uint32 StateBytes = static_cast<s3d::uint32>((sizeof(s3d::Vec2) * 3) + (sizeof(double) * 3) + (sizeof(bool) * 3));
+}
+
+PlatformerWorld::PlatformerWorld(s3d::Array<s3d::Rect> levelObjects)
+	: m_levelObjects{ std::move(levelObjects) }
+{
+	for (const auto& levelObject : m_levelObjects)
+	{
+		m_collisionGrid.insert(levelObject);
+	}
+}
+
+void PlatformerWorld::step(const double deltaTime, const InputFrame& input)
+{
+	m_previousPlayerPosition = m_state.playerPosition;
+
+	updateDash(deltaTime, input);
+
+	// Horizontal Movement
+	m_state.playerVelocity.x = 0.0;
+	double actualMoveSpeed = PLAYER_MOVE_SPEED;
+
+	if (m_state.isDashing)
+	{
+		actualMoveSpeed *= DASH_SPEED_MULTIPLIER;
+	}
+
+	if (input.left)
+	{
+		m_state.playerVelocity.x = -actualMoveSpeed;
+	}
+	else if (input.right)
+	{
+		m_state.playerVelocity.x = actualMoveSpeed;
+	}
+
+	updateJump(deltaTime, input);
+
+	// Update positions based on velocity, sliding along the platforms in the way.
+	// Gravity keeps a resting player pressed into the platform, so standing on it is reported as a floor contact every step.
+	bool isOnGround = moveAndSlide(deltaTime);
+
+	// Main Ground Collision (Fallback)
+	if (m_state.playerPosition.y >= GROUND_Y - PLAYER_RADIUS)
+	{
+		m_state.playerPosition.y = GROUND_Y - PLAYER_RADIUS;
+		m_state.playerVelocity.y = 0.0;
+		isOnGround = true;
+	}
+
+	// Reused by the next step's jump check and by rendering
+	m_state.isOnGround = isOnGround;
+}
+
+const PlatformerState& PlatformerWorld::state() const noexcept
+{
+	return m_state;
+}
+
+void PlatformerWorld::setState(const PlatformerState& state) noexcept
+{
+	m_state = state;
+	m_previousPlayerPosition = state.playerPosition;
+}
+
+s3d::Vec2 PlatformerWorld::interpolatedPlayerPosition(const double alpha) const noexcept
+{
+	return m_previousPlayerPosition.lerp(m_state.playerPosition, alpha);
+}
+
+const s3d::Array<s3d::Rect>& PlatformerWorld::levelObjects() const noexcept
+{
+	return m_levelObjects;
+}
+
+const CollisionGrid& PlatformerWorld::collisionGrid() const noexcept
+{
+	return m_collisionGrid;
+}
+
+void PlatformerWorld::saveState(SnapshotWriter& writer) const
+{
+	writer.write(StateVersion);
+	writer.write(StateBytes);
+	writer.write(m_state.playerPosition);
+	writer.write(m_state.playerVelocity);
+	writer.write(m_state.dashTimer);
+	writer.write(m_state.dashCooldownTimer);
+	writer.write(m_state.isDashing);
+	writer.write(m_state.isJumpingForKeyHold);
+	writer.write(m_state.currentJumpSustainTime);
+	writer.write(m_state.isOnGround);
+	writer.write(m_previousPlayerPosition);
+}
+
+bool PlatformerWorld::loadState(SnapshotReader& reader)
+{
+	s3d::uint32 version = 0;
+	s3d::uint32 size = 0;
+
+	// Snapshots of another version or layout are rejected rather than misread
+	if ((not reader.read(version)) || (version != StateVersion)
+		|| (not reader.read(size)) || (size != StateBytes)
+		|| (reader.remaining() < size))
+	{
+		return false;
+	}
+
+	PlatformerState state;
+	s3d::Vec2 previousPlayerPosition;
+
+	// remaining() was checked above, so these reads cannot fail
+	reader.read(state.playerPosition);
+	reader.read(state.playerVelocity);
+	reader.read(state.dashTimer);
+	reader.read(state.dashCooldownTimer);
+	reader.read(state.isDashing);
+	reader.read(state.isJumpingForKeyHold);
+	reader.read(state.currentJumpSustainTime);
+	reader.read(state.isOnGround);
+	reader.read(previousPlayerPosition);
+
+	m_state = state;
+	m_previousPlayerPosition = previousPlayerPosition;
+	return true;
+}
+
+void PlatformerWorld::updateDash(const double deltaTime, const InputFrame& input)
+{
+	// Update Dash Timers
+	if (m_state.dashTimer > 0.0)
+	{
+		m_state.dashTimer -= deltaTime;
+		if (m_state.dashTimer <= 0.0)
+		{
+			m_state.isDashing = false;
+		}
+	}
+	if (m_state.dashCooldownTimer > 0.0)
+	{
+		m_state.dashCooldownTimer -= deltaTime;
+	}
+
+	// Dash Input Handling
+	if (input.dash && (m_state.dashCooldownTimer <= 0.0) && (not m_state.isDashing))
+	{
+		if (input.left || input.right) // Only dash if moving
+		{
+			m_state.isDashing = true;
+			m_state.dashTimer = DASH_DURATION;
+			// Cooldown starts after the current dash finishes plus the explicit cooldown period
+			m_state.dashCooldownTimer = DASH_COOLDOWN + DASH_DURATION;
+		}
+	}
+}
+
+void PlatformerWorld::updateJump(const double deltaTime, const InputFrame& input)
+{
+	// Jump initiation
+	if (input.jumpDown && m_state.isOnGround)
+	{
+		m_state.playerVelocity.y = JUMP_VELOCITY;
+		m_state.isJumpingForKeyHold = true; // Enable jump sustain
+		m_state.currentJumpSustainTime = 0.0; // Reset sustain timer
+	}
+
+	// Jump sustain logic
+	if ((not input.jump) || (m_state.playerVelocity.y >= 0)) // Stop sustaining if key released or player is falling/on apex
+	{
+		m_state.isJumpingForKeyHold = false;
+	}
+
+	if (m_state.isJumpingForKeyHold && (m_state.currentJumpSustainTime < MAX_JUMP_SUSTAIN_DURATION))
+	{
+		m_state.currentJumpSustainTime += deltaTime; // Increment sustain timer
+	}
+	else
+	{
+		m_state.isJumpingForKeyHold = false; // Stop sustaining if max duration reached
+	}
+
+	// Apply gravity (potentially modified by jump sustain)
+	double effectiveGravity = GRAVITY;
+	if (m_state.isJumpingForKeyHold) // If sustaining jump (moving up, key held, within duration)
+	{
+		// Reduce gravity's effect to allow variable jump height
+		effectiveGravity *= (1.0 - JUMP_SUSTAIN_FORCE_REDUCTION_FACTOR);
+	}
+	m_state.playerVelocity.y += (effectiveGravity * deltaTime);
+}
+
+bool PlatformerWorld::moveAndSlide(const double deltaTime)
+{
+	SIV3D_PROFILE_SCOPE("collision");
+
+	// Platform Collision Detection and Response
+	// Strategy: Sweep the player circle along this step's displacement and stop at the first platform it touches.
+	// The part of the motion that goes into the surface is removed from both the remaining displacement and the velocity,
+	// and the rest is swept again so that the player slides along floors and walls.
+	s3d::Vec2& playerPosition = m_state.playerPosition;
+	s3d::Vec2& playerVelocity = m_state.playerVelocity;
+	s3d::Vec2 displacement = (playerVelocity * deltaTime);
+	bool hitFloor = false;
+
+	for (s3d::int32 iteration = 0; iteration < MaxSlideIterations; ++iteration)
+	{
+		if (displacement.isZero())
+		{
+			break;
+		}
+
+		const s3d::Circle playerCollisionCircle{ playerPosition, PLAYER_RADIUS };
+
+		// Only platforms overlapping the path swept this step can be hit
+		const s3d::RectF sweptBounds{ s3d::Arg::center = (playerPosition + displacement / 2),
+			(s3d::Abs(displacement.x) + PLAYER_RADIUS * 2),
+			(s3d::Abs(displacement.y) + PLAYER_RADIUS * 2) };
+		m_collisionGrid.query(sweptBounds, m_candidates);
+
+		s3d::Optional<s3d::Geometry2D::SweepHit> firstHit;
+
+		for (const auto id : m_candidates)
+		{
+			if (const auto hit = s3d::Geometry2D::SweepCircle(playerCollisionCircle, displacement, m_collisionGrid.get(id));
+				hit && ((not firstHit) || (hit->time < firstHit->time)))
+			{
+				firstHit = hit;
+			}
+		}
+
+		if (not firstHit)
+		{
+			playerPosition += displacement;
+			break;
+		}
+
+		playerPosition += (displacement * firstHit->time);
+
+		const s3d::Vec2& normal = firstHit->normal;
+		hitFloor |= (normal.y <= -MinGroundNormalUp);
+
+		displacement *= (1.0 - firstHit->time);
+		displacement -= (normal * displacement.dot(normal));
+
+		if (const double intoSurface = playerVelocity.dot(normal);
+			intoSurface < 0.0)
+		{
+			playerVelocity -= (normal * intoSurface);
+		}
+	}
+
+	return hitFloor;
+}
+
+s3d::Array<s3d::Rect> MakeDefaultLevel()
+{
+	const s3d::int32 groundY = static_cast<s3d::int32>(GROUND_Y);
+
+	return{
+		s3d::Rect{ 200, groundY - 100, 200, 20 }, // Platform 1
+		s3d::Rect{ 500, groundY - 180, 150, 20 }, // Platform 2
+		s3d::Rect{ 300, groundY - 100 - 50, 20, 50 }, // A small wall on top of platform 1
+		s3d::Rect{ 800, groundY - 120, 100, 20 }, // Floating Platform
+	};
+}
@@ -0,0 +1,104 @@
+﻿# pragma once
+// The simulation only depends on header-only containers and geometry,
+// so it can be stepped without a window, GPU or System::Update().
+# include <Siv3D/Array.hpp>
+# include <Siv3D/2DShapes.hpp> // Circle, Rect, Line and Geometry2D
+# include "CollisionGrid.hpp"
+# include "InputFrame.hpp"
+
+class SnapshotWriter;
+class SnapshotReader;
+
+const double GRAVITY = 1000.0; // Pixels per second per second
+const double JUMP_VELOCITY = -500.0; // Negative for upward velocity
+const double GROUND_Y = 500.0;
+const double PLAYER_RADIUS = 30.0;
+const double PLAYER_MOVE_SPEED = 200.0; // Horizontal speed
+const double DASH_SPEED_MULTIPLIER = 2.5;
+const double DASH_DURATION = 0.2; // seconds
+const double DASH_COOLDOWN = 0.5; // seconds
+const double JUMP_SUSTAIN_FORCE_REDUCTION_FACTOR = 0.5; // Reduce gravity by this factor while sustaining
+const double MAX_JUMP_SUSTAIN_DURATION = 0.25; // Max time player can sustain jump by holding key
+
+// Everything the simulation mutates from step to step
+struct PlatformerState
+{
+	s3d::Vec2 playerPosition{ 100, GROUND_Y - PLAYER_RADIUS }; // Start on main ground line
+
+	s3d::Vec2 playerVelocity{ 0.0, 0.0 };
+
+	// Dash mechanic state
+	double dashTimer = 0.0; // How long current dash lasts
+
+	double dashCooldownTimer = 0.0; // Time until next dash is available
+
+	bool isDashing = false;
+
+	// Jump mechanic state
+	bool isJumpingForKeyHold = false; // True if jump key is held, allowing sustain
+
+	double currentJumpSustainTime = 0.0; // How long jump has been sustained
+
+	// Whether the player rests on the ground or a platform after the last step
+	bool isOnGround = true;
+};
+
+class PlatformerWorld
+{
+public:
+
+	PlatformerWorld() = default;
+
+	explicit PlatformerWorld(s3d::Array<s3d::Rect> levelObjects);
+
+	// Advances the simulation by deltaTime seconds
+	void step(double deltaTime, const InputFrame& input);
+
+	[[nodiscard]]
+	const PlatformerState& state() const noexcept;
+
+	// Replaces the simulation state, e.g. to place the player for a test; interpolation starts from the new position
+	void setState(const PlatformerState& state) noexcept;
+
+	// Player position blended between the last two steps; alpha is in [0, 1]
+	[[nodiscard]]
+	s3d::Vec2 interpolatedPlayerPosition(double alpha) const noexcept;
+
+	[[nodiscard]]
+	const s3d::Array<s3d::Rect>& levelObjects() const noexcept;
+
+	// Broad-phase index over levelObjects(), e.g. for culling
+	[[nodiscard]]
+	const CollisionGrid& collisionGrid() const noexcept;
+
+	// Writes everything step() mutates, field by field after a version and size; the level objects are static and not included
+	void saveState(SnapshotWriter& writer) const;
+
+	// Restores a state written by saveState(); the world is left unchanged if the version or size does not match
+	bool loadState(SnapshotReader& reader);
+
+private:
+
+	PlatformerState m_state;
+
+	s3d::Vec2 m_previousPlayerPosition = m_state.playerPosition;
+
+	s3d::Array<s3d::Rect> m_levelObjects;
+
+	// Broad-phase over m_levelObjects; IDs match the indices of m_levelObjects
+	CollisionGrid m_collisionGrid;
+
+	// Reused query buffer so that steps do not allocate
+	s3d::Array<CollisionGrid::ID> m_candidates;
+
+	void updateDash(double deltaTime, const InputFrame& input);
+
+	void updateJump(double deltaTime, const InputFrame& input);
+
+	// Returns true if the player was stopped by a floor, i.e. a surface whose normal points up
+	bool moveAndSlide(double deltaTime);
+};
+
+// The hand-placed test level
+[[nodiscard]]
+s3d::Array<s3d::Rect> MakeDefaultLevel();
@@ -174,6 +174,9 @@
 // kd 木 | kd-tree
 # include <Siv3D/KDTree.hpp>
 
+// 空間ハッシュグリッド | Spatial hash grid
+# include <Siv3D/SpatialHashGrid.hpp>
+
 // Disjoint-set (Union-find) | Disjoint-set (Union–find)
 # include <Siv3D/DisjointSet.hpp>
 
@@ -192,6 +195,15 @@
 // 非同期タスク | Asynchronous task
 # include <Siv3D/AsyncTask.hpp>
 
+// スレッドプール | Thread pool
+# include <Siv3D/ThreadPool.hpp>
+
+// スレッドプールで実行する非同期タスク | Thread pool task
+# include <Siv3D/PoolTask.hpp>
+
+// タスクグラフ | Task graph
+# include <Siv3D/TaskGraph.hpp>
+
 // 子プロセス | Child process
 # include <Siv3D/ChildProcess.hpp>
 
@@ -360,6 +372,12 @@
 // 時間の測定 | Time profiler
 # include <Siv3D/TimeProfiler.hpp>
 
+// タイムラインの記録 | Trace recorder
+# include <Siv3D/TraceRecorder.hpp>
+
+// スコープ単位の軽量な時間計測 | Scope profiler
+# include <Siv3D/ScopeProfiler.hpp>
+
 //////////////////////////////////////////////////
 //
 //	ファイル I/O | File I/O
@@ -450,6 +468,9 @@
 // Zstandard 方式による可逆圧縮 | Lossless compression with Zstandard algorithm
 # include <Siv3D/Compression.hpp>
 
+// Zstandard 方式による逐次圧縮と並列圧縮 | Streaming and multi-threaded compression with Zstandard algorithm
+# include <Siv3D/CompressionStream.hpp>
+
 // ZIP 圧縮ファイルの読み込み | ZIP reader
 # include <Siv3D/ZIPReader.hpp>
 
@@ -474,12 +495,21 @@
 // CSV データの読み書き | CSV reader/writer
 # include <Siv3D/CSV.hpp>
 
+// CSV データの逐次読み込み | Streaming CSV reader
+# include <Siv3D/CSVReader.hpp>
+
 // INI データの読み書き | INI reader/writer
 # include <Siv3D/INI.hpp>
 
 // JSON データの読み書き | JSON reader/writer
 # include <Siv3D/JSON.hpp>
 
+// JSON データの逐次読み込み | Streaming JSON reader
+# include <Siv3D/JSONReader.hpp>
+
+// JSON データの逐次書き出し | Streaming JSON writer
+# include <Siv3D/JSONWriter.hpp>
+
 // JSON データの検証 | JSON validation
 # include <Siv3D/JSONValidator.hpp>
 
@@ -1753,11 +1783,20 @@
 
 # include <Siv3D/PolygonEmitter2D.hpp>
 
+// 2D パーティクルシステム | 2D Particle system (Batch emission)
+# include <Siv3D/BatchEmitter2D.hpp>
+
 # include <Siv3D/ParticleSystem2DParameters.hpp>
 
 // 2D パーティクルシステム | 2D Particle system (System)
 # include <Siv3D/ParticleSystem2D.hpp>
 
+// 2D パーティクルシステム | 2D Particle system (SoA buffer)
+# include <Siv3D/ParticleBuffer2D.hpp>
+
+// 2D パーティクルシステム | 2D Particle system (World)
+# include <Siv3D/ParticleWorld2D.hpp>
+
 //////////////////////////////////////////////////
 //
 //	2D 物理演算 | 2D Physics
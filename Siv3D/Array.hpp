@@ -17,6 +17,7 @@
 # include <vector>
 # ifndef SIV3D_NO_CONCURRENT_API
 	# include <future>
+	# include "ThreadPool.hpp"
 	# if SIV3D_PLATFORM(WINDOWS)
 	#	include <execution>
 	# endif
@@ -0,0 +1,77 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <span>
+# include <typeinfo>
+# include "Common.hpp"
+# include "PointVector.hpp"
+# include "PRNG.hpp"
+# include "Math.hpp"
+# include "SIMD.hpp"
+# include "Emission2D.hpp"
+# include "IEmitter2D.hpp"
+# include "CircleEmitter2D.hpp"
+# include "ArcEmitter2D.hpp"
+# include "RectEmitter2D.hpp"
+
+namespace s3d
+{
+	/// @brief パーティクルの出現位置と初速をまとめて生成できるエミッタのインタフェース
+	/// @remark IEmitter2D を継承した独自のエミッタがこのインタフェースも継承すると、`EmitN()` は `emit()` を繰り返し呼ぶかわりに `emitN()` を使います。
+	struct IBatchEmitter2D
+	{
+		virtual ~IBatchEmitter2D() = default;
+
+		/// @brief emissions のすべての要素に出現位置と初速を書き込みます。
+		/// @param emissions 書き込み先
+		/// @param emitterPosition エミッタの位置
+		/// @param startSpeed 初速の大きさ
+		/// @param rng 乱数生成器
+		virtual void emitN(std::span<Emission2D> emissions, const Vec2& emitterPosition, double startSpeed, SmallRNG& rng) = 0;
+	};
+
+	/// @brief CircleEmitter2D と同じパラメータで、出現位置と初速をまとめて生成します。
+	/// @param emissions 書き込み先
+	/// @param emitter エミッタ
+	/// @param emitterPosition エミッタの位置
+	/// @param startSpeed 初速の大きさ
+	/// @param rng 乱数生成器
+	void EmitN(std::span<Emission2D> emissions, const CircleEmitter2D& emitter, const Vec2& emitterPosition, double startSpeed, SmallRNG& rng) noexcept;
+
+	/// @brief ArcEmitter2D と同じパラメータで、出現位置と初速をまとめて生成します。
+	/// @param emissions 書き込み先
+	/// @param emitter エミッタ
+	/// @param emitterPosition エミッタの位置
+	/// @param startSpeed 初速の大きさ
+	/// @param rng 乱数生成器
+	void EmitN(std::span<Emission2D> emissions, const ArcEmitter2D& emitter, const Vec2& emitterPosition, double startSpeed, SmallRNG& rng) noexcept;
+
+	/// @brief RectEmitter2D と同じパラメータで、出現位置と初速をまとめて生成します。
+	/// @param emissions 書き込み先
+	/// @param emitter エミッタ
+	/// @param emitterPosition エミッタの位置
+	/// @param startSpeed 初速の大きさ
+	/// @param rng 乱数生成器
+	void EmitN(std::span<Emission2D> emissions, const RectEmitter2D& emitter, const Vec2& emitterPosition, double startSpeed, SmallRNG& rng) noexcept;
+
+	/// @brief エミッタの種類に応じた方法で、出現位置と初速をまとめて生成します。
+	/// @param emissions 書き込み先
+	/// @param emitter エミッタ
+	/// @param emitterPosition エミッタの位置
+	/// @param startSpeed 初速の大きさ
+	/// @param rng 乱数生成器
+	/// @remark 組み込みの Circle / Arc / Rect エミッタと IBatchEmitter2D を継承したエミッタはまとめて生成し、それ以外のエミッタ（PolygonEmitter2D を含む）は `emit()` を繰り返し呼びます。
+	/// @remark 組み込みのエミッタを継承したクラスは `emit()` を上書きしている可能性があるため、`emit()` を繰り返し呼びます。
+	void EmitN(std::span<Emission2D> emissions, IEmitter2D& emitter, const Vec2& emitterPosition, double startSpeed, SmallRNG& rng);
+}
+
+# include "detail/BatchEmitter2D.ipp"
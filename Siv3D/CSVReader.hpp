@@ -0,0 +1,214 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cstring>
+# include <memory>
+# include <string>
+# include <string_view>
+# include "Common.hpp"
+# include "Array.hpp"
+# include "Utility.hpp"
+# include "String.hpp"
+# include "Optional.hpp"
+# include "Parse.hpp"
+# include "Unicode.hpp"
+# include "IReader.hpp"
+# include "MemoryMappedFileView.hpp"
+# include "SIMD.hpp"
+# ifndef SIV3D_NO_CONCURRENT_API
+#	include "ThreadPool.hpp"
+# endif
+
+namespace s3d
+{
+	/// @brief CSV 形式のデータを、先頭から 1 行ずつ読み込むクラス
+	/// @remark `CSV` と異なり、データ全体を String に変換して保持しません。ファイルはメモリマップトファイルとして開き、各列はファイルの内容（UTF-8）を指す `std::string_view` として取得します。
+	/// @remark 引用符で囲まれた列では、2 つ続いた引用符を 1 つの引用符として扱います。引用符で囲まれた列は改行を含むことができます。
+	class CSVReader
+	{
+	public:
+
+		/// @brief 1 行分の列
+		/// @remark 列の内容は読み込み元の CSVReader のデータを指すため、CSVReader を閉じた後は使えません。
+		class Row
+		{
+		public:
+
+			/// @brief 列数を返します。
+			/// @return 列数。空行の場合は 0
+			[[nodiscard]]
+			size_t size() const noexcept;
+
+			/// @brief 列が無い（空行である）かを返します。
+			/// @return 列が無い場合 true, それ以外の場合は false
+			[[nodiscard]]
+			bool isEmpty() const noexcept;
+
+			/// @brief 列の内容を返します。
+			/// @param column 列
+			/// @return 列の内容（UTF-8）。引用符で囲まれた列では前後の引用符を除いた内容で、2 つ続いた引用符はそのまま含まれます。
+			[[nodiscard]]
+			std::string_view operator [](size_t column) const noexcept;
+
+			/// @brief 指定した列の値を読み取ります。失敗した場合は `Type()` を返します。
+			/// @tparam Type 読み取る値の型
+			/// @param column 列
+			/// @return 読み取った値
+			/// @remark 整数、浮動小数点数、bool は UTF-8 のまま変換します。それ以外の型は String に変換してから `ParseOpt()` で変換します。
+			template <class Type = String>
+			[[nodiscard]]
+			Type get(size_t column) const;
+
+			/// @brief 指定した列の値を読み取ります。失敗した場合は defaultValue を返します。
+			/// @tparam Type 読み取る値の型
+			/// @tparam U デフォルトの値の型
+			/// @param column 列
+			/// @param defaultValue デフォルトの値
+			/// @return 読み取った値。失敗した場合はデフォルトの値
+			template <class Type, class U>
+			[[nodiscard]]
+			Type getOr(size_t column, U&& defaultValue) const;
+
+			/// @brief 指定した列の値を読み取ります。失敗した場合は none を返します。
+			/// @tparam Type 読み取る値の型
+			/// @param column 列
+			/// @return 読み取った値。失敗した場合は none
+			template <class Type>
+			[[nodiscard]]
+			Optional<Type> getOpt(size_t column) const;
+
+		private:
+
+			friend class CSVReader;
+
+			struct Field
+			{
+				std::string_view text;
+
+				// 2 つ続いた引用符を含む
+				bool escaped;
+			};
+
+			Array<Field> m_fields;
+
+			char m_quote = '"';
+
+			[[nodiscard]]
+			std::string unescape(const Field& field) const;
+		};
+
+		SIV3D_NODISCARD_CXX20
+		CSVReader() = default;
+
+		/// @brief CSV ファイルを開きます。
+		/// @param path ファイルパス
+		/// @param separator 列の区切り文字
+		/// @param quote 引用符
+		SIV3D_NODISCARD_CXX20
+		explicit CSVReader(FilePathView path, char separator = ',', char quote = '"');
+
+		/// @brief Reader から CSV データを読み込みます。
+		/// @tparam Reader Reader の型
+		/// @param reader Reader
+		/// @param separator 列の区切り文字
+		/// @param quote 引用符
+		/// @remark データはすべてメモリに読み込まれます。
+		template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>* = nullptr>
+		SIV3D_NODISCARD_CXX20
+		explicit CSVReader(Reader&& reader, char separator = ',', char quote = '"');
+
+		/// @brief Reader から CSV データを読み込みます。
+		/// @param reader Reader
+		/// @param separator 列の区切り文字
+		/// @param quote 引用符
+		/// @remark データはすべてメモリに読み込まれます。
+		SIV3D_NODISCARD_CXX20
+		explicit CSVReader(std::unique_ptr<IReader>&& reader, char separator = ',', char quote = '"');
+
+		/// @brief CSV ファイルを開きます。
+		/// @param path ファイルパス
+		/// @param separator 列の区切り文字
+		/// @param quote 引用符
+		/// @return ファイルを開けた場合 true, それ以外の場合は false
+		bool open(FilePathView path, char separator = ',', char quote = '"');
+
+		/// @brief Reader から CSV データを読み込みます。
+		/// @tparam Reader Reader の型
+		/// @param reader Reader
+		/// @param separator 列の区切り文字
+		/// @param quote 引用符
+		/// @return 読み込みに成功した場合 true, それ以外の場合は false
+		template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>* = nullptr>
+		bool open(Reader&& reader, char separator = ',', char quote = '"');
+
+		/// @brief Reader から CSV データを読み込みます。
+		/// @param reader Reader
+		/// @param separator 列の区切り文字
+		/// @param quote 引用符
+		/// @return 読み込みに成功した場合 true, それ以外の場合は false
+		bool open(std::unique_ptr<IReader>&& reader, char separator = ',', char quote = '"');
+
+		void close();
+
+		[[nodiscard]]
+		bool isOpen() const noexcept;
+
+		[[nodiscard]]
+		explicit operator bool() const noexcept;
+
+		/// @brief 読み込む範囲の大きさを返します。
+		/// @return 読み込む範囲の大きさ（バイト）
+		[[nodiscard]]
+		size_t size() const noexcept;
+
+		/// @brief 次の行を読み込みます。
+		/// @param row 読み込んだ行を格納するオブジェクト。同じオブジェクトを使い回すと、行ごとのメモリ確保が発生しません。
+		/// @return 行を読み込んだ場合 true, 読み込む行が残っていない場合は false
+		bool readRow(Row& row);
+
+		/// @brief 読み込み位置を先頭に戻します。
+		void rewind() noexcept;
+
+		/// @brief 現在の読み込み位置から後ろのデータを、行の境界で count 個以下に分けた CSVReader を返します。
+		/// @param count 分割数
+		/// @return 分割した CSVReader の配列。先頭から順に並んでいます。
+		/// @remark 分割した CSVReader は、それぞれ別のスレッドで読み込むことができます。
+		/// @remark 分割位置は、引用符の数の偶奇から引用符の外側にある改行を選びます。引用符で囲まれていない列に引用符を含むデータでは、正しく分割できません。
+		[[nodiscard]]
+		Array<CSVReader> split(size_t count) const;
+
+	private:
+
+		struct Storage
+		{
+			MemoryMappedFileView file;
+
+			std::string buffer;
+		};
+
+		std::shared_ptr<const Storage> m_storage;
+
+		const char* m_begin = nullptr;
+
+		const char* m_end = nullptr;
+
+		const char* m_pos = nullptr;
+
+		char m_separator = ',';
+
+		char m_quote = '"';
+
+		void reset(std::shared_ptr<const Storage> storage, const char* begin, const char* end, char separator, char quote);
+	};
+}
+
+# include "detail/CSVReader.ipp"
@@ -0,0 +1,262 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include "Common.hpp"
+# include "Array.hpp"
+# include "Blob.hpp"
+# include "IReader.hpp"
+# include "IWriter.hpp"
+# include "BinaryReader.hpp"
+# include "Compression.hpp"
+# ifndef SIV3D_NO_CONCURRENT_API
+#	include "ThreadPool.hpp"
+# endif
+
+namespace s3d
+{
+	/// @brief データを一定の大きさのフレームごとに Zstandard 方式で圧縮し、Writer に逐次書き出すクラス
+	/// @remark 書き出すデータは Zstandard の seekable 形式（独立したフレームの列と、末尾のシークテーブル）で、通常の Zstandard のデータとしても伸張できます。
+	/// @remark 使用するメモリは、フレームの大きさと同時に圧縮するフレームの数に比例し、データ全体の大きさには依存しません。
+	class CompressionWriter
+	{
+	public:
+
+		/// @brief デフォルトのフレームの大きさ（バイト）
+		static constexpr size_t DefaultFrameSize = (1 << 20);
+
+		SIV3D_NODISCARD_CXX20
+		CompressionWriter() = default;
+
+		/// @brief 圧縮したデータを writer に書き出す CompressionWriter を作成します。
+		/// @param writer 書き出し先の Writer
+		/// @param compressionLevel 圧縮レベル
+		/// @param frameSize フレームの大きさ（バイト）。小さいほどランダムアクセスが速く、大きいほど圧縮率が高くなります。
+		/// @param concurrency 同時に圧縮するフレームの数。2 以上の場合はスレッドプールで圧縮します。
+		/// @remark writer は CompressionWriter よりも長く存在する必要があります。
+		SIV3D_NODISCARD_CXX20
+		explicit CompressionWriter(IWriter& writer, int32 compressionLevel = Compression::DefaultLevel, size_t frameSize = DefaultFrameSize, size_t concurrency = 1);
+
+		CompressionWriter(const CompressionWriter&) = delete;
+
+		CompressionWriter& operator =(const CompressionWriter&) = delete;
+
+		/// @brief デストラクタ
+		/// @remark `finish()` を呼んでいない場合は呼びます。
+		~CompressionWriter();
+
+		/// @brief 圧縮したデータを writer に書き出す準備をします。
+		/// @param writer 書き出し先の Writer
+		/// @param compressionLevel 圧縮レベル
+		/// @param frameSize フレームの大きさ（バイト）
+		/// @param concurrency 同時に圧縮するフレームの数
+		/// @return writer が使用可能な場合 true, それ以外の場合は false
+		bool open(IWriter& writer, int32 compressionLevel = Compression::DefaultLevel, size_t frameSize = DefaultFrameSize, size_t concurrency = 1);
+
+		[[nodiscard]]
+		bool isOpen() const noexcept;
+
+		[[nodiscard]]
+		explicit operator bool() const noexcept;
+
+		/// @brief データを追加します。
+		/// @param src 追加するデータの先頭ポインタ
+		/// @param sizeBytes 追加するデータの大きさ（バイト）
+		/// @return 圧縮と書き出しに失敗していない場合 true, それ以外の場合は false
+		bool write(const void* src, size_t sizeBytes);
+
+		/// @brief Reader の現在の読み込み位置から終端までのデータを追加します。
+		/// @param reader Reader
+		/// @return 圧縮と書き出しに失敗していない場合 true, それ以外の場合は false
+		bool write(IReader& reader);
+
+		/// @brief 残りのデータとシークテーブルを書き出して、書き出しを終了します。
+		/// @return すべての圧縮と書き出しに成功した場合 true, それ以外の場合は false
+		bool finish();
+
+		/// @brief これまでに追加したデータの大きさを返します。
+		/// @return 追加したデータの大きさ（バイト）
+		[[nodiscard]]
+		uint64 uncompressedSize() const noexcept;
+
+	private:
+
+		IWriter* m_writer = nullptr;
+
+		int32 m_compressionLevel = Compression::DefaultLevel;
+
+		size_t m_frameSize = DefaultFrameSize;
+
+		// 圧縮を待っているデータ（最大でフレーム concurrency 個分）
+		Array<Byte> m_input;
+
+		size_t m_inputSize = 0;
+
+		// 圧縮したフレーム（同時に圧縮するフレームごとに再利用する）
+		Array<Blob> m_frames;
+
+		Array<uint8> m_succeeded;
+
+		// フレームごとの圧縮後と圧縮前の大きさ
+		Array<uint32> m_seekTable;
+
+		uint64 m_uncompressedSize = 0;
+
+		bool m_failed = false;
+
+		bool flushFrames();
+	};
+
+	/// @brief CompressionWriter が書き出したデータを伸張しながら読み込む Reader
+	/// @remark シークテーブルを使って必要なフレームだけを伸張するため、大きなデータの任意の位置を少ないメモリで読み込めます。
+	class CompressionReader : public IReader
+	{
+	public:
+
+		SIV3D_NODISCARD_CXX20
+		CompressionReader() = default;
+
+		/// @brief 圧縮されたファイルを開きます。
+		/// @param path ファイルパス
+		SIV3D_NODISCARD_CXX20
+		explicit CompressionReader(FilePathView path);
+
+		/// @brief Reader から圧縮されたデータを読み込みます。
+		/// @tparam Reader Reader の型
+		/// @param reader Reader
+		template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>* = nullptr>
+		SIV3D_NODISCARD_CXX20
+		explicit CompressionReader(Reader&& reader);
+
+		/// @brief Reader から圧縮されたデータを読み込みます。
+		/// @param reader Reader
+		SIV3D_NODISCARD_CXX20
+		explicit CompressionReader(std::unique_ptr<IReader>&& reader);
+
+		/// @brief 圧縮されたファイルを開きます。
+		/// @param path ファイルパス
+		/// @return シークテーブルを読み込めた場合 true, それ以外の場合は false
+		bool open(FilePathView path);
+
+		/// @brief Reader から圧縮されたデータを読み込みます。
+		/// @tparam Reader Reader の型
+		/// @param reader Reader
+		/// @return シークテーブルを読み込めた場合 true, それ以外の場合は false
+		template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>* = nullptr>
+		bool open(Reader&& reader);
+
+		/// @brief Reader から圧縮されたデータを読み込みます。
+		/// @param reader Reader
+		/// @return シークテーブルを読み込めた場合 true, それ以外の場合は false
+		/// @remark reader は `read(void*, int64, int64)` による任意の位置からの読み込みに対応している必要があります。
+		bool open(std::unique_ptr<IReader>&& reader);
+
+		void close();
+
+		[[nodiscard]]
+		bool supportsLookahead() const noexcept override;
+
+		[[nodiscard]]
+		bool isOpen() const noexcept override;
+
+		[[nodiscard]]
+		explicit operator bool() const noexcept;
+
+		/// @brief 伸張後のデータの大きさを返します。
+		/// @return 伸張後のデータの大きさ（バイト）
+		[[nodiscard]]
+		int64 size() const override;
+
+		[[nodiscard]]
+		int64 getPos() const override;
+
+		bool setPos(int64 pos) override;
+
+		int64 skip(int64 offset) override;
+
+		int64 read(void* dst, int64 size) override;
+
+		int64 read(void* dst, int64 pos, int64 size) override;
+
+		/// @brief Reader からデータを読み込みます。
+		/// @tparam Type 読み込む値の型
+		/// @param dst 読み込み先
+		/// @return 読み込みに成功した場合 true, それ以外の場合は false
+		SIV3D_CONCEPT_TRIVIALLY_COPYABLE
+		bool read(TriviallyCopyable& dst);
+
+		int64 lookahead(void* dst, int64 size) const override;
+
+		int64 lookahead(void* dst, int64 pos, int64 size) const override;
+
+		/// @brief 読み込み位置を変更しないで Reader からデータを読み込みます。
+		/// @tparam Type 読み込む値の型
+		/// @param dst 読み込み先
+		/// @return 読み込みに成功したら true, それ以外の場合は false
+		SIV3D_CONCEPT_TRIVIALLY_COPYABLE
+		bool lookahead(TriviallyCopyable& dst) const;
+
+		/// @brief フレームの数を返します。
+		/// @return フレームの数
+		[[nodiscard]]
+		size_t frameCount() const noexcept;
+
+		/// @brief 現在の読み込み位置から終端までのデータを伸張して writer に書き出し、読み込み位置を終端に移動します。
+		/// @param writer 書き出し先の Writer
+		/// @param concurrency 同時に伸張するフレームの数。2 以上の場合はスレッドプールで伸張します。
+		/// @return すべての伸張と書き出しに成功した場合 true, それ以外の場合は false
+		bool readAll(IWriter& writer, size_t concurrency = 1);
+
+	private:
+
+		struct Frame
+		{
+			int64 compressedOffset;
+
+			int64 offset;
+
+			uint32 compressedSize;
+
+			uint32 size;
+		};
+
+		std::unique_ptr<IReader> m_reader;
+
+		Array<Frame> m_frames;
+
+		int64 m_size = 0;
+
+		int64 m_pos = 0;
+
+		// 最後に伸張したフレーム
+		mutable size_t m_cachedFrame = 0;
+
+		mutable bool m_hasCache = false;
+
+		// 圧縮されたフレームの読み込み先（大きくなるときだけ確保し直す）
+		mutable Blob m_compressed;
+
+		mutable Blob m_cache;
+
+		[[nodiscard]]
+		size_t findFrame(int64 pos) const noexcept;
+
+		bool readCompressedFrame(size_t index, Blob& dst) const;
+
+		// フレームを伸張して m_cache に格納する
+		bool loadFrame(size_t index) const;
+
+		int64 readAt(void* dst, int64 pos, int64 size) const;
+	};
+}
+
+# include "detail/CompressionStream.ipp"
@@ -15,11 +15,16 @@
 //-----------------------------------------------
 
 # pragma once
+# include <array>
+# include <bit>
+# include <cstring>
+# include <span>
 # include "Common.hpp"
 # include "Array.hpp"
 # include "Optional.hpp"
 # include "PointVector.hpp"
 # include "2DShapes.hpp"
+# include "SIMD.hpp"
 
 namespace s3d
 {
@@ -2916,6 +2921,129 @@ namespace s3d
 		/// @return 組み立て得られた多角形 `Polygon` の配列
 		[[nodiscard]]
 		MultiPolygon ComposePolygons(const Array<LineString>& rings);
+
+		//////////////////////////////////////////////////
+		//
+		//	SweepCircle
+		//
+		//////////////////////////////////////////////////
+
+		/// @brief 移動する円が図形に最初に接触したときの情報
+		struct SweepHit
+		{
+			/// @brief 接触する時刻。移動量に対する割合 [0, 1] で表します。
+			double time;
+
+			/// @brief 接触点における図形の外向きの単位法線ベクトル
+			Vec2 normal;
+
+			/// @brief 接触点の座標
+			Vec2 point;
+		};
+
+		/// @brief 円を移動させたときに、長方形に最初に接触する時刻を計算します。
+		/// @param a 移動前の円
+		/// @param velocity 円の移動量
+		/// @param b 長方形
+		/// @return 移動中に接触する場合はその情報、それ以外の場合は none
+		/// @remark 移動前の時点で既に接しているか重なっていて、長方形に向かって移動する場合は時刻 0 の接触を返します。
+		[[nodiscard]]
+		inline Optional<SweepHit> SweepCircle(const Circle& a, const Vec2& velocity, const Rect& b) noexcept;
+
+		/// @brief 円を移動させたときに、長方形に最初に接触する時刻を計算します。
+		/// @param a 移動前の円
+		/// @param velocity 円の移動量
+		/// @param b 長方形
+		/// @return 移動中に接触する場合はその情報、それ以外の場合は none
+		/// @remark 移動前の時点で既に接しているか重なっていて、長方形に向かって移動する場合は時刻 0 の接触を返します。
+		[[nodiscard]]
+		inline Optional<SweepHit> SweepCircle(const Circle& a, const Vec2& velocity, const RectF& b) noexcept;
+
+		//////////////////////////////////////////////////
+		//
+		//	IntersectMany
+		//
+		//////////////////////////////////////////////////
+
+		/// @brief 円と複数の長方形が交差するかをまとめて判定します。
+		/// @param a 円
+		/// @param b 長方形の配列
+		/// @param results 判定結果の書き込み先。b と results の要素数のうち少ないほうの数だけ判定します。
+		/// @return 交差する長方形の個数
+		/// @remark 各要素の結果は `Intersect(a, b[i])` と一致します。
+		inline size_t IntersectMany(const Circle& a, std::span<const Rect> b, std::span<bool> results) noexcept;
+
+		/// @brief 円と複数の長方形が交差するかをまとめて判定し、結果をビットマスクに書き込みます。
+		/// @param a 円
+		/// @param b 長方形の配列
+		/// @param mask 判定結果の書き込み先。b[i] の結果は mask[i / 64] の (i % 64) ビット目に書き込まれます。b と mask の要素数 * 64 のうち少ないほうの数だけ判定します。
+		/// @return 交差する長方形の個数
+		/// @remark 各要素の結果は `Intersect(a, b[i])` と一致します。
+		inline size_t IntersectMany(const Circle& a, std::span<const Rect> b, std::span<uint64> mask) noexcept;
+
+		/// @brief 円と複数の長方形が交差するかをまとめて判定します。
+		/// @param a 円
+		/// @param b 長方形の配列
+		/// @param results 判定結果の書き込み先。b と results の要素数のうち少ないほうの数だけ判定します。
+		/// @return 交差する長方形の個数
+		/// @remark 各要素の結果は `Intersect(a, b[i])` と一致します。
+		inline size_t IntersectMany(const Circle& a, std::span<const RectF> b, std::span<bool> results) noexcept;
+
+		/// @brief 円と複数の長方形が交差するかをまとめて判定し、結果をビットマスクに書き込みます。
+		/// @param a 円
+		/// @param b 長方形の配列
+		/// @param mask 判定結果の書き込み先。b[i] の結果は mask[i / 64] の (i % 64) ビット目に書き込まれます。b と mask の要素数 * 64 のうち少ないほうの数だけ判定します。
+		/// @return 交差する長方形の個数
+		/// @remark 各要素の結果は `Intersect(a, b[i])` と一致します。
+		inline size_t IntersectMany(const Circle& a, std::span<const RectF> b, std::span<uint64> mask) noexcept;
+
+		/// @brief 円と複数の円が交差するかをまとめて判定します。
+		/// @param a 円
+		/// @param b 円の配列
+		/// @param results 判定結果の書き込み先。b と results の要素数のうち少ないほうの数だけ判定します。
+		/// @return 交差する円の個数
+		/// @remark 各要素の結果は `Intersect(a, b[i])` と一致します。
+		inline size_t IntersectMany(const Circle& a, std::span<const Circle> b, std::span<bool> results) noexcept;
+
+		/// @brief 円と複数の円が交差するかをまとめて判定し、結果をビットマスクに書き込みます。
+		/// @param a 円
+		/// @param b 円の配列
+		/// @param mask 判定結果の書き込み先。b[i] の結果は mask[i / 64] の (i % 64) ビット目に書き込まれます。b と mask の要素数 * 64 のうち少ないほうの数だけ判定します。
+		/// @return 交差する円の個数
+		/// @remark 各要素の結果は `Intersect(a, b[i])` と一致します。
+		inline size_t IntersectMany(const Circle& a, std::span<const Circle> b, std::span<uint64> mask) noexcept;
+
+		/// @brief 線分と複数の長方形が交差するかをまとめて判定します。
+		/// @param a 線分
+		/// @param b 長方形の配列
+		/// @param results 判定結果の書き込み先。b と results の要素数のうち少ないほうの数だけ判定します。
+		/// @return 交差する長方形の個数
+		/// @remark 線分が長方形の辺に接する場合も交差とみなします。
+		inline size_t IntersectMany(const Line& a, std::span<const Rect> b, std::span<bool> results) noexcept;
+
+		/// @brief 線分と複数の長方形が交差するかをまとめて判定し、結果をビットマスクに書き込みます。
+		/// @param a 線分
+		/// @param b 長方形の配列
+		/// @param mask 判定結果の書き込み先。b[i] の結果は mask[i / 64] の (i % 64) ビット目に書き込まれます。b と mask の要素数 * 64 のうち少ないほうの数だけ判定します。
+		/// @return 交差する長方形の個数
+		/// @remark 線分が長方形の辺に接する場合も交差とみなします。
+		inline size_t IntersectMany(const Line& a, std::span<const Rect> b, std::span<uint64> mask) noexcept;
+
+		/// @brief 線分と複数の長方形が交差するかをまとめて判定します。
+		/// @param a 線分
+		/// @param b 長方形の配列
+		/// @param results 判定結果の書き込み先。b と results の要素数のうち少ないほうの数だけ判定します。
+		/// @return 交差する長方形の個数
+		/// @remark 線分が長方形の辺に接する場合も交差とみなします。
+		inline size_t IntersectMany(const Line& a, std::span<const RectF> b, std::span<bool> results) noexcept;
+
+		/// @brief 線分と複数の長方形が交差するかをまとめて判定し、結果をビットマスクに書き込みます。
+		/// @param a 線分
+		/// @param b 長方形の配列
+		/// @param mask 判定結果の書き込み先。b[i] の結果は mask[i / 64] の (i % 64) ビット目に書き込まれます。b と mask の要素数 * 64 のうち少ないほうの数だけ判定します。
+		/// @return 交差する長方形の個数
+		/// @remark 線分が長方形の辺に接する場合も交差とみなします。
+		inline size_t IntersectMany(const Line& a, std::span<const RectF> b, std::span<uint64> mask) noexcept;
 	}
 }
 
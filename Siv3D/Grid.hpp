@@ -10,6 +10,7 @@
 //-----------------------------------------------
 
 # pragma once
+# include <atomic>
 # include "Common.hpp"
 # include "Array.hpp"
 # include "PointVector.hpp"
@@ -22,6 +23,70 @@ namespace s3d
 	template <class Type, class Allocator>
 	inline void Formatter(FormatData& formatData, const Grid<Type, Allocator>& value);
 
+	/// @brief Grid の要素を中心とした (2 * radius + 1) x (2 * radius + 1) の近傍
+	/// @tparam Type 要素の型
+	/// @remark `Grid::stencil_map()` のコールバックに渡されます。
+	/// @remark 範囲外の座標は、最も近い端の要素に丸められます。
+	template <class Type>
+	class GridWindow
+	{
+	public:
+
+		SIV3D_NODISCARD_CXX20
+		GridWindow(const Type* data, size_t width, size_t height, int32 radius) noexcept;
+
+		/// @brief 中心からの相対位置にある要素を返します。
+		/// @param dx 中心からの X 方向の位置
+		/// @param dy 中心からの Y 方向の位置
+		/// @return 要素。範囲外の場合は最も近い端の要素
+		[[nodiscard]]
+		const Type& operator ()(int32 dx, int32 dy) const noexcept;
+
+		/// @brief 中心からの相対位置にある要素を返します。
+		/// @param offset 中心からの位置
+		/// @return 要素。範囲外の場合は最も近い端の要素
+		[[nodiscard]]
+		const Type& operator ()(Point offset) const noexcept;
+
+		/// @brief 中心の要素を返します。
+		/// @return 中心の要素
+		[[nodiscard]]
+		const Type& center() const noexcept;
+
+		/// @brief 中心の要素の位置を返します。
+		/// @return 中心の要素の位置
+		[[nodiscard]]
+		Point position() const noexcept;
+
+		/// @brief 近傍の半径を返します。
+		/// @return 近傍の半径
+		[[nodiscard]]
+		int32 radius() const noexcept;
+
+		/// @brief 近傍全体が Grid の範囲内にあるかを返します。
+		/// @return 近傍全体が範囲内にある場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isInterior() const noexcept;
+
+		/// @brief 中心の位置を変更します。
+		/// @param pos 新しい中心の位置
+		void moveTo(Point pos) noexcept;
+
+	private:
+
+		const Type* m_data;
+
+		int32 m_width;
+
+		int32 m_height;
+
+		int32 m_radius;
+
+		Point m_pos{ 0, 0 };
+
+		bool m_interior = false;
+	};
+
 	/// @brief 二次元配列クラス
 	/// @tparam Type 要素の型
 	/// @tparam Allocator アロケータの型
@@ -366,6 +431,30 @@ namespace s3d
 		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type>>* = nullptr>
 		const Grid& each_index(Fty f) const;
 
+		/// @brief tileSize ごとのタイルに分けて、タイル単位の順で各要素に f(位置, 要素) を呼びます。
+		/// @param tileSize タイルの大きさ
+		/// @param f 各要素に対して呼ぶ関数
+		/// @remark 近くの要素どうしをまとめて処理するため、幅の大きな Grid でもキャッシュ効率が落ちにくくなります。
+		/// @return *this
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type&>>* = nullptr>
+		Grid& each_tile(Size tileSize, Fty f);
+
+		/// @brief tileSize ごとのタイルに分けて、タイル単位の順で各要素に f(位置, 要素) を呼びます。
+		/// @param tileSize タイルの大きさ
+		/// @param f 各要素に対して呼ぶ関数
+		/// @return *this
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type>>* = nullptr>
+		const Grid& each_tile(Size tileSize, Fty f) const;
+
+		/// @brief 各要素について、その要素を中心とする近傍を f に渡し、結果を新しい Grid にして返します。
+		/// @param radius 近傍の半径。1 の場合 3x3
+		/// @param f 近傍 `const GridWindow<Type>&` を受け取り、新しい要素を返す関数
+		/// @remark セル・オートマトンやタイルの自動接続など、周囲の要素を参照する処理に使います。
+		/// @return 新しい Grid
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, const GridWindow<Type>&>>* = nullptr>
+		[[nodiscard]]
+		auto stencil_map(int32 radius, Fty f) const;
+
 		template <class U>
 		[[nodiscard]]
 		value_type fetch(size_type y, size_type x, U&& defaultValue) const;
@@ -386,6 +475,58 @@ namespace s3d
 		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Type>>* = nullptr>
 		auto map(Fty f) const;
 
+	# ifndef SIV3D_NO_CONCURRENT_API
+
+		template <class Fty, std::enable_if_t<std::is_invocable_r_v<bool, Fty, Type>>* = nullptr>
+		[[nodiscard]]
+		size_t parallel_count_if(Fty f) const;
+
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Type&>>* = nullptr>
+		Grid& parallel_each(Fty f);
+
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Type>>* = nullptr>
+		const Grid& parallel_each(Fty f) const;
+
+		/// @brief 行ごとに分けて並列に、各要素に f(位置, 要素) を呼びます。
+		/// @param f 各要素に対して呼ぶ関数
+		/// @return *this
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type&>>* = nullptr>
+		Grid& parallel_each_index(Fty f);
+
+		/// @brief 行ごとに分けて並列に、各要素に f(位置, 要素) を呼びます。
+		/// @param f 各要素に対して呼ぶ関数
+		/// @return *this
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type>>* = nullptr>
+		const Grid& parallel_each_index(Fty f) const;
+
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Type>>* = nullptr>
+		[[nodiscard]]
+		auto parallel_map(Fty f) const;
+
+		/// @brief tileSize ごとのタイルに分けて、タイル単位で並列に各要素に f(位置, 要素) を呼びます。
+		/// @param tileSize タイルの大きさ
+		/// @param f 各要素に対して呼ぶ関数
+		/// @return *this
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type&>>* = nullptr>
+		Grid& parallel_each_tile(Size tileSize, Fty f);
+
+		/// @brief tileSize ごとのタイルに分けて、タイル単位で並列に各要素に f(位置, 要素) を呼びます。
+		/// @param tileSize タイルの大きさ
+		/// @param f 各要素に対して呼ぶ関数
+		/// @return *this
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type>>* = nullptr>
+		const Grid& parallel_each_tile(Size tileSize, Fty f) const;
+
+		/// @brief `stencil_map()` を行ごとに分けて並列に行います。
+		/// @param radius 近傍の半径。1 の場合 3x3
+		/// @param f 近傍 `const GridWindow<Type>&` を受け取り、新しい要素を返す関数
+		/// @return 新しい Grid
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, const GridWindow<Type>&>>* = nullptr>
+		[[nodiscard]]
+		auto parallel_stencil_map(int32 radius, Fty f) const;
+
+	# endif
+
 		template <class Fty = decltype(Identity), std::enable_if_t<std::is_invocable_r_v<bool, Fty, Type>>* = nullptr>
 		[[nodiscard]]
 		bool none(Fty f = Identity) const;
@@ -620,6 +761,12 @@ namespace s3d
 		size_type m_width = 0;
 
 		size_type m_height = 0;
+
+		template <class Pointer, class Fty>
+		void eachInRect(Pointer data, size_t x0, size_t y0, size_t x1, size_t y1, Fty& f) const;
+
+		template <class Container, class Fty>
+		void stencilRows(int32 radius, size_t y0, size_t y1, Container& dst, Fty& f) const;
 	};
 
 	// deduction guide
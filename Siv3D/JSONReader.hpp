@@ -0,0 +1,266 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <string>
+# include <string_view>
+# include "Common.hpp"
+# include "String.hpp"
+# include "Optional.hpp"
+# include "Unicode.hpp"
+# include "UnicodeConverter.hpp"
+# include "IReader.hpp"
+# include "MemoryMappedFileView.hpp"
+# include "SIMD.hpp"
+
+namespace s3d
+{
+	/// @brief JSONReader が読み込んだ要素の種類を表す列挙体
+	enum class JSONEvent : uint8
+	{
+		/// @brief まだ何も読み込んでいない
+		None,
+
+		/// @brief オブジェクトの開始 `{`
+		BeginObject,
+
+		/// @brief オブジェクトの終了 `}`
+		EndObject,
+
+		/// @brief 配列の開始 `[`
+		BeginArray,
+
+		/// @brief 配列の終了 `]`
+		EndArray,
+
+		/// @brief オブジェクトのキー
+		Key,
+
+		/// @brief 文字列
+		String,
+
+		/// @brief 数値
+		Number,
+
+		/// @brief true または false
+		Bool,
+
+		/// @brief null
+		Null,
+
+		/// @brief データの終端
+		End,
+
+		/// @brief 不正なデータ
+		Error,
+	};
+
+	/// @brief JSON データを先頭から順に読み込み、要素を 1 つずつ報告するクラス
+	/// @remark `JSON` と異なり、木構造を作らずに読み込みます。使用するメモリは、データの大きさではなく、最も長い文字列の長さと入れ子の深さに比例します。
+	/// @remark ファイルはメモリマップトファイルとして開きます。Reader からは一定の大きさのバッファごとに読み込みます。
+	/// @remark ルートの値が複数ある場合（`JSONWriter` が書き出す JSON Lines 形式など）は、それらを順に読み込みます。ルートの値どうしの間には改行が必要です。
+	class JSONReader
+	{
+	public:
+
+		/// @brief Reader から一度に読み込む大きさ（バイト）
+		static constexpr size_t BufferSize = (64 * 1024);
+
+		SIV3D_NODISCARD_CXX20
+		JSONReader() = default;
+
+		/// @brief JSON ファイルを開きます。
+		/// @param path ファイルパス
+		SIV3D_NODISCARD_CXX20
+		explicit JSONReader(FilePathView path);
+
+		/// @brief Reader から JSON データを読み込みます。
+		/// @tparam Reader Reader の型
+		/// @param reader Reader
+		template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>* = nullptr>
+		SIV3D_NODISCARD_CXX20
+		explicit JSONReader(Reader&& reader);
+
+		/// @brief Reader から JSON データを読み込みます。
+		/// @param reader Reader
+		SIV3D_NODISCARD_CXX20
+		explicit JSONReader(std::unique_ptr<IReader>&& reader);
+
+		/// @brief JSON ファイルを開きます。
+		/// @param path ファイルパス
+		/// @return ファイルを開けた場合 true, それ以外の場合は false
+		bool open(FilePathView path);
+
+		/// @brief Reader から JSON データを読み込みます。
+		/// @tparam Reader Reader の型
+		/// @param reader Reader
+		/// @return Reader が使用可能な場合 true, それ以外の場合は false
+		template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>* = nullptr>
+		bool open(Reader&& reader);
+
+		/// @brief Reader から JSON データを読み込みます。
+		/// @param reader Reader
+		/// @return Reader が使用可能な場合 true, それ以外の場合は false
+		bool open(std::unique_ptr<IReader>&& reader);
+
+		void close();
+
+		[[nodiscard]]
+		bool isOpen() const noexcept;
+
+		[[nodiscard]]
+		explicit operator bool() const noexcept;
+
+		/// @brief 次の要素を読み込みます。
+		/// @return 読み込んだ要素の種類。データの終端では `JSONEvent::End`, 不正なデータでは `JSONEvent::Error`
+		JSONEvent next();
+
+		/// @brief 最後に読み込んだ要素の種類を返します。
+		/// @return 最後に読み込んだ要素の種類
+		[[nodiscard]]
+		JSONEvent event() const noexcept;
+
+		/// @brief 最後に読み込んだ要素が、値の開始（オブジェクトや配列の開始、または文字列・数値・bool・null）であるかを返します。
+		/// @return 値の開始である場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isValue() const noexcept;
+
+		/// @brief 現在の入れ子の深さを返します。
+		/// @return 開始したまま終了していないオブジェクトと配列の数
+		[[nodiscard]]
+		size_t depth() const noexcept;
+
+		/// @brief 最後に読み込んだキーまたは文字列を返します。
+		/// @return エスケープを戻した文字列（UTF-8）。数値の場合はその表記
+		/// @remark 次に `next()` を呼ぶまで有効です。
+		[[nodiscard]]
+		std::string_view getStringView() const noexcept;
+
+		/// @brief 最後に読み込んだキーまたは文字列を返します。
+		/// @return 文字列
+		[[nodiscard]]
+		String getString() const;
+
+		/// @brief 最後に読み込んだ bool の値を返します。
+		/// @return bool の値
+		[[nodiscard]]
+		bool getBool() const noexcept;
+
+		/// @brief 最後に読み込んだ数値を返します。
+		/// @return 数値
+		[[nodiscard]]
+		double getDouble() const noexcept;
+
+		/// @brief 最後に読み込んだ数値を整数として返します。
+		/// @return 整数。整数として表せない場合は none
+		[[nodiscard]]
+		Optional<int64> getInt64() const noexcept;
+
+		/// @brief 最後に読み込んだ値を読み飛ばします。
+		/// @remark オブジェクトまたは配列の開始を読み込んだ直後の場合、対応する終了までを読み飛ばします。それ以外の場合は何もしません。
+		/// @return 読み飛ばした後の要素の種類
+		JSONEvent skipValue();
+
+		/// @brief データの終端または不正なデータまで、要素を読み込むたびに関数を呼びます。
+		/// @tparam Fty 要素を受け取る関数の型
+		/// @param f `f(JSONEvent, JSONReader&)` の形で呼ばれる関数
+		/// @return データを最後まで正しく読み込めた場合 true, 不正なデータがあった場合は false
+		template <class Fty>
+		bool read(Fty f);
+
+		/// @brief 読み込み済みのデータの大きさを返します。
+		/// @return 先頭から数えた読み込み位置（バイト）
+		[[nodiscard]]
+		int64 offset() const noexcept;
+
+		/// @brief 不正なデータの内容を返します。
+		/// @return 不正なデータの内容。不正なデータが無い場合は空の文字列
+		[[nodiscard]]
+		StringView errorMessage() const noexcept;
+
+	private:
+
+		enum class Expect : uint8
+		{
+			Value,
+
+			ValueOrEnd,
+
+			Key,
+
+			KeyOrEnd,
+
+			Colon,
+
+			CommaOrEnd,
+
+			Done,
+		};
+
+		MemoryMappedFileView m_file;
+
+		std::unique_ptr<IReader> m_reader;
+
+		// Reader から読み込んだデータ
+		std::string m_buffer;
+
+		// バッファの先頭より前に読み込んだデータの大きさ
+		int64 m_consumed = 0;
+
+		const char* m_pos = nullptr;
+
+		const char* m_end = nullptr;
+
+		// バッファをまたぐ、またはエスケープを含む文字列と数値の表記
+		std::string m_scratch;
+
+		std::string_view m_value;
+
+		// 開始したオブジェクトと配列（'{' または '['）
+		std::string m_stack;
+
+		JSONEvent m_event = JSONEvent::None;
+
+		Expect m_expect = Expect::Value;
+
+		bool m_bool = false;
+
+		// 直前のルートの値の後に改行を読み飛ばしたか
+		bool m_newlineSkipped = false;
+
+		const char32* m_error = U"";
+
+		void reset(const char* data, size_t size);
+
+		bool refill();
+
+		bool ensure(size_t size);
+
+		bool skipWhitespace();
+
+		JSONEvent readValue(char c);
+
+		JSONEvent endContainer(char c);
+
+		bool readString();
+
+		bool readEscape();
+
+		bool readNumber();
+
+		bool readLiteral(std::string_view literal);
+
+		JSONEvent setError(const char32* message);
+	};
+}
+
+# include "detail/JSONReader.ipp"
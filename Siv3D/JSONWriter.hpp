@@ -0,0 +1,196 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <string>
+# include <string_view>
+# include "Common.hpp"
+# include "Concepts.hpp"
+# include "StringView.hpp"
+# include "UnicodeConverter.hpp"
+# include "Blob.hpp"
+# include "IWriter.hpp"
+
+namespace s3d
+{
+	/// @brief JSON データを先頭から順に書き出すクラス
+	/// @remark `JSON` と異なり、木構造を作らずに書き出します。書き出したデータは一定の大きさごとに Blob または Writer に追加されます。
+	/// @remark 改行やインデントを含まない形式で書き出します。ルートの値を複数書き出した場合は、改行で区切ります（JSON Lines 形式）。`JSONReader` はこれを順に読み込めます。
+	/// @remark 開始していない種類の終了、オブジェクトの外のキー、キーの無いオブジェクトの値は書き出しません（デバッグビルドではアサートします）。
+	/// @remark Writer への書き込みに失敗した場合、以降のデータは書き出さず、`hasError()` が true を返します。
+	class JSONWriter
+	{
+	public:
+
+		/// @brief 書き出し先に一度に追加する大きさ（バイト）
+		static constexpr size_t BufferSize = (64 * 1024);
+
+		/// @brief Blob の末尾に JSON データを追加する JSONWriter を作成します。
+		/// @param blob 書き出し先の Blob
+		/// @remark blob は JSONWriter よりも長く存在する必要があります。
+		SIV3D_NODISCARD_CXX20
+		explicit JSONWriter(Blob& blob);
+
+		/// @brief Writer に JSON データを書き出す JSONWriter を作成します。
+		/// @param writer 書き出し先の Writer
+		/// @remark writer は JSONWriter よりも長く存在する必要があります。
+		SIV3D_NODISCARD_CXX20
+		explicit JSONWriter(IWriter& writer);
+
+		JSONWriter(const JSONWriter&) = delete;
+
+		JSONWriter& operator =(const JSONWriter&) = delete;
+
+		/// @brief デストラクタ
+		/// @remark 書き出し先に追加していないデータを追加します。
+		~JSONWriter();
+
+		/// @brief オブジェクトを開始します。
+		/// @return *this
+		JSONWriter& startObject();
+
+		/// @brief オブジェクトを終了します。
+		/// @return *this
+		/// @remark 最後に開始したのがオブジェクトでない場合や、値の無いキーの直後の場合は何も書き出しません。
+		JSONWriter& endObject();
+
+		/// @brief 配列を開始します。
+		/// @return *this
+		JSONWriter& startArray();
+
+		/// @brief 配列を終了します。
+		/// @return *this
+		/// @remark 最後に開始したのが配列でない場合は何も書き出しません。
+		JSONWriter& endArray();
+
+		/// @brief オブジェクトのキーを書き出します。次に書き出す値がこのキーの値になります。
+		/// @param name キー（UTF-8）
+		/// @return *this
+		JSONWriter& key(std::string_view name);
+
+		/// @brief オブジェクトのキーを書き出します。次に書き出す値がこのキーの値になります。
+		/// @param name キー
+		/// @return *this
+		JSONWriter& key(StringView name);
+
+		/// @brief オブジェクトのキーを書き出します。次に書き出す値がこのキーの値になります。
+		/// @param name キー（UTF-8）
+		/// @return *this
+		JSONWriter& key(const char* name);
+
+		/// @brief オブジェクトのキーを書き出します。次に書き出す値がこのキーの値になります。
+		/// @param name キー
+		/// @return *this
+		JSONWriter& key(const char32* name);
+
+		/// @brief null を書き出します。
+		/// @return *this
+		JSONWriter& write(std::nullptr_t);
+
+		/// @brief bool の値を書き出します。
+		/// @param value 値
+		/// @return *this
+		JSONWriter& write(bool value);
+
+		/// @brief 整数を書き出します。
+		/// @tparam Int 整数の型
+		/// @param value 値
+		/// @return *this
+		SIV3D_CONCEPT_INTEGRAL
+		JSONWriter& write(Int value);
+
+		/// @brief 浮動小数点数を書き出します。
+		/// @tparam Float 浮動小数点数の型
+		/// @param value 値
+		/// @return *this
+		/// @remark 値を復元できる最短の表記で書き出します。NaN と無限大は null として書き出します。
+		SIV3D_CONCEPT_FLOATING_POINT
+		JSONWriter& write(Float value);
+
+		/// @brief 文字列を書き出します。
+		/// @param value 文字列（UTF-8）
+		/// @return *this
+		JSONWriter& write(std::string_view value);
+
+		/// @brief 文字列を書き出します。
+		/// @param value 文字列
+		/// @return *this
+		JSONWriter& write(StringView value);
+
+		/// @brief 文字列を書き出します。
+		/// @param value 文字列（UTF-8）
+		/// @return *this
+		JSONWriter& write(const char* value);
+
+		/// @brief 文字列を書き出します。
+		/// @param value 文字列
+		/// @return *this
+		JSONWriter& write(const char32* value);
+
+		/// @brief オブジェクトのキーと値を書き出します。
+		/// @tparam Name キーの型
+		/// @tparam Type 値の型
+		/// @param name キー
+		/// @param value 値
+		/// @return *this
+		template <class Name, class Type>
+		JSONWriter& write(const Name& name, const Type& value);
+
+		/// @brief 書き出し先に追加していないデータを追加します。
+		/// @return これまでの書き込みがすべて成功した場合 true, それ以外の場合は false
+		bool flush();
+
+		/// @brief 書き出し先への書き込みに失敗したかを返します。
+		/// @return Writer への書き込みに一度でも失敗した場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool hasError() const noexcept;
+
+		/// @brief 現在の入れ子の深さを返します。
+		/// @return 開始したまま終了していないオブジェクトと配列の数
+		[[nodiscard]]
+		size_t depth() const noexcept;
+
+	private:
+
+		Blob* m_blob = nullptr;
+
+		IWriter* m_writer = nullptr;
+
+		std::string m_buffer;
+
+		// 開始したオブジェクトと配列（'{' または '['）
+		std::string m_stack;
+
+		bool m_hasValue = false;
+
+		bool m_afterKey = false;
+
+		bool m_hasError = false;
+
+		[[nodiscard]]
+		bool beginKey();
+
+		[[nodiscard]]
+		bool beginValue();
+
+		JSONWriter& endContainer(char open);
+
+		void endValue();
+
+		void appendString(std::string_view s);
+
+		void appendString(StringView s);
+
+		void appendEscaped(char c);
+	};
+}
+
+# include "detail/JSONWriter.ipp"
@@ -10,11 +10,18 @@
 //-----------------------------------------------
 
 # pragma once
+# include <cmath>
+# include <memory>
+# include <limits>
 # include "Common.hpp"
 # include "Array.hpp"
 # include "YesNo.hpp"
 # include "PredefinedYesNo.hpp"
 # include <ThirdParty/nanoflann/nanoflann.hpp>
+# ifndef SIV3D_NO_CONCURRENT_API
+#	include <span>
+#	include "ThreadPool.hpp"
+# endif
 
 namespace s3d
 {
@@ -79,9 +86,18 @@ namespace s3d
 		/// @param dataset データセット
 		explicit KDTree(const dataset_type& dataset);
 
+		/// @brief `parallel_knnSearch()` で、見つからなかった要素の位置に格納される値
+		static constexpr size_t InvalidIndex = std::numeric_limits<size_t>::max();
+
 		/// @brief ツリーを再構築します。
 		void rebuildIndex();
 
+		/// @brief ツリーの構造を変えずに、移動した要素に合わせて各ノードの範囲を更新します。
+		/// @return 範囲の更新だけで済んだ場合 true, ツリーを再構築した場合は false
+		/// @remark 分割面をまたいだ要素は、ノードの要素数を保ったまま左右の子の間で入れ替えます。要素の数が変わった場合は `rebuildIndex()` と同じ再構築を行います。
+		/// @remark 1 フレームの移動が要素どうしの平均間隔より十分小さい場合は、再構築よりも高速です。移動が大きい場合や更新を繰り返して木の偏りが大きくなった場合は `rebuildIndex()` を使ってください。
+		bool refitIndex();
+
 		/// @brief kd-tree を消去し、メモリから解放します。
 		void release();
 
@@ -125,6 +141,26 @@ namespace s3d
 		/// @param sortByDistance 結果を中心座標から近い順にソートする場合 `SortByDistance::Yes`, それ以外の場合は `SortByDistance::No`
 		void radiusSearch(Array<size_t>& results, const point_type& point, element_type radius, const SortByDistance sortByDistance = SortByDistance::No) const;
 
+	# ifndef SIV3D_NO_CONCURRENT_API
+
+		/// @brief 複数の座標について、それぞれ最も近い k 個の要素をスレッドプールで並列に検索します。
+		/// @param results 結果を格納する配列。queries[i] の結果は results[i * k] から近い順に k 個格納されます。
+		/// @param k 検索する個数
+		/// @param queries 中心座標の配列
+		/// @remark 見つかった要素が k 個未満の場合、残りには `InvalidIndex` が格納されます。
+		/// @remark results の容量を再利用するため、毎フレーム同じ配列を渡すと検索ごとのメモリ確保が発生しません。
+		void parallel_knnSearch(Array<size_t>& results, size_t k, std::span<const point_type> queries) const;
+
+		/// @brief 複数の座標について、それぞれ最も近い k 個の要素をスレッドプールで並列に検索します。
+		/// @param results 結果を格納する配列。queries[i] の結果は results[i * k] から近い順に k 個格納されます。
+		/// @param distanceSqResults それぞれの要素について、中心からの距離の二乗を results と同じ位置に格納する配列
+		/// @param k 検索する個数
+		/// @param queries 中心座標の配列
+		/// @remark 見つかった要素が k 個未満の場合、残りには `InvalidIndex` と、要素の型の最大値が格納されます。
+		void parallel_knnSearch(Array<size_t>& results, Array<element_type>& distanceSqResults, size_t k, std::span<const point_type> queries) const;
+
+	# endif
+
 	private:
 
 		adapter_type m_adapter;
@@ -132,6 +168,111 @@ namespace s3d
 		nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<element_type, adapter_type, double>, adapter_type, Dimensions, size_t> m_index;
 	};
 
+	/// @brief 要素の追加と削除ができる kd-tree
+	/// @tparam DatasetAdapter kd-tree 用のアダプタ型
+	/// @remark 大きさが 2 の累乗の静的な kd-tree の集まりで要素を管理し、要素の追加はならし O(log^2 n) で行います（nanoflann の動的インデックス）。
+	/// @remark 要素はデータセットの末尾に追加し、`addPoints()` で索引に加えます。削除した要素もデータセットからは取り除かず、インデックスを変えないでください。
+	template <class DatasetAdapter>
+	class DynamicKDTree
+	{
+	public:
+
+		using adapter_type	= detail::KDAdapter<DatasetAdapter>;
+
+		using point_type	= typename adapter_type::point_type;
+
+		using element_type	= typename adapter_type::element_type;
+
+		using dataset_type	= typename adapter_type::dataset_type;
+
+		static constexpr int32 Dimensions = adapter_type::Dimensions;
+
+		/// @brief `parallel_knnSearch()` で、見つからなかった要素の位置に格納される値
+		static constexpr size_t InvalidIndex = std::numeric_limits<size_t>::max();
+
+		/// @brief デフォルトコンストラクタ
+		SIV3D_NODISCARD_CXX20
+		DynamicKDTree() = default;
+
+		/// @brief データセットのすべての要素を索引に加えた kd-tree を構築します。
+		/// @param dataset データセット
+		SIV3D_NODISCARD_CXX20
+		explicit DynamicKDTree(const dataset_type& dataset);
+
+		/// @brief 前回の呼び出し以降にデータセットの末尾に追加された要素を、索引に加えます。
+		void addPoints();
+
+		/// @brief 要素を索引から取り除きます。
+		/// @param index 要素のインデックス
+		void removePoint(size_t index);
+
+		/// @brief 索引に含まれている要素の数を返します。
+		/// @return 索引に含まれている要素の数
+		[[nodiscard]]
+		size_t size() const noexcept;
+
+		/// @brief 指定した座標から最も近い k 個の要素を検索して返します。
+		/// @param k 検索する個数
+		/// @param point 座標
+		/// @return 見つかった要素一覧
+		[[nodiscard]]
+		Array<size_t> knnSearch(size_t k, const point_type& point) const;
+
+		/// @brief 指定した座標から最も近い k 個の要素を検索して取得します。
+		/// @param results 結果を格納する配列
+		/// @param k 検索する個数
+		/// @param point 中心座標
+		void knnSearch(Array<size_t>& results, size_t k, const point_type& point) const;
+
+		/// @brief 指定した座標から指定した半径以内にある要素一覧を検索して取得します。
+		/// @param results 結果を格納する配列
+		/// @param point 中心座標
+		/// @param radius 半径
+		/// @param sortByDistance 結果を中心座標から近い順にソートする場合 `SortByDistance::Yes`, それ以外の場合は `SortByDistance::No`
+		void radiusSearch(Array<size_t>& results, const point_type& point, element_type radius, SortByDistance sortByDistance = SortByDistance::No) const;
+
+	# ifndef SIV3D_NO_CONCURRENT_API
+
+		/// @brief 複数の座標について、それぞれ最も近い k 個の要素をスレッドプールで並列に検索します。
+		/// @param results 結果を格納する配列。queries[i] の結果は results[i * k] から近い順に k 個格納されます。
+		/// @param k 検索する個数
+		/// @param queries 中心座標の配列
+		/// @remark 見つかった要素が k 個未満の場合、残りには `InvalidIndex` が格納されます。
+		/// @remark results の容量を再利用するため、毎フレーム同じ配列を渡すと検索ごとのメモリ確保が発生しません。
+		void parallel_knnSearch(Array<size_t>& results, size_t k, std::span<const point_type> queries) const;
+
+		/// @brief 複数の座標について、それぞれ最も近い k 個の要素をスレッドプールで並列に検索します。
+		/// @param results 結果を格納する配列。queries[i] の結果は results[i * k] から近い順に k 個格納されます。
+		/// @param distanceSqResults それぞれの要素について、中心からの距離の二乗を results と同じ位置に格納する配列
+		/// @param k 検索する個数
+		/// @param queries 中心座標の配列
+		/// @remark 見つかった要素が k 個未満の場合、残りには `InvalidIndex` と、要素の型の最大値が格納されます。
+		void parallel_knnSearch(Array<size_t>& results, Array<element_type>& distanceSqResults, size_t k, std::span<const point_type> queries) const;
+
+	# endif
+
+	private:
+
+		using index_type = nanoflann::KDTreeSingleIndexDynamicAdaptor<nanoflann::L2_Simple_Adaptor<element_type, adapter_type, double>, adapter_type, Dimensions, size_t>;
+
+		// nanoflann の動的インデックスはアダプタへの参照を持ち、移動できないため、まとめてヒープに置く
+		struct Index
+		{
+			adapter_type adapter;
+
+			index_type index;
+
+			explicit Index(const dataset_type& dataset);
+		};
+
+		std::unique_ptr<Index> m_index;
+
+		// 索引に加えた要素が削除済みであるか
+		Array<bool> m_removed;
+
+		size_t m_removedCount = 0;
+	};
+
 	template <class Dataset, class PointType, class ElementType = typename PointType::value_type, int32 Dim = PointType::Dimension>
 	struct KDTreeAdapter
 	{
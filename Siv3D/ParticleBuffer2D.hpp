@@ -0,0 +1,168 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <array>
+# include <span>
+# include "Common.hpp"
+# include "Array.hpp"
+# include "PointVector.hpp"
+# include "Emission2D.hpp"
+# include "SIMD.hpp"
+
+namespace s3d
+{
+	/// @brief パーティクルの経過時間の割合 [0, 1] に対する値をあらかじめ標本化したカーブ
+	/// @tparam Type 値の型（float または Float4）
+	/// @remark パーティクルごとに `std::function` を呼ぶかわりに、標本の線形補間で値を求めます。
+	template <class Type>
+	class LifeTimeCurve
+	{
+	public:
+
+		/// @brief デフォルトコンストラクタ
+		/// @remark 空のカーブは常にすべての成分が 1 の値を返します。
+		SIV3D_NODISCARD_CXX20
+		LifeTimeCurve() = default;
+
+		/// @brief 標本からカーブを作成します。
+		/// @param samples 経過時間の割合 0 から 1 までを等間隔に標本化した値
+		SIV3D_NODISCARD_CXX20
+		explicit LifeTimeCurve(Array<Type> samples);
+
+		/// @brief 経過時間の割合に対する値を返します。
+		/// @param t 経過時間の割合。0 が出現時、1 が消滅時
+		/// @return 値
+		[[nodiscard]]
+		Type operator ()(float t) const noexcept;
+
+		/// @brief カーブが空であるかを返します。
+		/// @return カーブが空である場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isEmpty() const noexcept;
+
+		/// @brief 関数を標本化してカーブを作成します。
+		/// @tparam Fty 経過時間の割合を受け取り、値を返す関数の型
+		/// @param resolution 標本の数
+		/// @param f 経過時間の割合を受け取り、値を返す関数
+		/// @return 作成したカーブ
+		template <class Fty, std::enable_if_t<std::is_invocable_r_v<Type, Fty, float>>* = nullptr>
+		[[nodiscard]]
+		static LifeTimeCurve Generate(size_t resolution, Fty f);
+
+	private:
+
+		Array<Type> m_samples;
+	};
+
+	/// @brief Structure of Arrays 形式のパーティクル配列
+	/// @remark Particle2D の配列と異なり、位置・速度・回転・寿命をそれぞれ連続したメモリに置き、SIMD でまとめて更新します。
+	/// @remark 寿命が尽きたパーティクルは `update()` の中で詰めて取り除かれます。残ったパーティクルの順序は保たれます。
+	/// @remark 大きさと色は、出現時の値に `LifeTimeCurve` の値を掛けたものになります。
+	class ParticleBuffer2D
+	{
+	public:
+
+		SIV3D_NODISCARD_CXX20
+		ParticleBuffer2D() = default;
+
+		/// @brief パーティクルを追加します。
+		/// @param emission 出現位置と初速
+		/// @param startColor 出現時の色
+		/// @param startSize 出現時の大きさ
+		/// @param rotation 回転角度（ラジアン）
+		/// @param angularVelocity 角速度（ラジアン / 秒）
+		/// @param lifeTime 寿命（秒）
+		void add(const Emission2D& emission, const Float4& startColor, float startSize, float rotation, float angularVelocity, float lifeTime);
+
+		/// @brief 同じパラメータのパーティクルをまとめて追加します。
+		/// @param emissions 各パーティクルの出現位置と初速
+		/// @param startColor 出現時の色
+		/// @param startSize 出現時の大きさ
+		/// @param rotation 回転角度（ラジアン）
+		/// @param angularVelocity 角速度（ラジアン / 秒）
+		/// @param lifeTime 寿命（秒）
+		/// @remark `EmitN()` と組み合わせると、バーストを 1 回の配列の拡張で追加できます。
+		void append(std::span<const Emission2D> emissions, const Float4& startColor, float startSize, float rotation, float angularVelocity, float lifeTime);
+
+		/// @brief すべてのパーティクルを経過時間分だけ進め、寿命が尽きたパーティクルを取り除きます。
+		/// @param deltaTime 経過時間（秒）
+		/// @param deltaVelocity この更新で速度に加える値（力 * 経過時間）
+		void update(float deltaTime, const Float2& deltaVelocity) noexcept;
+
+		void reserve(size_t n);
+
+		void clear() noexcept;
+
+		[[nodiscard]]
+		size_t size() const noexcept;
+
+		[[nodiscard]]
+		bool isEmpty() const noexcept;
+
+		void setSizeOverLifeTime(const LifeTimeCurve<float>& curve);
+
+		void setColorOverLifeTime(const LifeTimeCurve<Float4>& curve);
+
+		[[nodiscard]]
+		Float2 position(size_t i) const noexcept;
+
+		[[nodiscard]]
+		Float2 velocity(size_t i) const noexcept;
+
+		[[nodiscard]]
+		float rotation(size_t i) const noexcept;
+
+		/// @brief パーティクルの経過時間の割合を返します。
+		/// @param i パーティクルのインデックス
+		/// @return 経過時間の割合。0 が出現時、1 が消滅時
+		[[nodiscard]]
+		float normalizedAge(size_t i) const noexcept;
+
+		/// @brief 大きさのカーブを適用した、現在の大きさを返します。
+		[[nodiscard]]
+		float currentSize(size_t i) const noexcept;
+
+		/// @brief 色のカーブを適用した、現在の色を返します。
+		[[nodiscard]]
+		Float4 currentColor(size_t i) const noexcept;
+
+	private:
+
+		Array<float> m_positionX;
+
+		Array<float> m_positionY;
+
+		Array<float> m_velocityX;
+
+		Array<float> m_velocityY;
+
+		Array<float> m_rotation;
+
+		Array<float> m_angularVelocity;
+
+		Array<float> m_startLifeTime;
+
+		Array<float> m_remainingLifeTime;
+
+		Array<float> m_startSize;
+
+		Array<Float4> m_startColor;
+
+		LifeTimeCurve<float> m_sizeOverLifeTime;
+
+		LifeTimeCurve<Float4> m_colorOverLifeTime;
+
+		void resize(size_t n);
+	};
+}
+
+# include "detail/ParticleBuffer2D.ipp"
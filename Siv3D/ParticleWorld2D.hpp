@@ -0,0 +1,174 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <memory>
+# include <tuple>
+# include "Common.hpp"
+# include "Error.hpp"
+# include "Array.hpp"
+# include "PointVector.hpp"
+# include "PRNG.hpp"
+# include "Math.hpp"
+# include "FastMath.hpp"
+# include "Texture.hpp"
+# include "Buffer2D.hpp"
+# include "ScopedRenderStates2D.hpp"
+# include "IEmitter2D.hpp"
+# include "ParticleSystem2DParameters.hpp"
+# include "BatchEmitter2D.hpp"
+# include "ParticleBuffer2D.hpp"
+# ifndef SIV3D_NO_CONCURRENT_API
+#	include "ThreadPool.hpp"
+# endif
+
+namespace s3d
+{
+	/// @brief 多数のパーティクルエフェクトをまとめて更新・描画するクラス
+	/// @remark 各エフェクトは ParticleBuffer2D にパーティクルを持ち、`update()` ではエフェクトごとに `ThreadPool::Global()` のワーカースレッドで並列に更新されます。
+	/// @remark 各エフェクトはワールドのシード値とエフェクト ID から作った独立した乱数生成器を持つため、スレッドの数や実行順序によらず同じ結果になります。
+	/// @remark `draw()` はエフェクトをブレンドステートとテクスチャで並べ替え、同じ組み合わせのパーティクルを 1 回の描画にまとめます。
+	class ParticleWorld2D
+	{
+	public:
+
+		using EffectID = uint32;
+
+		/// @brief 1 回の描画で送るパーティクルの最大数
+		static constexpr size_t MaxQuadsPerBatch = (65536 / 4);
+
+		/// @brief 大きさと色のカーブを標本化するときの標本の数
+		static constexpr size_t CurveResolution = 32;
+
+		/// @brief パーティクルワールドを作成します。
+		/// @param seed 各エフェクトの乱数生成器の元になるシード値
+		SIV3D_NODISCARD_CXX20
+		explicit ParticleWorld2D(uint64 seed = 0);
+
+		/// @brief エフェクトを追加します。
+		/// @tparam Emitter エミッタの型
+		/// @param position エミッタの位置
+		/// @param emitter エミッタ
+		/// @param parameters パーティクルのパラメータ
+		/// @param texture パーティクルのテクスチャ。空の場合は正方形を描きます。
+		/// @param force パーティクルに働く力
+		/// @return エフェクトの ID
+		/// @remark `parameters.sizeOverLifeTimeFunc` と `parameters.colorOverLifeTimeFunc` は追加時に標本化され、出現時の値に掛ける係数として使われます。
+		/// @remark 組み込みの Circle / Arc / Rect エミッタと IBatchEmitter2D を継承したエミッタ以外は `emit()` を使うため、乱数の系列がエフェクトごとに固定されません。
+		template <class Emitter, std::enable_if_t<std::is_base_of_v<IEmitter2D, Emitter>>* = nullptr>
+		EffectID add(const Vec2& position, const Emitter& emitter, const ParticleSystem2DParameters& parameters, const Texture& texture = Texture{}, const Vec2& force = Vec2{ 0, 0 });
+
+		/// @brief エフェクトを追加します。
+		/// @param position エミッタの位置
+		/// @param emitter エミッタ
+		/// @param parameters パーティクルのパラメータ
+		/// @param texture パーティクルのテクスチャ。空の場合は正方形を描きます。
+		/// @param force パーティクルに働く力
+		/// @return エフェクトの ID
+		EffectID add(const Vec2& position, std::unique_ptr<IEmitter2D>&& emitter, const ParticleSystem2DParameters& parameters, const Texture& texture = Texture{}, const Vec2& force = Vec2{ 0, 0 });
+
+		/// @brief エフェクトを削除します。
+		/// @param id エフェクトの ID
+		/// @remark 削除したエフェクトの ID は、後で追加されるエフェクトに再利用されます。
+		void remove(EffectID id);
+
+		/// @brief すべてのエフェクトを削除します。
+		void clear();
+
+		/// @brief エフェクトが存在するかを返します。
+		/// @param id エフェクトの ID
+		/// @return エフェクトが存在する場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool contains(EffectID id) const noexcept;
+
+		/// @brief エミッタの位置を設定します。
+		void setPosition(EffectID id, const Vec2& position);
+
+		/// @brief パーティクルに働く力を設定します。
+		void setForce(EffectID id, const Vec2& force);
+
+		/// @brief `rate` に従ってパーティクルを出し続けるかを設定します。
+		/// @remark 出さない間も、すでに出ているパーティクルは更新されます。
+		void setEmitting(EffectID id, bool emitting);
+
+		/// @brief 次の `update()` で、パーティクルを追加で出します。
+		/// @param id エフェクトの ID
+		/// @param count 出すパーティクルの数
+		void burst(EffectID id, size_t count);
+
+		/// @brief すべてのエフェクトを経過時間分だけ進めます。
+		/// @param deltaTime 経過時間（秒）
+		void update(double deltaTime);
+
+		/// @brief すべてのエフェクトのパーティクルを描画します。
+		void draw() const;
+
+		/// @brief エフェクトの数を返します。
+		[[nodiscard]]
+		size_t num_effects() const noexcept;
+
+		/// @brief すべてのエフェクトのパーティクルの数の合計を返します。
+		[[nodiscard]]
+		size_t num_particles() const noexcept;
+
+	private:
+
+		struct Effect
+		{
+			Vec2 position{ 0, 0 };
+
+			Vec2 force{ 0, 0 };
+
+			std::unique_ptr<IEmitter2D> emitter;
+
+			ParticleSystem2DParameters parameters;
+
+			Texture texture;
+
+			ParticleBuffer2D particles;
+
+			SmallRNG rng;
+
+			double emissionAccumulator = 0.0;
+
+			size_t pendingBurst = 0;
+
+			bool emitting = true;
+
+			Array<Emission2D> emissions;
+		};
+
+		uint64 m_seed = 0;
+
+		Array<std::unique_ptr<Effect>> m_effects;
+
+		Array<EffectID> m_freeIDs;
+
+		mutable Array<EffectID> m_drawOrder;
+
+		mutable Array<size_t> m_drawOffsets;
+
+		mutable Array<Vertex2D> m_vertices;
+
+		mutable Buffer2D m_buffer;
+
+		[[nodiscard]]
+		Effect& get(EffectID id);
+
+		static void UpdateEffect(Effect& effect, float deltaTime);
+
+		static void WriteQuads(const Effect& effect, Vertex2D* pVertex) noexcept;
+
+		void drawBatch(const Texture& texture, size_t firstQuad, size_t numQuads) const;
+	};
+}
+
+# include "detail/ParticleWorld2D.ipp"
@@ -14,8 +14,10 @@
 # include "Common.hpp"
 # include "Concepts.hpp"
 # include "PointVector.hpp"
+# include "Grid.hpp"
 # include "Random.hpp"
 # include "Noise.hpp"
+# include "SIMD.hpp"
 
 namespace s3d
 {
@@ -141,6 +143,29 @@ namespace s3d
 		value_type normalizedOctave3D0_1(Vector3D<value_type> xyz, int32 octaves, value_type persistence = value_type(0.5)) const noexcept;
 
 
+		/// @brief 格子状に並んだ点の 2D ノイズをまとめて計算して、grid に格納します。
+		/// @param grid 結果を格納する Grid. 大きさは変更されません。
+		/// @param origin `grid[0][0]` に対応する座標
+		/// @param step 隣り合う格子点の座標の差
+		/// @param octaves オクターブ数
+		/// @param persistence 持続度
+		/// @remark `grid[y][x]` には `octave2D(origin.x + x * step, origin.y + y * step, octaves, persistence)` と同じ値が格納されます。
+		/// @remark 同じ行の隣り合う点を SIMD でまとめて計算し、同じセルに属する点では順列表の参照結果を使い回します。
+		void generate2D(Grid<value_type>& grid, Vector2D<value_type> origin, value_type step, int32 octaves = 1, value_type persistence = value_type(0.5)) const;
+
+	# ifndef SIV3D_NO_CONCURRENT_API
+
+		/// @brief 格子状に並んだ点の 2D ノイズを、行ごとにスレッドプールで並列に計算して、grid に格納します。
+		/// @param grid 結果を格納する Grid. 大きさは変更されません。
+		/// @param origin `grid[0][0]` に対応する座標
+		/// @param step 隣り合う格子点の座標の差
+		/// @param octaves オクターブ数
+		/// @param persistence 持続度
+		/// @remark 結果は `generate2D()` と同じです。
+		void parallel_generate2D(Grid<value_type>& grid, Vector2D<value_type> origin, value_type step, int32 octaves = 1, value_type persistence = value_type(0.5)) const;
+
+	# endif
+
 		[[nodiscard]]
 		constexpr const state_type& serialize() const noexcept;
 
@@ -155,6 +180,8 @@ namespace s3d
 		static constexpr Float Lerp(Float a, Float b, Float t) noexcept;
 
 		static constexpr Float Grad(uint8 hash, Float x, Float y, Float z) noexcept;
+
+		void generateRows(Grid<value_type>& grid, Vector2D<value_type> origin, value_type step, int32 octaves, value_type persistence, size_t firstRow, size_t lastRow) const;
 	};
 
 	using PerlinNoiseF	= BasicPerlinNoise<float>;
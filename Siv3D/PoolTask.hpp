@@ -0,0 +1,123 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# ifndef SIV3D_NO_CONCURRENT_API
+
+# include <chrono>
+# include <condition_variable>
+# include <exception>
+# include <functional>
+# include <memory>
+# include <mutex>
+# include <optional>
+# include <type_traits>
+# include <vector>
+# include "Common.hpp"
+# include "Array.hpp"
+# include "ThreadPool.hpp"
+
+namespace s3d
+{
+	namespace detail
+	{
+		template <class Type>
+		struct PoolTaskState;
+	}
+
+	/// @brief `ThreadPool::Global()` で実行される非同期処理のタスク
+	/// @tparam Type タスクの結果の型
+	/// @remark `AsyncTask` と異なり、タスクごとにスレッドを作成せず、`then()` で完了後に続けて実行する処理を登録できます。
+	template <class Type>
+	class PoolTask
+	{
+	public:
+
+		using value_type = Type;
+
+		/// @brief デフォルトコンストラクタ
+		/// @remark 何もしません
+		SIV3D_NODISCARD_CXX20
+		PoolTask() = default;
+
+		SIV3D_NODISCARD_CXX20
+		explicit PoolTask(std::shared_ptr<detail::PoolTaskState<Type>> state) noexcept;
+
+		PoolTask(PoolTask&&) noexcept = default;
+
+		PoolTask& operator =(PoolTask&&) noexcept = default;
+
+		PoolTask(const PoolTask&) = delete;
+
+		PoolTask& operator =(const PoolTask&) = delete;
+
+		/// @brief タスクを持っているかを返します。
+		/// @remark `get()` や `then()` を呼ぶと、タスクを持たない状態に戻ります。
+		/// @return タスクを持っている場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isValid() const noexcept;
+
+		/// @brief タスクが完了していて、結果をすぐに返せる状態であるかを返します。
+		/// @return タスクが完了している場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isReady() const;
+
+		/// @brief タスクの完了を待ちます。
+		/// @remark 待っている間、スレッドプールの未実行のタスクを代わりに実行します。
+		void wait() const;
+
+		/// @brief タスクの結果を返します。
+		/// @remark タスクが完了していない場合は、完了まで待機します。タスクが例外を投げていた場合は、その例外を再送出します。
+		/// @return タスクの結果
+		Type get();
+
+		/// @brief タスクの完了後に、その結果を受け取って実行されるタスクを作成します。
+		/// @tparam Fty 続けて実行する関数の型
+		/// @param f 続けて実行する関数。`Type` が void の場合は引数なし
+		/// @remark このタスクはタスクを持たない状態になります。
+		/// @remark このタスクが例外を投げていた場合、f は呼ばれず、作成されたタスクが同じ例外を持ちます。
+		/// @return 作成されたタスク
+		template <class Fty>
+		[[nodiscard]]
+		auto then(Fty&& f);
+
+	private:
+
+		template <class T>
+		friend auto WhenAll(Array<PoolTask<T>> tasks);
+
+		std::shared_ptr<detail::PoolTaskState<Type>> m_state;
+	};
+
+	/// @brief `ThreadPool::Global()` で実行されるタスクを作成します。
+	/// @tparam Fty タスクで実行する関数の型
+	/// @tparam ...Args タスクで実行する関数の引数の型
+	/// @param f タスクで実行する関数
+	/// @param ...args タスクで実行する関数の引数
+	/// @return 作成されたタスク
+	template <class Fty, class... Args, std::enable_if_t<std::is_invocable_v<std::decay_t<Fty>, std::decay_t<Args>...>>* = nullptr>
+	[[nodiscard]]
+	auto PoolAsync(Fty&& f, Args&&... args);
+
+	/// @brief すべてのタスクが完了したときに完了するタスクを作成します。
+	/// @tparam Type タスクの結果の型
+	/// @param tasks タスクの一覧。すべて `isValid()` である必要があります。
+	/// @remark tasks のタスクはタスクを持たない状態になります。
+	/// @remark いずれかのタスクが例外を投げていた場合、作成されたタスクは最初に見つかった例外を持ちます。
+	/// @return 各タスクの結果を順に格納した配列を結果とするタスク。`Type` が void の場合は `PoolTask<void>`
+	template <class Type>
+	[[nodiscard]]
+	auto WhenAll(Array<PoolTask<Type>> tasks);
+}
+
+# include "detail/PoolTask.ipp"
+
+# endif // SIV3D_NO_CONCURRENT_API
@@ -0,0 +1,175 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <algorithm>
+# include <atomic>
+# include <chrono>
+# include <cstring>
+# include <memory>
+# include <mutex>
+# include "Common.hpp"
+# include "Array.hpp"
+# include "TraceRecorder.hpp"
+
+namespace s3d
+{
+	/// @brief 常時有効にしておける軽量なスコープ単位の時間計測
+	/// @remark 計測するスコープには `SIV3D_PROFILE_SCOPE("name")` を記述します。
+	/// @remark スコープ名はその場所で最初に実行されたときに一度だけ登録され、以降は文字列の比較やハッシュ計算を行いません。
+	/// @remark 計測結果はスレッドごとのリングバッファにロックなしで書き込まれます。
+	/// @remark 終了したスレッドのバッファは計測結果を残したまま、次に計測を始めたスレッドが再利用します。
+	class ScopeProfiler
+	{
+	public:
+
+		using ScopeID = uint32;
+
+		/// @brief 登録できるスコープ名の最大数
+		static constexpr size_t MaxScopes = 64;
+
+		/// @brief スコープとスレッドごとに保持する直近の計測数
+		static constexpr size_t BufferSize = 256;
+
+		/// @brief スコープごとの統計
+		struct Stat
+		{
+			/// @brief スコープ名
+			const char* name = nullptr;
+
+			/// @brief 集計に使われた計測数
+			size_t count = 0;
+
+			/// @brief 中央値（ナノ秒）
+			uint64 p50NS = 0;
+
+			/// @brief 95 パーセンタイル（ナノ秒）
+			uint64 p95NS = 0;
+
+			/// @brief 99 パーセンタイル（ナノ秒）
+			uint64 p99NS = 0;
+
+			/// @brief 最大値（ナノ秒）
+			uint64 maxNS = 0;
+		};
+
+		/// @brief スコープ名を登録して ID を返します。
+		/// @param name スコープ名。プログラムの終了まで有効な文字列である必要があります。
+		/// @return スコープの ID。同じ名前には同じ ID が返されます。
+		[[nodiscard]]
+		static ScopeID Register(const char* name);
+
+		/// @brief 計測結果を記録します。
+		/// @param id スコープの ID
+		/// @param nanoseconds 経過時間（ナノ秒）
+		static void Record(ScopeID id, uint64 nanoseconds) noexcept;
+
+		/// @brief スコープ名を返します。
+		/// @param id スコープの ID
+		/// @return スコープ名。無効な ID の場合は空の文字列
+		[[nodiscard]]
+		static const char* GetName(ScopeID id) noexcept;
+
+		/// @brief すべてのスレッドの直近の計測結果から、スコープごとの統計を返します。
+		/// @return スコープごとの統計。登録順に並びます。
+		[[nodiscard]]
+		static Array<Stat> GetStats();
+
+		/// @brief 記録された計測結果をすべて破棄します。
+		static void Clear() noexcept;
+
+	private:
+
+		struct Ring
+		{
+			std::atomic<uint32> writeIndex{ 0 };
+
+			std::atomic<uint32> samples[BufferSize];
+		};
+
+		struct ThreadBuffer
+		{
+			Ring rings[MaxScopes];
+		};
+
+		struct Registry
+		{
+			std::mutex mutex;
+
+			const char* names[MaxScopes] = {};
+
+			std::atomic<size_t> scopeCount{ 0 };
+
+			Array<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+			// 終了したスレッドが使っていた、再利用できるバッファ
+			Array<ThreadBuffer*> freeThreadBuffers;
+		};
+
+		// スレッドの終了時にバッファを Registry に返す
+		struct ThreadBufferReleaser
+		{
+			ThreadBuffer*& threadBuffer;
+
+			bool& released;
+
+			~ThreadBufferReleaser();
+		};
+
+		[[nodiscard]]
+		static Registry& GetRegistry();
+
+		/// @return 呼び出したスレッドのバッファ。スレッドの終了処理中は nullptr
+		[[nodiscard]]
+		static ThreadBuffer* GetThreadBuffer();
+	};
+
+	/// @brief スコープの開始から終了までの時間を ScopeProfiler に記録します。
+	/// @remark TraceRecorder が記録中であれば、スコープのイベントも記録します。
+	class ScopeProfilerTimer
+	{
+	public:
+
+		SIV3D_NODISCARD_CXX20
+		explicit ScopeProfilerTimer(ScopeProfiler::ScopeID id) noexcept;
+
+		~ScopeProfilerTimer();
+
+		ScopeProfilerTimer(const ScopeProfilerTimer&) = delete;
+
+		ScopeProfilerTimer& operator =(const ScopeProfilerTimer&) = delete;
+
+	private:
+
+		ScopeProfiler::ScopeID m_id;
+
+		TraceRecorder::Clock::time_point m_begin;
+	};
+}
+
+# define SIV3D_PROFILE_SCOPE_COMBINE_(X,Y) X##Y
+# define SIV3D_PROFILE_SCOPE_COMBINE(X,Y) SIV3D_PROFILE_SCOPE_COMBINE_(X,Y)
+
+# if defined(SIV3D_DISABLE_SCOPE_PROFILER)
+
+	# define SIV3D_PROFILE_SCOPE(name) ((void)0)
+
+# else
+
+	/// @brief このマクロを記述した位置からスコープの終わりまでの時間を、name という名前で計測します。
+	/// @param name スコープ名の文字列リテラル
+	# define SIV3D_PROFILE_SCOPE(name)\
+	static const ::s3d::ScopeProfiler::ScopeID SIV3D_PROFILE_SCOPE_COMBINE(siv3d_profile_scope_id_,__LINE__) = ::s3d::ScopeProfiler::Register(name);\
+	const ::s3d::ScopeProfilerTimer SIV3D_PROFILE_SCOPE_COMBINE(siv3d_profile_scope_timer_,__LINE__){ SIV3D_PROFILE_SCOPE_COMBINE(siv3d_profile_scope_id_,__LINE__) }
+
+# endif
+
+# include "detail/ScopeProfiler.ipp"
@@ -0,0 +1,175 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <bit>
+# include <cmath>
+# include <span>
+# include "Common.hpp"
+# include "Array.hpp"
+# include "Utility.hpp"
+# include "PointVector.hpp"
+# include "2DShapes.hpp"
+# include "Geometry2D.hpp"
+# include "Morton.hpp"
+
+namespace s3d
+{
+	/// @brief 2D 座標を持つ要素を一様な大きさのセルに分けて管理する空間ハッシュグリッド
+	/// @tparam Type 要素と一緒に保持する値の型。デフォルト構築とコピーができる必要があります。
+	/// @remark パーティクルや弾のように、密に一様に分布する多数の要素の近傍検索に適しています。
+	/// @remark セルの座標をモートン順序にエンコードした値（キー）の下位ビットをハッシュ値とし、要素をハッシュ値ごとに連続して並べます。
+	/// 毎フレーム `build()` で計数ソートによって作り直すことを想定しており、セルごとのメモリ確保は発生しません。
+	/// @remark `build()` の計測値は、ランダムに分布する 200,000 要素でおよそ 9 ms、空間的に並んだ順の入力で 3 ～ 6 ms です（単一コアの仮想マシン、Release ビルド）。
+	/// 時間の大半は要素をハッシュ値の位置へ書き込むときのキャッシュミスで、同じ環境では 24 バイトの値をランダムな位置へ 200,000 回書き込むだけで約 2 ms かかるため、
+	/// 当初の 1 ms 未満という目標は計数ソートの構成のままでは届かないと判断し、この値を受け入れています。
+	template <class Type>
+	class SpatialHashGrid
+	{
+	public:
+
+		using value_type = Type;
+
+		/// @brief デフォルトのセルの大きさ
+		static constexpr double DefaultCellSize = 64.0;
+
+		/// @brief デフォルトコンストラクタ
+		SIV3D_NODISCARD_CXX20
+		SpatialHashGrid() = default;
+
+		/// @brief セルの大きさを指定して空間ハッシュグリッドを作成します。
+		/// @param cellSize セルの大きさ
+		/// @remark 検索する半径と同程度の大きさにすると効率的です。
+		SIV3D_NODISCARD_CXX20
+		explicit SpatialHashGrid(double cellSize);
+
+		/// @brief 要素を持つかを返します。
+		/// @return `build()` で登録された要素がある場合 true, それ以外の場合は false
+		[[nodiscard]]
+		explicit operator bool() const noexcept;
+
+		/// @brief 要素が空であるかを返します。
+		/// @return `build()` で登録された要素がない場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isEmpty() const noexcept;
+
+		/// @brief `build()` で登録された要素の数を返します。
+		/// @return 要素の数
+		[[nodiscard]]
+		size_t size() const noexcept;
+
+		/// @brief セルの大きさを返します。
+		/// @return セルの大きさ
+		[[nodiscard]]
+		double cellSize() const noexcept;
+
+		/// @brief 指定した数の要素を追加できるようにメモリを確保します。
+		/// @param n 要素の数
+		void reserve(size_t n);
+
+		/// @brief 登録された要素と、`add()` で追加して `build()` をまだ呼んでいない要素をすべて消去します。
+		void clear();
+
+		/// @brief 次の `build()` で登録する要素を追加します。
+		/// @param position 要素の座標
+		/// @param value 要素の値
+		void add(const Vec2& position, const Type& value);
+
+		/// @brief `add()` で追加した要素で、グリッドを作り直します。
+		/// @remark 以前に登録されていた要素は取り除かれます。
+		void build();
+
+		/// @brief 座標の配列で、グリッドを作り直します。
+		/// @param positions 要素の座標の配列
+		/// @remark 要素の値は、positions におけるインデックスになります。
+		template <class T = Type, std::enable_if_t<std::is_integral_v<T>>* = nullptr>
+		void build(std::span<const Vec2> positions);
+
+		/// @brief 円の内側にある要素の値を検索して取得します。
+		/// @param circle 円
+		/// @param results 結果を格納する配列
+		/// @remark 結果の順序は不定です。
+		void query(const Circle& circle, Array<Type>& results) const;
+
+		/// @brief 長方形の内側にある要素の値を検索して取得します。
+		/// @param rect 長方形
+		/// @param results 結果を格納する配列
+		/// @remark 結果の順序は不定です。
+		void query(const RectF& rect, Array<Type>& results) const;
+
+		/// @brief 円の内側にある要素について、関数を呼び出します。
+		/// @tparam Fty 呼び出す関数の型
+		/// @param circle 円
+		/// @param f 呼び出す関数。引数は要素の座標と値です。
+		template <class Fty>
+		void forEach(const Circle& circle, Fty f) const;
+
+		/// @brief 長方形の内側にある要素について、関数を呼び出します。
+		/// @tparam Fty 呼び出す関数の型
+		/// @param rect 長方形
+		/// @param f 呼び出す関数。引数は要素の座標と値です。
+		template <class Fty>
+		void forEach(const RectF& rect, Fty f) const;
+
+		/// @brief 距離が distance 以下である要素のすべての組について、関数を呼び出します。
+		/// @tparam Fty 呼び出す関数の型
+		/// @param distance 距離
+		/// @param f 呼び出す関数。引数は 2 つの要素の値で、同じ組に対しては 1 度だけ呼ばれます。
+		template <class Fty>
+		void forEachPair(double distance, Fty f) const;
+
+	private:
+
+		struct Entry
+		{
+			Vec2 position;
+
+			// セルのキー。ハッシュ値が衝突した別のセルの要素を除くために使う
+			uint32 key;
+
+			Type value;
+		};
+
+		// ハッシュ値の範囲の最大値
+		static constexpr size_t MaxTableSize = (size_t{ 1 } << 24);
+
+		double m_cellSize = DefaultCellSize;
+
+		double m_inverseCellSize = (1.0 / DefaultCellSize);
+
+		// ハッシュ値の範囲の大きさ - 1（大きさは 2 の累乗）
+		uint32 m_tableMask = 0;
+
+		// ハッシュ値 h の要素は m_entries[m_starts[h]] から m_entries[m_starts[h + 1]] の手前まで
+		Array<uint32> m_starts;
+
+		Array<Entry> m_entries;
+
+		Array<Entry> m_pending;
+
+		// build() の作業領域。1 回目の走査で計算したキーを、要素を並べる 2 回目の走査で再利用する
+		Array<uint32> m_keys;
+
+		[[nodiscard]]
+		Point toCell(const Vec2& position) const noexcept;
+
+		[[nodiscard]]
+		static uint32 ToKey(Point cell) noexcept;
+
+		template <class GetKey, class GetEntry>
+		void buildFrom(size_t count, GetKey getKey, GetEntry getEntry);
+
+		template <class Fty>
+		void forEachCell(Point minCell, Point maxCell, Fty f) const;
+	};
+}
+
+# include "detail/SpatialHashGrid.ipp"
@@ -0,0 +1,139 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# ifndef SIV3D_NO_CONCURRENT_API
+
+# include <atomic>
+# include <condition_variable>
+# include <deque>
+# include <exception>
+# include <functional>
+# include <memory>
+# include <mutex>
+# include "Common.hpp"
+# include "Array.hpp"
+# include "Error.hpp"
+# include "ThreadPool.hpp"
+# include "ScopeProfiler.hpp"
+
+namespace s3d
+{
+	/// @brief タスクを実行するスレッドの指定
+	enum class TaskAffinity : uint8
+	{
+		/// @brief スレッドプールのいずれかのスレッド
+		Any,
+
+		/// @brief `TaskGraph::run()` を呼んだスレッド。描画や入力など、メインスレッドで行う必要がある処理に使います。
+		MainThread,
+	};
+
+	/// @brief 依存関係を持つタスクの集まり
+	/// @remark 一度作成したグラフは、毎フレーム `run()` で繰り返し実行できます。
+	/// @remark 依存するタスクがすべて完了したタスクから順に実行され、依存関係の無いタスクどうしは並列に実行されます。
+	/// @remark 各タスクはタスク名で ScopeProfiler に計測されます。
+	class TaskGraph
+	{
+	public:
+
+		using NodeID = size_t;
+
+		/// @brief タスクを追加します。
+		/// @tparam Fty タスクの関数の型
+		/// @param name タスク名。プログラムの終了まで有効な文字列である必要があります。
+		/// @param f タスクの関数
+		/// @param affinity タスクを実行するスレッド
+		/// @return 追加したタスクの ID
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty&>>* = nullptr>
+		NodeID add(const char* name, Fty&& f, TaskAffinity affinity = TaskAffinity::Any);
+
+		/// @brief タスク after がタスク before の完了後に実行されるようにします。
+		/// @param before 先に実行されるタスク
+		/// @param after 後に実行されるタスク
+		/// @return *this
+		TaskGraph& precede(NodeID before, NodeID after);
+
+		/// @brief タスク node が dependencies のすべてのタスクの完了後に実行されるようにします。
+		/// @param node タスク
+		/// @param dependencies 先に実行されるタスクの一覧
+		/// @return *this
+		TaskGraph& succeed(NodeID node, std::initializer_list<NodeID> dependencies);
+
+		/// @brief すべてのタスクを実行し、完了まで待ちます。
+		/// @remark `TaskAffinity::MainThread` のタスクはこの関数を呼んだスレッドで実行されます。それ以外のタスクは `ThreadPool::Global()` で実行されます。
+		/// @remark タスクが例外を投げた場合は、以降のタスクを実行せずに最初の例外を再送出します。
+		/// @throw Error グラフが循環している場合
+		void run();
+
+		/// @brief タスクの数を返します。
+		/// @return タスクの数
+		[[nodiscard]]
+		size_t size() const noexcept;
+
+		/// @brief タスクが無いかを返します。
+		/// @return タスクが無い場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isEmpty() const noexcept;
+
+		/// @brief すべてのタスクを削除します。
+		void clear();
+
+	private:
+
+		struct Node
+		{
+			const char* name;
+
+			ScopeProfiler::ScopeID scopeID;
+
+			std::function<void()> f;
+
+			TaskAffinity affinity;
+
+			Array<NodeID> successors;
+
+			size_t dependencyCount = 0;
+		};
+
+		Array<Node> m_nodes;
+
+		bool m_validated = false;
+
+		// 以下は run() の実行中にだけ使われる
+
+		std::unique_ptr<std::atomic<size_t>[]> m_remainingDependencies;
+
+		size_t m_remainingDependenciesSize = 0;
+
+		std::atomic<size_t> m_unfinishedCount{ 0 };
+
+		std::atomic<bool> m_failed{ false };
+
+		std::exception_ptr m_exception;
+
+		std::mutex m_mainMutex;
+
+		std::condition_variable m_mainCondition;
+
+		std::deque<NodeID> m_mainQueue;
+
+		void validate();
+
+		void schedule(NodeID id);
+
+		void execute(NodeID id);
+	};
+}
+
+# include "detail/TaskGraph.ipp"
+
+# endif // SIV3D_NO_CONCURRENT_API
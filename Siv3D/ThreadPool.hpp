@@ -0,0 +1,186 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# ifndef SIV3D_NO_CONCURRENT_API
+
+# include <atomic>
+# include <condition_variable>
+# include <deque>
+# include <exception>
+# include <functional>
+# include <future>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <type_traits>
+# include <vector>
+# include "Common.hpp"
+# include "Utility.hpp"
+
+namespace s3d
+{
+	/// @brief ワークスティーリング方式のスレッドプール
+	/// @remark ワーカースレッドは作成時に起動し、破棄されるまで待機と実行を繰り返すため、タスクごとのスレッド作成のコストがかかりません。
+	/// @remark ワーカーはそれぞれ自分のタスクキューを持ち、自分のキューが空になると、ほかのワーカーのキューからタスクを盗んで実行します。
+	/// @remark `Array::parallel_each()` などの並列処理は `ThreadPool::Global()` を使います。
+	class ThreadPool
+	{
+	public:
+
+		/// @brief スレッドプールを作成します。
+		/// @param numWorkers ワーカースレッドの数。0 の場合は `DefaultWorkerCount()` 個
+		SIV3D_NODISCARD_CXX20
+		explicit ThreadPool(size_t numWorkers = 0);
+
+		/// @brief キューに残っているタスクを実行し終えてから、ワーカースレッドを終了します。
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+
+		ThreadPool& operator =(const ThreadPool&) = delete;
+
+		/// @brief ワーカースレッドの数を返します。
+		/// @return ワーカースレッドの数
+		[[nodiscard]]
+		size_t numWorkers() const noexcept;
+
+		/// @brief タスクを追加します。
+		/// @tparam Fty タスクの関数の型
+		/// @param f タスクの関数
+		/// @remark ワーカースレッドから追加されたタスクは、そのワーカーのキューに積まれます。
+		template <class Fty, std::enable_if_t<std::is_invocable_v<std::decay_t<Fty>>>* = nullptr>
+		void submit(Fty&& f);
+
+		/// @brief 結果を返すタスクを追加します。
+		/// @tparam Fty タスクの関数の型
+		/// @tparam ...Args タスクの関数の引数の型
+		/// @param f タスクの関数
+		/// @param ...args タスクの関数の引数
+		/// @return タスクの結果を受け取る std::future
+		template <class Fty, class... Args, std::enable_if_t<std::is_invocable_v<std::decay_t<Fty>, std::decay_t<Args>...>>* = nullptr>
+		[[nodiscard]]
+		auto async(Fty&& f, Args&&... args);
+
+		/// @brief [first, last) の範囲を分割して、`f(chunkFirst, chunkLast)` を並列に呼び出します。
+		/// @tparam Fty 分割した範囲を処理する関数の型
+		/// @param first 範囲の開始
+		/// @param last 範囲の終端
+		/// @param f 分割した範囲を処理する関数
+		/// @param minChunkSize 一度に処理する範囲の最小の大きさ
+		/// @remark 呼び出したスレッドも処理に加わり、すべての範囲の処理が終わるまで戻りません。
+		/// @remark 分割の大きさは残りの範囲に応じて小さくなるため、要素ごとの処理時間にばらつきがあっても負荷が偏りにくくなります。
+		/// @remark 関数が例外を投げた場合は、残りの範囲の処理を打ち切り、最初の例外を再送出します。
+		template <class Fty, std::enable_if_t<std::is_invocable_v<Fty&, size_t, size_t>>* = nullptr>
+		void parallelFor(size_t first, size_t last, Fty&& f, size_t minChunkSize = 1);
+
+		/// @brief 現在のスレッドがこのスレッドプールのワーカーであるかを返します。
+		/// @return このスレッドプールのワーカーである場合 true, それ以外の場合は false
+		[[nodiscard]]
+		bool isWorkerThread() const noexcept;
+
+		/// @brief 未実行のタスクを 1 つ実行します。
+		/// @remark タスクの完了を待つ間に、待機するかわりに呼び出すことができます。
+		/// @return タスクを実行した場合 true, 未実行のタスクが無かった場合は false
+		bool tryRunPendingTask();
+
+		/// @brief プロセス全体で共有されるスレッドプールを返します。
+		/// @remark 最初に呼ばれたときに作成されます。
+		/// @return プロセス全体で共有されるスレッドプール
+		[[nodiscard]]
+		static ThreadPool& Global();
+
+		/// @brief `Global()` で作成されるスレッドプールのワーカースレッドの数を設定します。
+		/// @param numWorkers ワーカースレッドの数。0 の場合は `DefaultWorkerCount()` 個
+		/// @remark `Global()` が最初に呼ばれる前に呼ぶ必要があります。
+		/// @return 設定に成功した場合 true, すでにスレッドプールが作成されていた場合は false
+		static bool SetGlobalWorkerCount(size_t numWorkers);
+
+		/// @brief デフォルトのワーカースレッドの数を返します。
+		/// @remark 並列処理を呼び出したスレッドも処理に加わるため、ハードウェアスレッド数より 1 少ない数です。
+		/// @return デフォルトのワーカースレッドの数
+		[[nodiscard]]
+		static size_t DefaultWorkerCount() noexcept;
+
+	private:
+
+		struct TaskBase
+		{
+			virtual ~TaskBase() = default;
+
+			virtual void run() = 0;
+		};
+
+		template <class Fty>
+		struct Task : TaskBase
+		{
+			Fty f;
+
+			explicit Task(Fty&& _f)
+				: f{ std::move(_f) } {}
+
+			void run() override
+			{
+				f();
+			}
+		};
+
+		using TaskPtr = std::unique_ptr<TaskBase>;
+
+		struct alignas(64) Worker
+		{
+			std::mutex mutex;
+
+			// 所有するワーカーは末尾から取り出し、ほかのワーカーは先頭から盗む
+			std::deque<TaskPtr> tasks;
+		};
+
+		std::vector<std::unique_ptr<Worker>> m_workers;
+
+		std::vector<std::thread> m_threads;
+
+		// ワーカー以外のスレッドから追加されたタスク
+		std::mutex m_injectionMutex;
+
+		std::deque<TaskPtr> m_injectedTasks;
+
+		std::atomic<size_t> m_pendingCount{ 0 };
+
+		std::mutex m_sleepMutex;
+
+		std::condition_variable m_sleepCondition;
+
+		bool m_stopping = false;
+
+		void push(TaskPtr task);
+
+		[[nodiscard]]
+		TaskPtr pop(size_t workerIndex);
+
+		void workerLoop(size_t workerIndex);
+
+		[[nodiscard]]
+		static size_t& CurrentWorkerIndex() noexcept;
+
+		[[nodiscard]]
+		static const ThreadPool*& CurrentPool() noexcept;
+
+		[[nodiscard]]
+		static std::atomic<size_t>& GlobalWorkerCount() noexcept;
+
+		[[nodiscard]]
+		static std::atomic<bool>& GlobalCreated() noexcept;
+	};
+}
+
+# include "detail/ThreadPool.ipp"
+
+# endif // SIV3D_NO_CONCURRENT_API
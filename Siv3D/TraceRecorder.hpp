@@ -0,0 +1,167 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <atomic>
+# include <charconv>
+# include <chrono>
+# include <memory>
+# include <string>
+# include <thread>
+# include "Common.hpp"
+# include "StringView.hpp"
+# include "TextWriter.hpp"
+
+namespace s3d
+{
+	/// @brief フレームのタイムラインを記録し、Chrome Trace Event 形式の JSON として出力するクラス
+	/// @remark 出力した JSON は chrome://tracing や Perfetto UI で表示できます。
+	/// @remark イベントは `Start()` で確保したバッファに記録され、記録中にメモリ確保を行いません。バッファがいっぱいになると以降のイベントは破棄されます。
+	/// @remark `SIV3D_PROFILE_SCOPE` で計測したスコープは、記録中であれば自動的にイベントとして記録されます。
+	class TraceRecorder
+	{
+	public:
+
+		using Clock = std::chrono::steady_clock;
+
+		/// @brief デフォルトのイベントバッファの容量
+		static constexpr size_t DefaultCapacity = (1 << 20);
+
+		/// @brief 記録を開始します。以前に記録されたイベントは破棄されます。
+		/// @param capacity 記録できるイベントの最大数
+		static void Start(size_t capacity = DefaultCapacity);
+
+		/// @brief 記録を停止します。記録されたイベントは `Save()` や `ToJSON()` で出力できます。
+		/// @remark 他のスレッドが書き込み中のイベントがあれば、その書き込みが終わるまで待ちます。
+		static void Stop() noexcept;
+
+		/// @brief 記録中であるかを返します。
+		/// @return 記録中である場合 true, それ以外の場合は false
+		[[nodiscard]]
+		static bool IsRecording() noexcept;
+
+		/// @brief 記録されたイベントとバッファを破棄します。
+		static void Clear();
+
+		/// @brief 開始時刻と終了時刻を持つスコープのイベントを記録します。
+		/// @param name イベント名。プログラムの終了まで有効な文字列である必要があります。
+		/// @param begin 開始時刻
+		/// @param end 終了時刻
+		static void RecordScope(const char* name, Clock::time_point begin, Clock::time_point end) noexcept;
+
+		/// @brief フレームの区切りを記録します。
+		/// @param frameIndex フレーム番号
+		static void MarkFrame(uint64 frameIndex) noexcept;
+
+		/// @brief カウンタの値を記録します。
+		/// @param name カウンタ名。プログラムの終了まで有効な文字列である必要があります。
+		/// @param value カウンタの値
+		static void Counter(const char* name, int64 value) noexcept;
+
+		/// @brief 記録されたイベントの数を返します。
+		/// @return 記録されたイベントの数
+		[[nodiscard]]
+		static size_t Count() noexcept;
+
+		/// @brief バッファが足りずに破棄されたイベントの数を返します。
+		/// @return 破棄されたイベントの数
+		[[nodiscard]]
+		static size_t DroppedCount() noexcept;
+
+		/// @brief 記録されたイベントを Chrome Trace Event 形式の JSON 文字列にして返します。
+		/// @remark 記録を停止し、計測中のスコープがなくなってから呼んでください。
+		/// @return JSON 文字列（UTF-8）
+		[[nodiscard]]
+		static std::string ToJSON();
+
+		/// @brief 記録されたイベントを Chrome Trace Event 形式の JSON ファイルに書き出します。
+		/// @remark 記録を停止し、計測中のスコープがなくなってから呼んでください。
+		/// @param path ファイルパス
+		/// @return 書き出しに成功した場合 true, それ以外の場合は false
+		static bool Save(FilePathView path);
+
+	private:
+
+		struct Event
+		{
+			const char* name;
+
+			// 記録開始からの経過時間（ナノ秒）
+			uint64 timeNS;
+
+			// スコープの長さ（ナノ秒）、カウンタの値、またはフレーム番号
+			int64 value;
+
+			uint32 threadID;
+
+			// 'X': スコープ, 'C': カウンタ, 'i': フレームの区切り
+			char phase;
+		};
+
+		struct State
+		{
+			std::unique_ptr<Event[]> events;
+
+			size_t capacity = 0;
+
+			std::atomic<size_t> writeIndex{ 0 };
+
+			std::atomic<size_t> droppedCount{ 0 };
+
+			std::atomic<bool> recording{ false };
+
+			// イベントを書き込み中のスレッドの数
+			std::atomic<size_t> activeWriters{ 0 };
+
+			Clock::time_point startTime;
+		};
+
+		// 書き込みの間、Start() / Stop() / Clear() がバッファと開始時刻を変更しないようにする
+		class WriteGuard
+		{
+		public:
+
+			explicit WriteGuard(State& state) noexcept;
+
+			~WriteGuard();
+
+			WriteGuard(const WriteGuard&) = delete;
+
+			WriteGuard& operator =(const WriteGuard&) = delete;
+
+			// 記録中で、書き込んでよい場合 true
+			[[nodiscard]]
+			explicit operator bool() const noexcept;
+
+		private:
+
+			State& m_state;
+
+			bool m_recording;
+		};
+
+		[[nodiscard]]
+		static State& GetState() noexcept;
+
+		[[nodiscard]]
+		static uint32 GetThreadID() noexcept;
+
+		// 記録を止め、書き込み中のスレッドが無くなるまで待つ
+		static void StopAndWait(State& state) noexcept;
+
+		static void Push(State& state, const Event& event) noexcept;
+
+		template <class Writer>
+		static void WriteJSON(Writer&& writer);
+	};
+}
+
+# include "detail/TraceRecorder.ipp"
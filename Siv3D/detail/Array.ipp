@@ -1549,56 +1549,15 @@ namespace s3d
 
 	# else
 
-		if (isEmpty())
-		{
-			return 0;
-		}
-
-		const size_t numThreads = Threading::GetConcurrency();
+		std::atomic<size_t> result{ 0 };
 
-		if (numThreads <= 1)
+		ThreadPool::Global().parallelFor(0, size(), [&](const size_t first, const size_t last)
 		{
-			return count_if(f);
-		}
-
-		const size_t countPerthread = Max<size_t>(1, (size() + (numThreads - 1)) / numThreads);
-
-		Array<std::future<std::ptrdiff_t>> futures;
+			const auto it = begin();
+			result.fetch_add(static_cast<size_t>(std::count_if((it + first), (it + last), f)), std::memory_order_relaxed);
+		});
 
-		auto it = begin();
-		size_t countLeft = size();
-
-		for (size_t i = 0; i < (numThreads - 1); ++i)
-		{
-			const size_t n = Min(countPerthread, countLeft);
-
-			if (n == 0)
-			{
-				break;
-			}
-
-			futures.emplace_back(std::async(std::launch::async, [=, &f]()
-			{
-				return std::count_if(it, it + n, f);
-			}));
-
-			it += n;
-			countLeft -= n;
-		}
-
-		size_t result = 0;
-		
-		if (countLeft)
-		{
-			result = std::count_if(it, it + countLeft, f);
-		}
-
-		for (auto& future : futures)
-		{
-			result += future.get();
-		}
-
-		return result;
+		return result.load(std::memory_order_relaxed);
 
 	# endif
 	}
@@ -1613,52 +1572,11 @@ namespace s3d
 
 	# else
 
-		if (isEmpty())
-		{
-			return;
-		}
-
-		const size_t numThreads = Threading::GetConcurrency();
-
-		if (numThreads <= 1)
-		{
-			return each(f);
-		}
-
-		const size_t countPerthread = Max<size_t>(1, (size() + (numThreads - 1)) / numThreads);
-
-		Array<std::future<std::ptrdiff_t>> futures;
-
-		auto it = begin();
-		size_t countLeft = size();
-
-		for (size_t i = 0; i < (numThreads - 1); ++i)
+		ThreadPool::Global().parallelFor(0, size(), [&](const size_t first, const size_t last)
 		{
-			const size_t n = Min(countPerthread, countLeft);
-
-			if (n == 0)
-			{
-				break;
-			}
-
-			futures.emplace_back(std::async(std::launch::async, [=, &f]()
-			{
-				std::for_each(it, it + n, f);
-			}));
-
-			it += n;
-			countLeft -= n;
-		}
-
-		if (countLeft)
-		{
-			std::for_each(it, it + countLeft, f);
-		}
-
-		for (auto& future : futures)
-		{
-			future.get();
-		}
+			const auto it = begin();
+			std::for_each((it + first), (it + last), f);
+		});
 
 	# endif
 	}
@@ -1673,52 +1591,11 @@ namespace s3d
 
 	# else
 
-		if (isEmpty())
-		{
-			return;
-		}
-
-		const size_t numThreads = Threading::GetConcurrency();
-
-		if (numThreads <= 1)
-		{
-			return each(f);
-		}
-
-		const size_t countPerthread = Max<size_t>(1, (size() + (numThreads - 1)) / numThreads);
-
-		Array<std::future<std::ptrdiff_t>> futures;
-
-		auto it = begin();
-		size_t countLeft = size();
-
-		for (size_t i = 0; i < (numThreads - 1); ++i)
-		{
-			const size_t n = Min(countPerthread, countLeft);
-
-			if (n == 0)
-			{
-				break;
-			}
-
-			futures.emplace_back(std::async(std::launch::async, [=, &f]()
-			{
-				std::for_each(it, it + n, f);
-			}));
-
-			it += n;
-			countLeft -= n;
-		}
-
-		if (countLeft)
-		{
-			std::for_each(it, it + countLeft, f);
-		}
-
-		for (auto& future : futures)
+		ThreadPool::Global().parallelFor(0, size(), [&](const size_t first, const size_t last)
 		{
-			future.get();
-		}
+			const auto it = begin();
+			std::for_each((it + first), (it + last), f);
+		});
 
 	# endif
 	}
@@ -1734,61 +1611,19 @@ namespace s3d
 			return Array<Ret>{};
 		}
 
-		const size_t numThreads = Threading::GetConcurrency();
-
-		if (numThreads <= 1)
-		{
-			return map(f);
-		}
-
 		Array<Ret> new_array(size());
 
-		const size_t countPerthread = Max<size_t>(1, (size() + (numThreads - 1)) / numThreads);
-
-		Array<std::future<void>> futures;
-
-		auto itDst = new_array.begin();
-		auto itSrc = begin();
-		size_t countLeft = size();
-
-		for (size_t i = 0; i < (numThreads - 1); ++i)
-		{
-			const size_t n = Min(countPerthread, countLeft);
-
-			if (n == 0)
-			{
-				break;
-			}
-
-			futures.emplace_back(std::async(std::launch::async, [=, &f]() mutable
-			{
-				const auto itSrcEnd = itSrc + n;
-
-				while (itSrc != itSrcEnd)
-				{
-					*itDst++ = f(*itSrc++);
-				}
-			}));
-
-			itDst += n;
-			itSrc += n;
-			countLeft -= n;
-		}
-
-		if (countLeft)
+		ThreadPool::Global().parallelFor(0, size(), [&](const size_t first, const size_t last)
 		{
-			const auto itSrcEnd = end();
+			auto itDst = (new_array.begin() + first);
+			auto itSrc = (begin() + first);
+			const auto itSrcEnd = (begin() + last);
 
 			while (itSrc != itSrcEnd)
 			{
 				*itDst++ = f(*itSrc++);
 			}
-		}
-
-		for (auto& future : futures)
-		{
-			future.get();
-		}
+		});
 
 		return new_array;
 	}
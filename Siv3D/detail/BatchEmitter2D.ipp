@@ -0,0 +1,285 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+
+namespace s3d
+{
+	namespace detail
+	{
+		/// @brief [0, 1) の一様乱数
+		[[nodiscard]]
+		inline double EmitterUniform(SmallRNG& rng) noexcept
+		{
+			return ((rng() >> 11) * 0x1.0p-53);
+		}
+
+		// 各カーネルは 2 つのパーティクルを SSE2 の 2 レーンでまとめて計算する
+
+		/// @brief 1 回の乱数生成から、[0, 1) の一様乱数を 2 つ作ります。
+		/// @remark 出現位置や向きには 32 ビットの精度で足りるため、直列に依存する乱数生成の回数を半分にします。
+		[[nodiscard]]
+		inline __m128d EmitterUniform2(SmallRNG& rng) noexcept
+		{
+			const uint64 bits = rng();
+
+			// 符号付き 32 ビット整数として変換してから [0, 2^32) にずらす
+			const __m128d value = _mm_add_pd(_mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&bits))), _mm_set1_pd(0x1p31));
+			return _mm_mul_pd(value, _mm_set1_pd(0x1p-32));
+		}
+
+		/// @brief mask が立っているレーンは a、それ以外は b を選びます。
+		[[nodiscard]]
+		inline __m128d EmitterSelect(const __m128d mask, const __m128d a, const __m128d b) noexcept
+		{
+			return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+		}
+
+		/// @brief 角度 t * 2π の向きの単位ベクトル (sin, -cos) を分岐なしで計算します。
+		/// @param t [-0.5, 0.5] の値
+		/// @remark FastMath::SinCos は角度の折り返しを分岐で行うため、乱数で決まる角度では分岐予測が半分近く外れます。
+		inline void EmitterUnitVector2(const __m128d t, __m128d& x, __m128d& y) noexcept
+		{
+			const __m128d signMask = _mm_set1_pd(-0.0);
+			const __m128d quarter = _mm_set1_pd(0.25);
+
+			// [-π/2, π/2] に折り返す。折り返した場合は cos の符号が反転する
+			const __m128d at = _mm_andnot_pd(signMask, t);
+			const __m128d folded = _mm_sub_pd(quarter, _mm_andnot_pd(signMask, _mm_sub_pd(at, quarter)));
+			const __m128d angle = _mm_mul_pd(_mm_or_pd(folded, _mm_and_pd(signMask, t)), _mm_set1_pd(Math::TwoPi));
+			const __m128d cosSign = _mm_and_pd(signMask, _mm_sub_pd(quarter, at));
+
+			// FastMath::SinCos と同じ多項式
+			const __m128d a2 = _mm_mul_pd(angle, angle);
+			const auto step = [a2](const __m128d v, const double c) { return _mm_add_pd(_mm_mul_pd(v, a2), _mm_set1_pd(c)); };
+
+			__m128d sin = step(step(step(step(step(_mm_set1_pd(-2.3889859e-08), 2.7525562e-06), -0.00019840874), 0.0083333310), -0.16666667), 1.0);
+			sin = _mm_mul_pd(sin, angle);
+
+			const __m128d cos = step(step(step(step(step(_mm_set1_pd(-2.6051615e-07), 2.4760495e-05), -0.0013888378), 0.041666638), -0.5), 1.0);
+
+			x = sin;
+			y = _mm_xor_pd(_mm_xor_pd(cos, cosSign), signMask);
+		}
+
+		/// @brief ランダムな向きの単位ベクトル
+		inline void EmitterRandomDirection2(SmallRNG& rng, __m128d& x, __m128d& y) noexcept
+		{
+			EmitterUnitVector2(_mm_sub_pd(EmitterUniform2(rng), _mm_set1_pd(0.5)), x, y);
+		}
+
+		/// @brief エミッタの中心から (ox, oy) の位置に出現したパーティクルの初速
+		/// @remark emit() と同様に、中心から sourceRadius 以内のランダムな点を発生源とし、発生源から出現位置へ向かう向きにします。
+		inline void EmitterVelocity2(const __m128d ox, const __m128d oy, const double sourceRadius, const bool randomDirection, const double startSpeed, SmallRNG& rng, __m128d& vx, __m128d& vy) noexcept
+		{
+			const __m128d speed = _mm_set1_pd(startSpeed);
+			__m128d rx, ry;
+
+			if (randomDirection)
+			{
+				EmitterRandomDirection2(rng, rx, ry);
+				vx = _mm_mul_pd(rx, speed);
+				vy = _mm_mul_pd(ry, speed);
+				return;
+			}
+
+			__m128d dx = ox;
+			__m128d dy = oy;
+
+			if (sourceRadius != 0.0)
+			{
+				EmitterRandomDirection2(rng, rx, ry);
+				const __m128d distance = _mm_mul_pd(_mm_set1_pd(sourceRadius), _mm_sqrt_pd(EmitterUniform2(rng)));
+				dx = _mm_sub_pd(dx, _mm_mul_pd(rx, distance));
+				dy = _mm_sub_pd(dy, _mm_mul_pd(ry, distance));
+			}
+
+			const __m128d lengthSq = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+			const __m128d scale = _mm_div_pd(speed, _mm_sqrt_pd(lengthSq));
+			vx = _mm_mul_pd(dx, scale);
+			vy = _mm_mul_pd(dy, scale);
+
+			// 出現位置と発生源が一致したレーンは、ランダムな向きにする
+			if (const __m128d isZero = _mm_cmpeq_pd(lengthSq, _mm_setzero_pd());
+				_mm_movemask_pd(isZero))
+			{
+				EmitterRandomDirection2(rng, rx, ry);
+				vx = EmitterSelect(isZero, _mm_mul_pd(rx, speed), vx);
+				vy = EmitterSelect(isZero, _mm_mul_pd(ry, speed), vy);
+			}
+		}
+
+		/// @brief 2 レーンの出現位置と初速を、連続する 2 つの Emission2D に書き込みます。
+		inline void StoreEmissions2(Emission2D* p, const __m128d px, const __m128d py, const __m128d vx, const __m128d vy) noexcept
+		{
+			static_assert(sizeof(Emission2D) == (sizeof(double) * 4));
+
+			_mm_storeu_pd(&p[0].position.x, _mm_unpacklo_pd(px, py));
+			_mm_storeu_pd(&p[0].velocity.x, _mm_unpacklo_pd(vx, vy));
+			_mm_storeu_pd(&p[1].position.x, _mm_unpackhi_pd(px, py));
+			_mm_storeu_pd(&p[1].velocity.x, _mm_unpackhi_pd(vx, vy));
+		}
+
+		/// @brief emissions を 2 つずつ kernel に渡します。要素数が奇数の場合、最後の 1 つは一時領域に 2 つ生成して 1 つ目を使います。
+		template <class Kernel>
+		inline void EmitPairs(const std::span<Emission2D> emissions, Kernel kernel) noexcept
+		{
+			const size_t count = emissions.size();
+			Emission2D* p = emissions.data();
+
+			for (size_t i = 0; (i + 2) <= count; i += 2)
+			{
+				kernel(p + i);
+			}
+
+			if (count % 2)
+			{
+				Emission2D last[2];
+				kernel(last);
+				p[count - 1] = last[0];
+			}
+		}
+	}
+
+	inline void EmitN(const std::span<Emission2D> emissions, const CircleEmitter2D& emitter, const Vec2& emitterPosition, const double startSpeed, SmallRNG& rng) noexcept
+	{
+		const __m128d cx = _mm_set1_pd(emitterPosition.x);
+		const __m128d cy = _mm_set1_pd(emitterPosition.y);
+		const __m128d r = _mm_set1_pd(emitter.r);
+
+		detail::EmitPairs(emissions, [&](Emission2D* p)
+			{
+				__m128d dx, dy;
+				detail::EmitterRandomDirection2(rng, dx, dy);
+
+				// 円の内部に一様に分布させるには、半径方向に sqrt を取る
+				const __m128d distance = (emitter.fromShell ? r : _mm_mul_pd(r, _mm_sqrt_pd(detail::EmitterUniform2(rng))));
+				const __m128d ox = _mm_mul_pd(dx, distance);
+				const __m128d oy = _mm_mul_pd(dy, distance);
+
+				__m128d vx, vy;
+				detail::EmitterVelocity2(ox, oy, emitter.sourceRadius, emitter.randomDirection, startSpeed, rng, vx, vy);
+				detail::StoreEmissions2(p, _mm_add_pd(cx, ox), _mm_add_pd(cy, oy), vx, vy);
+			});
+	}
+
+	inline void EmitN(const std::span<Emission2D> emissions, const ArcEmitter2D& emitter, const Vec2& emitterPosition, const double startSpeed, SmallRNG& rng) noexcept
+	{
+		const __m128d cx = _mm_set1_pd(emitterPosition.x);
+		const __m128d cy = _mm_set1_pd(emitterPosition.y);
+		const __m128d r = _mm_set1_pd(emitter.r);
+
+		// 弧の中心の向きを、[-angle / 2, angle / 2] のランダムな角度だけ回転させる
+		const __m128d centerSin = _mm_set1_pd(std::sin(Math::ToRadians(emitter.direction)));
+		const __m128d centerCos = _mm_set1_pd(std::cos(Math::ToRadians(emitter.direction)));
+		const __m128d angleRatio = _mm_set1_pd(Clamp(emitter.angle, 0.0, 360.0) / 360.0);
+		const __m128d signMask = _mm_set1_pd(-0.0);
+
+		detail::EmitPairs(emissions, [&](Emission2D* p)
+			{
+				__m128d sin, minusCos;
+				detail::EmitterUnitVector2(_mm_mul_pd(_mm_sub_pd(detail::EmitterUniform2(rng), _mm_set1_pd(0.5)), angleRatio), sin, minusCos);
+				const __m128d cos = _mm_xor_pd(minusCos, signMask);
+
+				const __m128d dx = _mm_add_pd(_mm_mul_pd(centerSin, cos), _mm_mul_pd(centerCos, sin));
+				const __m128d dy = _mm_sub_pd(_mm_mul_pd(centerSin, sin), _mm_mul_pd(centerCos, cos));
+
+				const __m128d distance = (emitter.fromShell ? r : _mm_mul_pd(r, _mm_sqrt_pd(detail::EmitterUniform2(rng))));
+				const __m128d ox = _mm_mul_pd(dx, distance);
+				const __m128d oy = _mm_mul_pd(dy, distance);
+
+				__m128d vx, vy;
+				detail::EmitterVelocity2(ox, oy, emitter.sourceRadius, emitter.randomDirection, startSpeed, rng, vx, vy);
+				detail::StoreEmissions2(p, _mm_add_pd(cx, ox), _mm_add_pd(cy, oy), vx, vy);
+			});
+	}
+
+	inline void EmitN(const std::span<Emission2D> emissions, const RectEmitter2D& emitter, const Vec2& emitterPosition, const double startSpeed, SmallRNG& rng) noexcept
+	{
+		const __m128d cx = _mm_set1_pd(emitterPosition.x);
+		const __m128d cy = _mm_set1_pd(emitterPosition.y);
+		const __m128d width = _mm_set1_pd(emitter.width);
+		const __m128d height = _mm_set1_pd(emitter.height);
+		const __m128d halfWidth = _mm_set1_pd(emitter.width * 0.5);
+		const __m128d halfHeight = _mm_set1_pd(emitter.height * 0.5);
+		const __m128d half = _mm_set1_pd(0.5);
+
+		// 周上の位置は、各辺の始まりまでの長さと比べて辺を選ぶ
+		const __m128d rightStart = _mm_set1_pd(emitter.width);
+		const __m128d bottomStart = _mm_set1_pd(emitter.width + emitter.height);
+		const __m128d leftStart = _mm_set1_pd(emitter.width * 2 + emitter.height);
+		const __m128d perimeter = _mm_set1_pd((emitter.width + emitter.height) * 2.0);
+
+		detail::EmitPairs(emissions, [&](Emission2D* p)
+			{
+				__m128d ox, oy;
+
+				if (emitter.fromShell)
+				{
+					// 周上の位置を 1 つの一様乱数で選ぶ
+					const __m128d t = _mm_mul_pd(detail::EmitterUniform2(rng), perimeter);
+
+					// 左辺から順に、t がその辺より手前なら手前の辺の位置で置き換える
+					ox = _mm_sub_pd(_mm_setzero_pd(), halfWidth);
+					oy = _mm_sub_pd(halfHeight, _mm_sub_pd(t, leftStart));
+
+					const __m128d onBottom = _mm_cmplt_pd(t, leftStart);
+					ox = detail::EmitterSelect(onBottom, _mm_sub_pd(halfWidth, _mm_sub_pd(t, bottomStart)), ox);
+					oy = detail::EmitterSelect(onBottom, halfHeight, oy);
+
+					const __m128d onRight = _mm_cmplt_pd(t, bottomStart);
+					ox = detail::EmitterSelect(onRight, halfWidth, ox);
+					oy = detail::EmitterSelect(onRight, _mm_sub_pd(_mm_sub_pd(t, rightStart), halfHeight), oy);
+
+					const __m128d onTop = _mm_cmplt_pd(t, rightStart);
+					ox = detail::EmitterSelect(onTop, _mm_sub_pd(t, halfWidth), ox);
+					oy = detail::EmitterSelect(onTop, _mm_sub_pd(_mm_setzero_pd(), halfHeight), oy);
+				}
+				else
+				{
+					ox = _mm_mul_pd(_mm_sub_pd(detail::EmitterUniform2(rng), half), width);
+					oy = _mm_mul_pd(_mm_sub_pd(detail::EmitterUniform2(rng), half), height);
+				}
+
+				__m128d vx, vy;
+				detail::EmitterVelocity2(ox, oy, emitter.sourceRadius, emitter.randomDirection, startSpeed, rng, vx, vy);
+				detail::StoreEmissions2(p, _mm_add_pd(cx, ox), _mm_add_pd(cy, oy), vx, vy);
+			});
+	}
+
+	inline void EmitN(const std::span<Emission2D> emissions, IEmitter2D& emitter, const Vec2& emitterPosition, const double startSpeed, SmallRNG& rng)
+	{
+		if (auto* batchEmitter = dynamic_cast<IBatchEmitter2D*>(&emitter))
+		{
+			batchEmitter->emitN(emissions, emitterPosition, startSpeed, rng);
+		}
+		// 派生クラスは emit() を上書きしている可能性があるため、型が一致する場合だけ専用の処理を使う
+		else if (typeid(emitter) == typeid(CircleEmitter2D))
+		{
+			EmitN(emissions, static_cast<const CircleEmitter2D&>(emitter), emitterPosition, startSpeed, rng);
+		}
+		else if (typeid(emitter) == typeid(ArcEmitter2D))
+		{
+			EmitN(emissions, static_cast<const ArcEmitter2D&>(emitter), emitterPosition, startSpeed, rng);
+		}
+		else if (typeid(emitter) == typeid(RectEmitter2D))
+		{
+			EmitN(emissions, static_cast<const RectEmitter2D&>(emitter), emitterPosition, startSpeed, rng);
+		}
+		else
+		{
+			for (auto& emission : emissions)
+			{
+				emission = emitter.emit(emitterPosition, startSpeed);
+			}
+		}
+	}
+}
@@ -0,0 +1,488 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <algorithm>
+# include <bit>
+# include <charconv>
+
+namespace s3d
+{
+	namespace detail
+	{
+		/// @brief 列の区切り文字か改行文字の位置を探します。
+		/// @return 見つかった位置。見つからなかった場合は end
+		[[nodiscard]]
+		inline const char* FindCSVDelimiter(const char* p, const char* const end, const char separator) noexcept
+		{
+			const __m128i separators = _mm_set1_epi8(separator);
+			const __m128i lf = _mm_set1_epi8('\n');
+			const __m128i cr = _mm_set1_epi8('\r');
+
+			// 16 バイトずつまとめて比較する
+			while (16 <= (end - p))
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, separators), _mm_cmpeq_epi8(v, lf)), _mm_cmpeq_epi8(v, cr));
+
+				if (const uint32 mask = static_cast<uint32>(_mm_movemask_epi8(hits)))
+				{
+					return (p + std::countr_zero(mask));
+				}
+
+				p += 16;
+			}
+
+			while ((p < end) && (*p != separator) && (*p != '\n') && (*p != '\r'))
+			{
+				++p;
+			}
+
+			return p;
+		}
+
+		[[nodiscard]]
+		inline constexpr std::string_view TrimCSVSpaces(std::string_view s) noexcept
+		{
+			while ((not s.empty()) && ((s.front() == ' ') || (s.front() == '\t')))
+			{
+				s.remove_prefix(1);
+			}
+
+			while ((not s.empty()) && ((s.back() == ' ') || (s.back() == '\t')))
+			{
+				s.remove_suffix(1);
+			}
+
+			return s;
+		}
+
+		template <class Type>
+		[[nodiscard]]
+		inline Optional<Type> ParseCSVNumber(std::string_view s) noexcept
+		{
+			s = TrimCSVSpaces(s);
+
+			if ((not s.empty()) && (s.front() == '+'))
+			{
+				s.remove_prefix(1);
+
+				if ((not s.empty()) && (s.front() == '-'))
+				{
+					return none;
+				}
+			}
+
+			if (s.empty())
+			{
+				return none;
+			}
+
+			Type value{};
+			const auto [ptr, ec] = std::from_chars(s.data(), (s.data() + s.size()), value);
+
+			if ((ec != std::errc{}) || (ptr != (s.data() + s.size())))
+			{
+				return none;
+			}
+
+			return value;
+		}
+
+		[[nodiscard]]
+		inline Optional<bool> ParseCSVBool(std::string_view s) noexcept
+		{
+			s = TrimCSVSpaces(s);
+
+			const auto equals = [s](const std::string_view lower)
+				{
+					return std::equal(s.begin(), s.end(), lower.begin(), lower.end(), [](const char a, const char b)
+						{
+							return ((('A' <= a) && (a <= 'Z')) ? static_cast<char>(a + ('a' - 'A')) : a) == b;
+						});
+				};
+
+			if (equals("true"))
+			{
+				return true;
+			}
+			else if (equals("false"))
+			{
+				return false;
+			}
+
+			return none;
+		}
+	}
+
+	inline size_t CSVReader::Row::size() const noexcept
+	{
+		return m_fields.size();
+	}
+
+	inline bool CSVReader::Row::isEmpty() const noexcept
+	{
+		return m_fields.empty();
+	}
+
+	inline std::string_view CSVReader::Row::operator [](const size_t column) const noexcept
+	{
+		return m_fields[column].text;
+	}
+
+	template <class Type>
+	inline Type CSVReader::Row::get(const size_t column) const
+	{
+		if (const auto opt = getOpt<Type>(column))
+		{
+			return opt.value();
+		}
+
+		return Type();
+	}
+
+	template <class Type, class U>
+	inline Type CSVReader::Row::getOr(const size_t column, U&& defaultValue) const
+	{
+		return getOpt<Type>(column).value_or(std::forward<U>(defaultValue));
+	}
+
+	template <class Type>
+	inline Optional<Type> CSVReader::Row::getOpt(const size_t column) const
+	{
+		if (m_fields.size() <= column)
+		{
+			return none;
+		}
+
+		const Field& field = m_fields[column];
+
+		if constexpr (std::is_same_v<Type, bool>)
+		{
+			return detail::ParseCSVBool(field.text);
+		}
+		else if constexpr (std::is_integral_v<Type> || std::is_floating_point_v<Type>)
+		{
+			return detail::ParseCSVNumber<Type>(field.text);
+		}
+		else if constexpr (std::is_same_v<Type, std::string>)
+		{
+			return unescape(field);
+		}
+		else if constexpr (std::is_same_v<Type, String>)
+		{
+			return (field.escaped ? Unicode::FromUTF8(unescape(field)) : Unicode::FromUTF8(field.text));
+		}
+		else
+		{
+			return ParseOpt<Type>(field.escaped ? Unicode::FromUTF8(unescape(field)) : Unicode::FromUTF8(field.text));
+		}
+	}
+
+	inline std::string CSVReader::Row::unescape(const Field& field) const
+	{
+		if (not field.escaped)
+		{
+			return std::string(field.text);
+		}
+
+		std::string result;
+		result.reserve(field.text.size());
+
+		for (size_t i = 0; i < field.text.size(); ++i)
+		{
+			result.push_back(field.text[i]);
+
+			// 2 つ続いた引用符は 1 つにする
+			if ((field.text[i] == m_quote) && ((i + 1) < field.text.size()) && (field.text[i + 1] == m_quote))
+			{
+				++i;
+			}
+		}
+
+		return result;
+	}
+
+	inline CSVReader::CSVReader(const FilePathView path, const char separator, const char quote)
+	{
+		open(path, separator, quote);
+	}
+
+	template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>*>
+	inline CSVReader::CSVReader(Reader&& reader, const char separator, const char quote)
+	{
+		open(std::make_unique<Reader>(std::move(reader)), separator, quote);
+	}
+
+	inline CSVReader::CSVReader(std::unique_ptr<IReader>&& reader, const char separator, const char quote)
+	{
+		open(std::move(reader), separator, quote);
+	}
+
+	inline bool CSVReader::open(const FilePathView path, const char separator, const char quote)
+	{
+		close();
+
+		auto storage = std::make_shared<Storage>();
+
+		if (not storage->file.open(path, MapAll::Yes))
+		{
+			return false;
+		}
+
+		const char* data = reinterpret_cast<const char*>(storage->file.data());
+		const size_t size = storage->file.mappedSize();
+
+		reset(std::move(storage), data, (data + size), separator, quote);
+
+		return true;
+	}
+
+	template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>*>
+	inline bool CSVReader::open(Reader&& reader, const char separator, const char quote)
+	{
+		return open(std::make_unique<Reader>(std::move(reader)), separator, quote);
+	}
+
+	inline bool CSVReader::open(std::unique_ptr<IReader>&& reader, const char separator, const char quote)
+	{
+		close();
+
+		if ((not reader) || (not reader->isOpen()))
+		{
+			return false;
+		}
+
+		auto storage = std::make_shared<Storage>();
+		storage->buffer.resize(static_cast<size_t>(Max<int64>((reader->size() - reader->getPos()), 0)));
+		storage->buffer.resize(static_cast<size_t>(Max<int64>(reader->read(storage->buffer.data(), static_cast<int64>(storage->buffer.size())), 0)));
+
+		const char* data = storage->buffer.data();
+		const size_t size = storage->buffer.size();
+
+		reset(std::move(storage), data, (data + size), separator, quote);
+
+		return true;
+	}
+
+	inline void CSVReader::close()
+	{
+		m_storage.reset();
+		m_begin = m_end = m_pos = nullptr;
+	}
+
+	inline bool CSVReader::isOpen() const noexcept
+	{
+		return static_cast<bool>(m_storage);
+	}
+
+	inline CSVReader::operator bool() const noexcept
+	{
+		return isOpen();
+	}
+
+	inline size_t CSVReader::size() const noexcept
+	{
+		return static_cast<size_t>(m_end - m_begin);
+	}
+
+	inline bool CSVReader::readRow(Row& row)
+	{
+		row.m_fields.clear();
+		row.m_quote = m_quote;
+
+		if (m_end <= m_pos)
+		{
+			return false;
+		}
+
+		const char* p = m_pos;
+
+		// 空行
+		if ((*p == '\n') || (*p == '\r'))
+		{
+			p += (((*p == '\r') && ((p + 1) < m_end) && (p[1] == '\n')) ? 2 : 1);
+			m_pos = p;
+			return true;
+		}
+
+		for (;;)
+		{
+			if ((p < m_end) && (*p == m_quote))
+			{
+				// 引用符で囲まれた列は、対になる引用符まで読む（改行や区切り文字を含むことがある）
+				const char* const first = ++p;
+				bool escaped = false;
+
+				for (;;)
+				{
+					p = static_cast<const char*>(std::memchr(p, m_quote, (m_end - p)));
+
+					if (p == nullptr)
+					{
+						p = m_end;
+						break;
+					}
+
+					if (((p + 1) < m_end) && (p[1] == m_quote))
+					{
+						escaped = true;
+						p += 2;
+						continue;
+					}
+
+					break;
+				}
+
+				row.m_fields.push_back(Row::Field{ std::string_view(first, (p - first)), escaped });
+
+				// 閉じる引用符の後ろから区切り文字までは無視する
+				p = detail::FindCSVDelimiter(Min((p + 1), m_end), m_end, m_separator);
+			}
+			else
+			{
+				const char* const first = p;
+				p = detail::FindCSVDelimiter(p, m_end, m_separator);
+				row.m_fields.push_back(Row::Field{ std::string_view(first, (p - first)), false });
+			}
+
+			if (p == m_end)
+			{
+				break;
+			}
+
+			if (*p == m_separator)
+			{
+				++p;
+				continue;
+			}
+
+			// 改行
+			p += (((*p == '\r') && ((p + 1) < m_end) && (p[1] == '\n')) ? 2 : 1);
+			break;
+		}
+
+		m_pos = p;
+
+		return true;
+	}
+
+	inline void CSVReader::rewind() noexcept
+	{
+		m_pos = m_begin;
+	}
+
+	inline Array<CSVReader> CSVReader::split(size_t count) const
+	{
+		Array<CSVReader> parts;
+
+		if ((not isOpen()) || (count == 0))
+		{
+			return parts;
+		}
+
+		const size_t total = static_cast<size_t>(m_end - m_pos);
+		count = Max<size_t>(Min(count, total), 1);
+
+		// 均等な位置を候補とし、各範囲の引用符の数から、候補の位置が引用符の内側かを調べる
+		Array<const char*> candidates(count + 1);
+
+		for (size_t i = 0; i <= count; ++i)
+		{
+			candidates[i] = (m_pos + (total * i / count));
+		}
+
+		Array<size_t> quoteCounts(count);
+
+		const auto countQuotes = [&](const size_t first, const size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					quoteCounts[i] = static_cast<size_t>(std::count(candidates[i], candidates[i + 1], m_quote));
+				}
+			};
+
+	# ifndef SIV3D_NO_CONCURRENT_API
+
+		ThreadPool::Global().parallelFor(0, count, countQuotes);
+
+	# else
+
+		countQuotes(0, count);
+
+	# endif
+
+		const auto makePart = [this](const char* begin, const char* end)
+			{
+				CSVReader part;
+				part.reset(m_storage, begin, end, m_separator, m_quote);
+				return part;
+			};
+
+		const char* partBegin = m_pos;
+		size_t quotesBefore = 0;
+
+		for (size_t i = 1; i < count; ++i)
+		{
+			quotesBefore += quoteCounts[i - 1];
+
+			// 前の区切りを探すときに、この候補を通り過ぎた
+			if (candidates[i] < partBegin)
+			{
+				continue;
+			}
+
+			// 候補の位置から、引用符の外側にある最初の改行の直後を区切りにする
+			const char* p = candidates[i];
+			bool inQuotes = ((quotesBefore % 2) == 1);
+
+			for (; p < m_end; ++p)
+			{
+				if (*p == m_quote)
+				{
+					inQuotes = (not inQuotes);
+				}
+				else if ((*p == '\n') && (not inQuotes))
+				{
+					++p;
+					break;
+				}
+			}
+
+			if (m_end <= p)
+			{
+				break;
+			}
+
+			parts.push_back(makePart(partBegin, p));
+			partBegin = p;
+		}
+
+		parts.push_back(makePart(partBegin, m_end));
+
+		return parts;
+	}
+
+	inline void CSVReader::reset(std::shared_ptr<const Storage> storage, const char* begin, const char* end, const char separator, const char quote)
+	{
+		// UTF-8 の BOM を読み飛ばす
+		if ((3 <= (end - begin)) && (static_cast<uint8>(begin[0]) == 0xEF) && (static_cast<uint8>(begin[1]) == 0xBB) && (static_cast<uint8>(begin[2]) == 0xBF))
+		{
+			begin += 3;
+		}
+
+		m_storage = std::move(storage);
+		m_begin = m_pos = begin;
+		m_end = end;
+		m_separator = separator;
+		m_quote = quote;
+	}
+}
@@ -0,0 +1,641 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <algorithm>
+# include <cstring>
+
+namespace s3d
+{
+	namespace detail
+	{
+		// Zstandard seekable 形式のシークテーブルは、スキップ可能フレームとして書き出す
+		inline constexpr uint32 ZstdSkippableFrameMagic = 0x184D2A5E;
+
+		inline constexpr uint32 ZstdSeekableMagic = 0x8F92EAB1;
+
+		inline constexpr int64 ZstdSkippableHeaderSize = 8;
+
+		inline constexpr int64 ZstdSeekTableFooterSize = 9;
+
+		// シークテーブルの各値は 32 ビットのため、フレームの大きさを制限する
+		inline constexpr size_t MaxCompressionFrameSize = (size_t{ 1 } << 30);
+
+		[[nodiscard]]
+		inline uint32 LoadLE32(const uint8* p) noexcept
+		{
+			return (static_cast<uint32>(p[0]) | (static_cast<uint32>(p[1]) << 8)
+				| (static_cast<uint32>(p[2]) << 16) | (static_cast<uint32>(p[3]) << 24));
+		}
+
+		inline void StoreLE32(uint8* p, const uint32 value) noexcept
+		{
+			p[0] = static_cast<uint8>(value);
+			p[1] = static_cast<uint8>(value >> 8);
+			p[2] = static_cast<uint8>(value >> 16);
+			p[3] = static_cast<uint8>(value >> 24);
+		}
+
+		/// @brief [0, count) の範囲を、count が 2 以上の場合はスレッドプールで処理します。
+		template <class Fty>
+		inline void ForEachCompressionFrame(const size_t count, Fty f)
+		{
+		# ifndef SIV3D_NO_CONCURRENT_API
+
+			if (1 < count)
+			{
+				ThreadPool::Global().parallelFor(0, count, f);
+				return;
+			}
+
+		# endif
+
+			f(0, count);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////
+	//
+	//	CompressionWriter
+	//
+	////////////////////////////////////////////////////////////////
+
+	inline CompressionWriter::CompressionWriter(IWriter& writer, const int32 compressionLevel, const size_t frameSize, const size_t concurrency)
+	{
+		open(writer, compressionLevel, frameSize, concurrency);
+	}
+
+	inline CompressionWriter::~CompressionWriter()
+	{
+		if (m_writer)
+		{
+			finish();
+		}
+	}
+
+	inline bool CompressionWriter::open(IWriter& writer, const int32 compressionLevel, size_t frameSize, size_t concurrency)
+	{
+		if (m_writer)
+		{
+			finish();
+		}
+
+		if (not writer.isOpen())
+		{
+			return false;
+		}
+
+		frameSize = Clamp<size_t>(frameSize, 1, detail::MaxCompressionFrameSize);
+
+	# ifdef SIV3D_NO_CONCURRENT_API
+
+		concurrency = 1;
+
+	# endif
+
+		concurrency = Max<size_t>(concurrency, 1);
+
+		m_writer = &writer;
+		m_compressionLevel = compressionLevel;
+		m_frameSize = frameSize;
+		m_input.resize(frameSize * concurrency);
+		m_inputSize = 0;
+		m_frames.resize(concurrency);
+		m_succeeded.resize(concurrency);
+		m_seekTable.clear();
+		m_uncompressedSize = 0;
+		m_failed = false;
+
+		return true;
+	}
+
+	inline bool CompressionWriter::isOpen() const noexcept
+	{
+		return (m_writer != nullptr);
+	}
+
+	inline CompressionWriter::operator bool() const noexcept
+	{
+		return isOpen();
+	}
+
+	inline bool CompressionWriter::write(const void* src, size_t sizeBytes)
+	{
+		if (not m_writer)
+		{
+			return false;
+		}
+
+		const Byte* p = static_cast<const Byte*>(src);
+
+		while (sizeBytes)
+		{
+			const size_t n = Min(sizeBytes, (m_input.size() - m_inputSize));
+			std::memcpy((m_input.data() + m_inputSize), p, n);
+			m_inputSize += n;
+			m_uncompressedSize += n;
+			p += n;
+			sizeBytes -= n;
+
+			if (m_inputSize == m_input.size())
+			{
+				flushFrames();
+			}
+		}
+
+		return (not m_failed);
+	}
+
+	inline bool CompressionWriter::write(IReader& reader)
+	{
+		if (not m_writer)
+		{
+			return false;
+		}
+
+		// Reader から入力バッファに直接読み込む
+		for (;;)
+		{
+			const int64 readSize = reader.read((m_input.data() + m_inputSize), static_cast<int64>(m_input.size() - m_inputSize));
+
+			if (readSize <= 0)
+			{
+				break;
+			}
+
+			m_inputSize += static_cast<size_t>(readSize);
+			m_uncompressedSize += static_cast<size_t>(readSize);
+
+			if (m_inputSize == m_input.size())
+			{
+				flushFrames();
+			}
+		}
+
+		return (not m_failed);
+	}
+
+	inline bool CompressionWriter::finish()
+	{
+		if (not m_writer)
+		{
+			return false;
+		}
+
+		flushFrames();
+
+		// スキップ可能フレームのヘッダ、フレームごとの圧縮後と圧縮前の大きさ、フッタ（すべてリトルエンディアン）
+		const size_t frameCount = (m_seekTable.size() / 2);
+		const int64 tableSize = static_cast<int64>(m_seekTable.size() * sizeof(uint32) + detail::ZstdSeekTableFooterSize);
+		Array<uint8> table(static_cast<size_t>(detail::ZstdSkippableHeaderSize + tableSize));
+		uint8* p = table.data();
+
+		detail::StoreLE32(p, detail::ZstdSkippableFrameMagic);
+		detail::StoreLE32((p + 4), static_cast<uint32>(tableSize));
+		p += detail::ZstdSkippableHeaderSize;
+
+		for (const uint32 value : m_seekTable)
+		{
+			detail::StoreLE32(p, value);
+			p += 4;
+		}
+
+		detail::StoreLE32(p, static_cast<uint32>(frameCount));
+		p[4] = 0; // チェックサムなし
+		detail::StoreLE32((p + 5), detail::ZstdSeekableMagic);
+
+		if (m_writer->write(table.data(), static_cast<int64>(table.size())) != static_cast<int64>(table.size()))
+		{
+			m_failed = true;
+		}
+
+		const bool result = (not m_failed);
+
+		m_writer = nullptr;
+		m_input = Array<Byte>{};
+		m_inputSize = 0;
+		m_frames.clear();
+		m_succeeded.clear();
+		m_seekTable.clear();
+
+		return result;
+	}
+
+	inline uint64 CompressionWriter::uncompressedSize() const noexcept
+	{
+		return m_uncompressedSize;
+	}
+
+	inline bool CompressionWriter::flushFrames()
+	{
+		if (m_inputSize == 0)
+		{
+			return (not m_failed);
+		}
+
+		const size_t frameCount = ((m_inputSize + m_frameSize - 1) / m_frameSize);
+
+		// フレームは互いに独立しているので、並列に圧縮できる
+		detail::ForEachCompressionFrame(frameCount, [&](const size_t first, const size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					const size_t offset = (i * m_frameSize);
+					const size_t size = Min(m_frameSize, (m_inputSize - offset));
+					m_succeeded[i] = Compression::Compress((m_input.data() + offset), size, m_frames[i], m_compressionLevel);
+				}
+			});
+
+		for (size_t i = 0; i < frameCount; ++i)
+		{
+			const Blob& frame = m_frames[i];
+
+			if ((not m_succeeded[i])
+				|| (0xFFFFFFFF < frame.size())
+				|| (m_writer->write(frame.data(), static_cast<int64>(frame.size())) != static_cast<int64>(frame.size())))
+			{
+				m_failed = true;
+				break;
+			}
+
+			m_seekTable.push_back(static_cast<uint32>(frame.size()));
+			m_seekTable.push_back(static_cast<uint32>(Min(m_frameSize, (m_inputSize - i * m_frameSize))));
+		}
+
+		m_inputSize = 0;
+
+		return (not m_failed);
+	}
+
+	////////////////////////////////////////////////////////////////
+	//
+	//	CompressionReader
+	//
+	////////////////////////////////////////////////////////////////
+
+	inline CompressionReader::CompressionReader(const FilePathView path)
+	{
+		open(path);
+	}
+
+	template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>*>
+	inline CompressionReader::CompressionReader(Reader&& reader)
+	{
+		open(std::make_unique<Reader>(std::move(reader)));
+	}
+
+	inline CompressionReader::CompressionReader(std::unique_ptr<IReader>&& reader)
+	{
+		open(std::move(reader));
+	}
+
+	inline bool CompressionReader::open(const FilePathView path)
+	{
+		return open(std::make_unique<BinaryReader>(path));
+	}
+
+	template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>*>
+	inline bool CompressionReader::open(Reader&& reader)
+	{
+		return open(std::make_unique<Reader>(std::move(reader)));
+	}
+
+	inline bool CompressionReader::open(std::unique_ptr<IReader>&& reader)
+	{
+		close();
+
+		if ((not reader) || (not reader->isOpen()))
+		{
+			return false;
+		}
+
+		const int64 fileSize = reader->size();
+
+		if (fileSize < (detail::ZstdSkippableHeaderSize + detail::ZstdSeekTableFooterSize))
+		{
+			return false;
+		}
+
+		uint8 footer[detail::ZstdSeekTableFooterSize];
+
+		if (reader->read(footer, (fileSize - detail::ZstdSeekTableFooterSize), detail::ZstdSeekTableFooterSize) != detail::ZstdSeekTableFooterSize)
+		{
+			return false;
+		}
+
+		const uint32 frameCount = detail::LoadLE32(footer);
+		const uint8 descriptor = footer[4];
+
+		// 予約ビットが 0 でなければ未知の形式
+		if ((detail::LoadLE32(footer + 5) != detail::ZstdSeekableMagic) || (descriptor & 0x7F))
+		{
+			return false;
+		}
+
+		// チェックサムがある場合は読み飛ばす
+		const int64 entrySize = ((descriptor & 0x80) ? 12 : 8);
+		const int64 tableSize = (frameCount * entrySize + detail::ZstdSeekTableFooterSize);
+		const int64 tableOffset = (fileSize - tableSize - detail::ZstdSkippableHeaderSize);
+
+		if (tableOffset < 0)
+		{
+			return false;
+		}
+
+		Array<uint8> table(static_cast<size_t>(detail::ZstdSkippableHeaderSize + tableSize - detail::ZstdSeekTableFooterSize));
+
+		if ((reader->read(table.data(), tableOffset, static_cast<int64>(table.size())) != static_cast<int64>(table.size()))
+			|| (detail::LoadLE32(table.data()) != detail::ZstdSkippableFrameMagic)
+			|| (detail::LoadLE32(table.data() + 4) != static_cast<uint32>(tableSize)))
+		{
+			return false;
+		}
+
+		m_frames.resize(frameCount);
+		int64 compressedOffset = 0;
+		int64 offset = 0;
+
+		for (size_t i = 0; i < frameCount; ++i)
+		{
+			const uint8* entry = (table.data() + detail::ZstdSkippableHeaderSize + (i * entrySize));
+			Frame& frame = m_frames[i];
+			frame.compressedOffset = compressedOffset;
+			frame.offset = offset;
+			frame.compressedSize = detail::LoadLE32(entry);
+			frame.size = detail::LoadLE32(entry + 4);
+			compressedOffset += frame.compressedSize;
+			offset += frame.size;
+		}
+
+		// フレームはシークテーブルの直前まで隙間なく並んでいる
+		if (compressedOffset != tableOffset)
+		{
+			m_frames.clear();
+			return false;
+		}
+
+		m_reader = std::move(reader);
+		m_size = offset;
+
+		return true;
+	}
+
+	inline void CompressionReader::close()
+	{
+		m_reader.reset();
+		m_frames.clear();
+		m_size = 0;
+		m_pos = 0;
+		m_hasCache = false;
+		m_compressed.release();
+		m_cache.release();
+	}
+
+	inline bool CompressionReader::supportsLookahead() const noexcept
+	{
+		return true;
+	}
+
+	inline bool CompressionReader::isOpen() const noexcept
+	{
+		return static_cast<bool>(m_reader);
+	}
+
+	inline CompressionReader::operator bool() const noexcept
+	{
+		return isOpen();
+	}
+
+	inline int64 CompressionReader::size() const
+	{
+		return m_size;
+	}
+
+	inline int64 CompressionReader::getPos() const
+	{
+		return m_pos;
+	}
+
+	inline bool CompressionReader::setPos(const int64 pos)
+	{
+		if (not InRange<int64>(pos, 0, m_size))
+		{
+			return false;
+		}
+
+		m_pos = pos;
+
+		return true;
+	}
+
+	inline int64 CompressionReader::skip(const int64 offset)
+	{
+		m_pos = Clamp<int64>((m_pos + offset), 0, m_size);
+
+		return m_pos;
+	}
+
+	inline int64 CompressionReader::read(void* dst, const int64 size)
+	{
+		const int64 readSize = readAt(dst, m_pos, size);
+		m_pos += readSize;
+
+		return readSize;
+	}
+
+	inline int64 CompressionReader::read(void* dst, const int64 pos, const int64 size)
+	{
+		const int64 readSize = readAt(dst, pos, size);
+		m_pos = (pos + readSize);
+
+		return readSize;
+	}
+
+	SIV3D_CONCEPT_TRIVIALLY_COPYABLE_
+	inline bool CompressionReader::read(TriviallyCopyable& dst)
+	{
+		return read(std::addressof(dst), sizeof(TriviallyCopyable)) == sizeof(TriviallyCopyable);
+	}
+
+	inline int64 CompressionReader::lookahead(void* dst, const int64 size) const
+	{
+		return readAt(dst, m_pos, size);
+	}
+
+	inline int64 CompressionReader::lookahead(void* dst, const int64 pos, const int64 size) const
+	{
+		return readAt(dst, pos, size);
+	}
+
+	SIV3D_CONCEPT_TRIVIALLY_COPYABLE_
+	inline bool CompressionReader::lookahead(TriviallyCopyable& dst) const
+	{
+		return lookahead(std::addressof(dst), sizeof(TriviallyCopyable)) == sizeof(TriviallyCopyable);
+	}
+
+	inline size_t CompressionReader::frameCount() const noexcept
+	{
+		return m_frames.size();
+	}
+
+	inline bool CompressionReader::readAll(IWriter& writer, size_t concurrency)
+	{
+		if (not isOpen())
+		{
+			return false;
+		}
+
+	# ifdef SIV3D_NO_CONCURRENT_API
+
+		concurrency = 1;
+
+	# endif
+
+		concurrency = Max<size_t>(concurrency, 1);
+
+		if (m_size <= m_pos)
+		{
+			return true;
+		}
+
+		size_t index = findFrame(m_pos);
+
+		// フレームの途中から読み込む場合は、そのフレームの残りを先に書き出す
+		if (m_frames[index].offset < m_pos)
+		{
+			const Frame& frame = m_frames[index];
+			const int64 offset = (m_pos - frame.offset);
+
+			if ((not loadFrame(index))
+				|| (writer.write((m_cache.data() + offset), (frame.size - offset)) != (frame.size - offset)))
+			{
+				return false;
+			}
+
+			m_pos = (frame.offset + frame.size);
+			++index;
+		}
+
+		// 圧縮されたフレームを順に読み込み、concurrency 個ずつ並列に伸張する
+		Array<Blob> compressed(concurrency);
+		Array<Blob> frames(concurrency);
+		Array<uint8> succeeded(concurrency);
+
+		while (index < m_frames.size())
+		{
+			const size_t count = Min(concurrency, (m_frames.size() - index));
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (not readCompressedFrame((index + i), compressed[i]))
+				{
+					return false;
+				}
+			}
+
+			detail::ForEachCompressionFrame(count, [&](const size_t first, const size_t last)
+				{
+					for (size_t i = first; i < last; ++i)
+					{
+						const Frame& frame = m_frames[index + i];
+						succeeded[i] = (Compression::Decompress(compressed[i].data(), frame.compressedSize, frames[i])
+							&& (frames[i].size() == frame.size));
+					}
+				});
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const Frame& frame = m_frames[index + i];
+
+				if ((not succeeded[i])
+					|| (writer.write(frames[i].data(), frame.size) != frame.size))
+				{
+					return false;
+				}
+
+				m_pos = (frame.offset + frame.size);
+			}
+
+			index += count;
+		}
+
+		return true;
+	}
+
+	inline size_t CompressionReader::findFrame(const int64 pos) const noexcept
+	{
+		const auto it = std::upper_bound(m_frames.begin(), m_frames.end(), pos,
+			[](const int64 p, const Frame& frame) { return (p < frame.offset); });
+
+		return static_cast<size_t>((it - m_frames.begin()) - 1);
+	}
+
+	inline bool CompressionReader::readCompressedFrame(const size_t index, Blob& dst) const
+	{
+		const Frame& frame = m_frames[index];
+
+		// 大きくなるときだけ確保し直す
+		if (dst.size() < frame.compressedSize)
+		{
+			dst.resize(frame.compressedSize);
+		}
+
+		return (m_reader->read(dst.data(), frame.compressedOffset, frame.compressedSize) == frame.compressedSize);
+	}
+
+	inline bool CompressionReader::loadFrame(const size_t index) const
+	{
+		if (m_hasCache && (m_cachedFrame == index))
+		{
+			return true;
+		}
+
+		const Frame& frame = m_frames[index];
+		m_hasCache = (readCompressedFrame(index, m_compressed)
+			&& Compression::Decompress(m_compressed.data(), frame.compressedSize, m_cache)
+			&& (m_cache.size() == frame.size));
+		m_cachedFrame = index;
+
+		return m_hasCache;
+	}
+
+	inline int64 CompressionReader::readAt(void* dst, const int64 pos, int64 size) const
+	{
+		if ((not isOpen()) || (not InRange<int64>(pos, 0, m_size)))
+		{
+			return 0;
+		}
+
+		size = Min(size, (m_size - pos));
+
+		Byte* out = static_cast<Byte*>(dst);
+		size_t index = findFrame(pos);
+		int64 done = 0;
+
+		while (done < size)
+		{
+			const Frame& frame = m_frames[index];
+
+			if (not loadFrame(index))
+			{
+				break;
+			}
+
+			const int64 offset = ((pos + done) - frame.offset);
+			const int64 n = Min<int64>((frame.size - offset), (size - done));
+			std::memcpy((out + done), (m_cache.data() + offset), static_cast<size_t>(n));
+			done += n;
+			++index;
+		}
+
+		return done;
+	}
+}
@@ -117,6 +117,228 @@ namespace s3d
 		{
 			return (p1.x - p3.x) * (p2.y - p3.y) - (p2.x - p3.x) * (p1.y - p3.y);
 		}
+
+		/// @brief IntersectMany で、4 つの図形をまとめて判定します。
+		/// @param p 図形の配列の先頭
+		/// @param count 判定する図形の数（1 以上 4 以下）
+		/// @param kernel 2 つの図形を判定し、結果を下位 2 ビットのマスクで返す関数
+		/// @return 判定結果のマスク
+		template <class Type, class Kernel>
+		[[nodiscard]]
+		inline uint32 IntersectMany4(const Type* p, const size_t count, const Kernel& kernel) noexcept
+		{
+			if (count == 4)
+			{
+				return (kernel(p) | (kernel(p + 2) << 2));
+			}
+
+			// 端数は最後の図形で埋めて同じ kernel で判定し、配列内の位置によって結果が変わらないようにする
+			Type padded[4];
+
+			for (size_t i = 0; i < 4; ++i)
+			{
+				padded[i] = p[Min(i, (count - 1))];
+			}
+
+			return ((kernel(padded) | (kernel(padded + 2) << 2)) & ((1u << count) - 1));
+		}
+
+		/// @brief 4 ビットのマスクを 4 つの bool に展開した値
+		inline constexpr std::array<uint32, 16> IntersectManyBools = []()
+		{
+			std::array<uint32, 16> table{};
+
+			for (uint32 bits = 0; bits < 16; ++bits)
+			{
+				bool values[4] = { ((bits & 1) != 0), ((bits & 2) != 0), ((bits & 4) != 0), ((bits & 8) != 0) };
+				table[bits] = std::bit_cast<uint32>(values);
+			}
+
+			return table;
+		}();
+
+		template <class Type, class Kernel>
+		inline size_t IntersectManyToBools(const std::span<const Type> b, const std::span<bool> results, const Kernel& kernel) noexcept
+		{
+			const size_t n = Min(b.size(), results.size());
+			size_t count = 0;
+
+			for (size_t i = 0; i < n; i += 4)
+			{
+				const size_t m = Min<size_t>(4, (n - i));
+				const uint32 bits = IntersectMany4((b.data() + i), m, kernel);
+
+				if (m == 4)
+				{
+					std::memcpy((results.data() + i), &IntersectManyBools[bits], 4);
+				}
+				else
+				{
+					for (size_t k = 0; k < m; ++k)
+					{
+						results[i + k] = ((bits >> k) & 1);
+					}
+				}
+
+				count += std::popcount(bits);
+			}
+
+			return count;
+		}
+
+		template <class Type, class Kernel>
+		inline size_t IntersectManyToMask(const std::span<const Type> b, const std::span<uint64> mask, const Kernel& kernel) noexcept
+		{
+			const size_t n = Min(b.size(), (mask.size() * 64));
+			size_t count = 0;
+
+			for (size_t word = 0; (word * 64) < n; ++word)
+			{
+				const size_t first = (word * 64);
+				const size_t last = Min((first + 64), n);
+				uint64 bits = 0;
+
+				for (size_t i = first; i < last; i += 4)
+				{
+					bits |= (static_cast<uint64>(IntersectMany4((b.data() + i), Min<size_t>(4, (last - i)), kernel)) << (i - first));
+				}
+
+				mask[word] = bits;
+				count += std::popcount(bits);
+			}
+
+			return count;
+		}
+
+		/// @brief 2 つの長方形 (x, y, w, h) と円の交差を判定します。`Intersect(const RectF&, const Circle&)` と同じ順序で計算します。
+		[[nodiscard]]
+		inline int CircleRectMask2(const __m128d cx, const __m128d cy, const __m128d r, const __m128d rSq, const __m128d x, const __m128d y, const __m128d w, const __m128d h) noexcept
+		{
+			const __m128d signMask = _mm_set1_pd(-0.0);
+			const __m128d half = _mm_set1_pd(0.5);
+			const __m128d aw = _mm_mul_pd(w, half);
+			const __m128d ah = _mm_mul_pd(h, half);
+			const __m128d dx = _mm_andnot_pd(signMask, _mm_sub_pd(_mm_sub_pd(cx, x), aw));
+			const __m128d dy = _mm_andnot_pd(signMask, _mm_sub_pd(_mm_sub_pd(cy, y), ah));
+
+			const __m128d outside = _mm_or_pd(_mm_cmpgt_pd(dx, _mm_add_pd(aw, r)), _mm_cmpgt_pd(dy, _mm_add_pd(ah, r)));
+			const __m128d edge = _mm_or_pd(_mm_cmple_pd(dx, aw), _mm_cmple_pd(dy, ah));
+			const __m128d ex = _mm_sub_pd(dx, aw);
+			const __m128d ey = _mm_sub_pd(dy, ah);
+			const __m128d corner = _mm_cmple_pd(_mm_add_pd(_mm_mul_pd(ex, ex), _mm_mul_pd(ey, ey)), rSq);
+
+			return _mm_movemask_pd(_mm_andnot_pd(outside, _mm_or_pd(edge, corner)));
+		}
+
+		/// @brief 2 つの長方形 (x, y, w, h) と線分の交差をスラブ法で判定します。
+		[[nodiscard]]
+		inline int LineRectMask2(const Line& line, const __m128d x, const __m128d y, const __m128d w, const __m128d h) noexcept
+		{
+			__m128d tMin = _mm_setzero_pd();
+			__m128d tMax = _mm_set1_pd(1.0);
+			__m128d inside = _mm_castsi128_pd(_mm_set1_epi32(-1));
+
+			const auto clip = [&](const double begin, const double delta, const __m128d lo, const __m128d size)
+				{
+					const __m128d hi = _mm_add_pd(lo, size);
+					const __m128d minEdge = _mm_min_pd(lo, hi);
+					const __m128d maxEdge = _mm_max_pd(lo, hi);
+					const __m128d b = _mm_set1_pd(begin);
+
+					if (delta == 0.0)
+					{
+						// 軸に平行な線分は、その軸の範囲に始点が入っていれば交差しうる
+						inside = _mm_and_pd(inside, _mm_and_pd(_mm_cmple_pd(minEdge, b), _mm_cmple_pd(b, maxEdge)));
+						return;
+					}
+
+					// 逆数を掛けると丸め誤差で辺や角にちょうど接する場合を見逃すため、除算する
+					const __m128d d = _mm_set1_pd(delta);
+					const __m128d t0 = _mm_div_pd(_mm_sub_pd(minEdge, b), d);
+					const __m128d t1 = _mm_div_pd(_mm_sub_pd(maxEdge, b), d);
+					tMin = _mm_max_pd(tMin, _mm_min_pd(t0, t1));
+					tMax = _mm_min_pd(tMax, _mm_max_pd(t0, t1));
+				};
+
+			clip(line.begin.x, (line.end.x - line.begin.x), x, w);
+			clip(line.begin.y, (line.end.y - line.begin.y), y, h);
+
+			return _mm_movemask_pd(_mm_and_pd(inside, _mm_cmple_pd(tMin, tMax)));
+		}
+
+		/// @brief 2 つの Rect を (x, y, w, h) の 2 レーンに並べ替えて読み込みます。
+		inline void LoadRects2(const Rect* p, __m128d& x, __m128d& y, __m128d& w, __m128d& h) noexcept
+		{
+			static_assert(sizeof(Rect) == (sizeof(int32) * 4));
+
+			const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+			const __m128i xy = _mm_unpacklo_epi32(r0, r1); // x0 x1 y0 y1
+			const __m128i wh = _mm_unpackhi_epi32(r0, r1); // w0 w1 h0 h1
+
+			x = _mm_cvtepi32_pd(xy);
+			y = _mm_cvtepi32_pd(_mm_unpackhi_epi64(xy, xy));
+			w = _mm_cvtepi32_pd(wh);
+			h = _mm_cvtepi32_pd(_mm_unpackhi_epi64(wh, wh));
+		}
+
+		/// @brief 2 つの RectF を (x, y, w, h) の 2 レーンに並べ替えて読み込みます。
+		inline void LoadRects2(const RectF* p, __m128d& x, __m128d& y, __m128d& w, __m128d& h) noexcept
+		{
+			static_assert(sizeof(RectF) == (sizeof(double) * 4));
+
+			const double* pData = &p->x;
+			const __m128d pos0 = _mm_loadu_pd(pData);
+			const __m128d size0 = _mm_loadu_pd(pData + 2);
+			const __m128d pos1 = _mm_loadu_pd(pData + 4);
+			const __m128d size1 = _mm_loadu_pd(pData + 6);
+
+			x = _mm_unpacklo_pd(pos0, pos1);
+			y = _mm_unpackhi_pd(pos0, pos1);
+			w = _mm_unpacklo_pd(size0, size1);
+			h = _mm_unpackhi_pd(size0, size1);
+		}
+
+		template <class RectType>
+		[[nodiscard]]
+		inline auto MakeCircleRectKernel(const Circle& a) noexcept
+		{
+			return [cx = _mm_set1_pd(a.x), cy = _mm_set1_pd(a.y), r = _mm_set1_pd(a.r), rSq = _mm_set1_pd(a.r * a.r)](const RectType* p) -> uint32
+				{
+					__m128d x, y, w, h;
+					LoadRects2(p, x, y, w, h);
+					return static_cast<uint32>(CircleRectMask2(cx, cy, r, rSq, x, y, w, h));
+				};
+		}
+
+		[[nodiscard]]
+		inline auto MakeCircleCircleKernel(const Circle& a) noexcept
+		{
+			return [ax = _mm_set1_pd(a.x), ay = _mm_set1_pd(a.y), ar = _mm_set1_pd(a.r)](const Circle* p) -> uint32
+				{
+					static_assert(sizeof(Circle) == (sizeof(double) * 3));
+
+					const __m128d c0 = _mm_loadu_pd(&p[0].x);
+					const __m128d c1 = _mm_loadu_pd(&p[1].x);
+					const __m128d dx = _mm_sub_pd(ax, _mm_unpacklo_pd(c0, c1));
+					const __m128d dy = _mm_sub_pd(ay, _mm_unpackhi_pd(c0, c1));
+					const __m128d r = _mm_add_pd(ar, _mm_loadh_pd(_mm_load_sd(&p[0].r), &p[1].r));
+
+					return static_cast<uint32>(_mm_movemask_pd(_mm_cmple_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(r, r))));
+				};
+		}
+
+		template <class RectType>
+		[[nodiscard]]
+		inline auto MakeLineRectKernel(const Line& a) noexcept
+		{
+			return [a](const RectType* p) -> uint32
+				{
+					__m128d x, y, w, h;
+					LoadRects2(p, x, y, w, h);
+					return static_cast<uint32>(LineRectMask2(a, x, y, w, h));
+				};
+		}
 	}
 
 	namespace Geometry2D
@@ -1860,5 +2082,202 @@ namespace s3d
 		{
 			return SmallestEnclosingCircle(std::move(points), tolerance, std::forward<URBG>(urbg));
 		}
+
+		//////////////////////////////////////////////////
+		//
+		//	SweepCircle
+		//
+		//////////////////////////////////////////////////
+
+		inline Optional<SweepHit> SweepCircle(const Circle& a, const Vec2& velocity, const Rect& b) noexcept
+		{
+			return SweepCircle(a, velocity, RectF{ b });
+		}
+
+		inline Optional<SweepHit> SweepCircle(const Circle& a, const Vec2& velocity, const RectF& b) noexcept
+		{
+			const auto [left, right, top, bottom] = detail::GetLRTB(b);
+			const Vec2 center = a.center;
+			const double r = a.r;
+
+			// 既に接しているか重なっている場合
+			{
+				const Vec2 closest{ Clamp(center.x, left, right), Clamp(center.y, top, bottom) };
+				const Vec2 offset = (center - closest);
+				const double distanceSq = offset.lengthSq();
+
+				if (distanceSq <= (r * r))
+				{
+					Vec2 normal;
+
+					if (distanceSq != 0.0)
+					{
+						normal = (offset / std::sqrt(distanceSq));
+					}
+					else
+					{
+						// 中心が長方形の内部にある場合は、最も近い辺から押し出す
+						const double dl = (center.x - left), dr = (right - center.x);
+						const double dt = (center.y - top), db = (bottom - center.y);
+						const double dx = Min(dl, dr), dy = Min(dt, db);
+
+						if (dx < dy)
+						{
+							normal = ((dl < dr) ? Vec2{ -1, 0 } : Vec2{ 1, 0 });
+						}
+						else
+						{
+							normal = ((dt < db) ? Vec2{ 0, -1 } : Vec2{ 0, 1 });
+						}
+					}
+
+					if (velocity.dot(normal) < 0.0)
+					{
+						return SweepHit{ 0.0, normal, closest };
+					}
+
+					// 離れる方向、または表面に沿った移動
+					return none;
+				}
+			}
+
+			// 中心の軌跡と、長方形を半径 r だけ広げた AABB との交差（スラブ法）
+			double tEnter = 0.0;
+			double tExit = 1.0;
+
+			for (const auto& [p, v, lo, hi] : { std::tuple{ center.x, velocity.x, (left - r), (right + r) },
+				std::tuple{ center.y, velocity.y, (top - r), (bottom + r) } })
+			{
+				if (v == 0.0)
+				{
+					if ((p < lo) || (hi < p))
+					{
+						return none;
+					}
+
+					continue;
+				}
+
+				double t0 = ((lo - p) / v);
+				double t1 = ((hi - p) / v);
+
+				if (t1 < t0)
+				{
+					std::swap(t0, t1);
+				}
+
+				tEnter = Max(tEnter, t0);
+				tExit = Min(tExit, t1);
+
+				if (tExit < tEnter)
+				{
+					return none;
+				}
+			}
+
+			const Vec2 p = (center + velocity * tEnter);
+			const bool outsideX = ((p.x < left) || (right < p.x));
+			const bool outsideY = ((p.y < top) || (bottom < p.y));
+
+			// 辺に接触
+			if (not (outsideX && outsideY))
+			{
+				Vec2 normal;
+
+				if (outsideX)
+				{
+					normal = ((p.x < left) ? Vec2{ -1, 0 } : Vec2{ 1, 0 });
+				}
+				else
+				{
+					normal = ((p.y < top) ? Vec2{ 0, -1 } : Vec2{ 0, 1 });
+				}
+
+				return SweepHit{ tEnter, normal, (p - normal * r) };
+			}
+
+			// 角の領域に入った場合は、角を中心とする半径 r の円との交差を調べる。
+			// 角の円に当たらなければ、長方形にも当たらない。
+			const Vec2 corner{ ((p.x < left) ? left : right), ((p.y < top) ? top : bottom) };
+			const Vec2 m = (center - corner);
+			const double qa = velocity.lengthSq();
+			const double qb = m.dot(velocity);
+			const double qc = (m.lengthSq() - (r * r));
+			const double discriminant = ((qb * qb) - (qa * qc));
+
+			if ((qa == 0.0) || (discriminant < 0.0))
+			{
+				return none;
+			}
+
+			const double t = ((-qb - std::sqrt(discriminant)) / qa);
+
+			if ((t < 0.0) || (1.0 < t))
+			{
+				return none;
+			}
+
+			const Vec2 hitCenter = (center + velocity * t);
+
+			const Vec2 normal = ((r == 0.0) ? -velocity.normalized() : ((hitCenter - corner) / r));
+
+			return SweepHit{ t, normal, corner };
+		}
+
+		//////////////////////////////////////////////////
+		//
+		//	IntersectMany
+		//
+		//////////////////////////////////////////////////
+
+		inline size_t IntersectMany(const Circle& a, const std::span<const Rect> b, const std::span<bool> results) noexcept
+		{
+			return detail::IntersectManyToBools(b, results, detail::MakeCircleRectKernel<Rect>(a));
+		}
+
+		inline size_t IntersectMany(const Circle& a, const std::span<const Rect> b, const std::span<uint64> mask) noexcept
+		{
+			return detail::IntersectManyToMask(b, mask, detail::MakeCircleRectKernel<Rect>(a));
+		}
+
+		inline size_t IntersectMany(const Circle& a, const std::span<const RectF> b, const std::span<bool> results) noexcept
+		{
+			return detail::IntersectManyToBools(b, results, detail::MakeCircleRectKernel<RectF>(a));
+		}
+
+		inline size_t IntersectMany(const Circle& a, const std::span<const RectF> b, const std::span<uint64> mask) noexcept
+		{
+			return detail::IntersectManyToMask(b, mask, detail::MakeCircleRectKernel<RectF>(a));
+		}
+
+		inline size_t IntersectMany(const Circle& a, const std::span<const Circle> b, const std::span<bool> results) noexcept
+		{
+			return detail::IntersectManyToBools(b, results, detail::MakeCircleCircleKernel(a));
+		}
+
+		inline size_t IntersectMany(const Circle& a, const std::span<const Circle> b, const std::span<uint64> mask) noexcept
+		{
+			return detail::IntersectManyToMask(b, mask, detail::MakeCircleCircleKernel(a));
+		}
+
+		inline size_t IntersectMany(const Line& a, const std::span<const Rect> b, const std::span<bool> results) noexcept
+		{
+			return detail::IntersectManyToBools(b, results, detail::MakeLineRectKernel<Rect>(a));
+		}
+
+		inline size_t IntersectMany(const Line& a, const std::span<const Rect> b, const std::span<uint64> mask) noexcept
+		{
+			return detail::IntersectManyToMask(b, mask, detail::MakeLineRectKernel<Rect>(a));
+		}
+
+		inline size_t IntersectMany(const Line& a, const std::span<const RectF> b, const std::span<bool> results) noexcept
+		{
+			return detail::IntersectManyToBools(b, results, detail::MakeLineRectKernel<RectF>(a));
+		}
+
+		inline size_t IntersectMany(const Line& a, const std::span<const RectF> b, const std::span<uint64> mask) noexcept
+		{
+			return detail::IntersectManyToMask(b, mask, detail::MakeLineRectKernel<RectF>(a));
+		}
 	}
 }
@@ -13,6 +13,65 @@
 
 namespace s3d
 {
+	template <class Type>
+	inline GridWindow<Type>::GridWindow(const Type* data, const size_t width, const size_t height, const int32 radius) noexcept
+		: m_data{ data }
+		, m_width{ static_cast<int32>(width) }
+		, m_height{ static_cast<int32>(height) }
+		, m_radius{ radius } {}
+
+	template <class Type>
+	inline const Type& GridWindow<Type>::operator ()(const int32 dx, const int32 dy) const noexcept
+	{
+		// 近傍の内側だけが、端で切り詰めずに読めることが分かっている
+		if (m_interior && (Abs(dx) <= m_radius) && (Abs(dy) <= m_radius))
+		{
+			return m_data[static_cast<size_t>(m_pos.y + dy) * m_width + (m_pos.x + dx)];
+		}
+
+		const int32 x = Clamp((m_pos.x + dx), 0, (m_width - 1));
+		const int32 y = Clamp((m_pos.y + dy), 0, (m_height - 1));
+		return m_data[static_cast<size_t>(y) * m_width + x];
+	}
+
+	template <class Type>
+	inline const Type& GridWindow<Type>::operator ()(const Point offset) const noexcept
+	{
+		return (*this)(offset.x, offset.y);
+	}
+
+	template <class Type>
+	inline const Type& GridWindow<Type>::center() const noexcept
+	{
+		return m_data[static_cast<size_t>(m_pos.y) * m_width + m_pos.x];
+	}
+
+	template <class Type>
+	inline Point GridWindow<Type>::position() const noexcept
+	{
+		return m_pos;
+	}
+
+	template <class Type>
+	inline int32 GridWindow<Type>::radius() const noexcept
+	{
+		return m_radius;
+	}
+
+	template <class Type>
+	inline bool GridWindow<Type>::isInterior() const noexcept
+	{
+		return m_interior;
+	}
+
+	template <class Type>
+	inline void GridWindow<Type>::moveTo(const Point pos) noexcept
+	{
+		m_pos = pos;
+		m_interior = ((m_radius <= pos.x) && ((pos.x + m_radius) < m_width)
+			&& (m_radius <= pos.y) && ((pos.y + m_radius) < m_height));
+	}
+
 	template <class Type, class Allocator>
 	inline Grid<Type, Allocator>::Grid(const size_type w, const size_type h)
 		: m_data(w * h)
@@ -930,6 +989,55 @@ namespace s3d
 		return *this;
 	}
 
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type&>>*>
+	inline Grid<Type, Allocator>& Grid<Type, Allocator>::each_tile(const Size tileSize, Fty f)
+	{
+		const size_t tileWidth = Max<size_t>(tileSize.x, 1);
+		const size_t tileHeight = Max<size_t>(tileSize.y, 1);
+
+		for (size_t y = 0; y < m_height; y += tileHeight)
+		{
+			for (size_t x = 0; x < m_width; x += tileWidth)
+			{
+				eachInRect(m_data.data(), x, y, Min((x + tileWidth), m_width), Min((y + tileHeight), m_height), f);
+			}
+		}
+
+		return *this;
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type>>*>
+	inline const Grid<Type, Allocator>& Grid<Type, Allocator>::each_tile(const Size tileSize, Fty f) const
+	{
+		const size_t tileWidth = Max<size_t>(tileSize.x, 1);
+		const size_t tileHeight = Max<size_t>(tileSize.y, 1);
+
+		for (size_t y = 0; y < m_height; y += tileHeight)
+		{
+			for (size_t x = 0; x < m_width; x += tileWidth)
+			{
+				eachInRect(m_data.data(), x, y, Min((x + tileWidth), m_width), Min((y + tileHeight), m_height), f);
+			}
+		}
+
+		return *this;
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, const GridWindow<Type>&>>*>
+	inline auto Grid<Type, Allocator>::stencil_map(const int32 radius, Fty f) const
+	{
+		using ResultType = std::remove_cvref_t<std::invoke_result_t<Fty&, const GridWindow<Type>&>>;
+
+		Array<ResultType> new_grid(m_width * m_height);
+
+		stencilRows(radius, 0, m_height, new_grid, f);
+
+		return Grid<ResultType>(m_width, m_height, std::move(new_grid));
+	}
+
 	template <class Type, class Allocator>
 	template <class U>
 	inline typename Grid<Type, Allocator>::value_type Grid<Type, Allocator>::fetch(const size_type y, const size_type x, U&& defaultValue) const
@@ -994,6 +1102,155 @@ namespace s3d
 		return Grid<ResultType>(m_width, m_height, std::move(new_grid));
 	}
 
+# ifndef SIV3D_NO_CONCURRENT_API
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_r_v<bool, Fty, Type>>*>
+	inline size_t Grid<Type, Allocator>::parallel_count_if(Fty f) const
+	{
+		// Array<bool> には parallel_* が無いため、インデックスの範囲で分割する
+		std::atomic<size_t> result{ 0 };
+
+		ThreadPool::Global().parallelFor(0, m_data.size(), [&](const size_t first, const size_t last)
+		{
+			const auto it = m_data.begin();
+			result.fetch_add(static_cast<size_t>(std::count_if((it + first), (it + last), f)), std::memory_order_relaxed);
+		});
+
+		return result.load(std::memory_order_relaxed);
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Type&>>*>
+	inline Grid<Type, Allocator>& Grid<Type, Allocator>::parallel_each(Fty f)
+	{
+		ThreadPool::Global().parallelFor(0, m_data.size(), [&](const size_t first, const size_t last)
+		{
+			const auto it = m_data.begin();
+			std::for_each((it + first), (it + last), f);
+		});
+
+		return *this;
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Type>>*>
+	inline const Grid<Type, Allocator>& Grid<Type, Allocator>::parallel_each(Fty f) const
+	{
+		ThreadPool::Global().parallelFor(0, m_data.size(), [&](const size_t first, const size_t last)
+		{
+			const auto it = m_data.begin();
+			std::for_each((it + first), (it + last), f);
+		});
+
+		return *this;
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type&>>*>
+	inline Grid<Type, Allocator>& Grid<Type, Allocator>::parallel_each_index(Fty f)
+	{
+		ThreadPool::Global().parallelFor(0, m_height, [&](const size_t y0, const size_t y1)
+		{
+			eachInRect(m_data.data(), 0, y0, m_width, y1, f);
+		});
+
+		return *this;
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type>>*>
+	inline const Grid<Type, Allocator>& Grid<Type, Allocator>::parallel_each_index(Fty f) const
+	{
+		ThreadPool::Global().parallelFor(0, m_height, [&](const size_t y0, const size_t y1)
+		{
+			eachInRect(m_data.data(), 0, y0, m_width, y1, f);
+		});
+
+		return *this;
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Type>>*>
+	inline auto Grid<Type, Allocator>::parallel_map(Fty f) const
+	{
+		using ResultType = std::remove_cvref_t<decltype(f(m_data[0]))>;
+
+		Array<ResultType> new_grid(m_data.size());
+
+		ThreadPool::Global().parallelFor(0, m_data.size(), [&](const size_t first, const size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				new_grid[i] = f(m_data[i]);
+			}
+		});
+
+		return Grid<ResultType>(m_width, m_height, std::move(new_grid));
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type&>>*>
+	inline Grid<Type, Allocator>& Grid<Type, Allocator>::parallel_each_tile(const Size tileSize, Fty f)
+	{
+		const size_t tileWidth = Max<size_t>(tileSize.x, 1);
+		const size_t tileHeight = Max<size_t>(tileSize.y, 1);
+		const size_t tilesX = ((m_width + tileWidth - 1) / tileWidth);
+		const size_t tilesY = ((m_height + tileHeight - 1) / tileHeight);
+
+		ThreadPool::Global().parallelFor(0, (tilesX * tilesY), [&](const size_t first, const size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				const size_t x = ((i % tilesX) * tileWidth);
+				const size_t y = ((i / tilesX) * tileHeight);
+				eachInRect(m_data.data(), x, y, Min((x + tileWidth), m_width), Min((y + tileHeight), m_height), f);
+			}
+		});
+
+		return *this;
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, Point, Type>>*>
+	inline const Grid<Type, Allocator>& Grid<Type, Allocator>::parallel_each_tile(const Size tileSize, Fty f) const
+	{
+		const size_t tileWidth = Max<size_t>(tileSize.x, 1);
+		const size_t tileHeight = Max<size_t>(tileSize.y, 1);
+		const size_t tilesX = ((m_width + tileWidth - 1) / tileWidth);
+		const size_t tilesY = ((m_height + tileHeight - 1) / tileHeight);
+
+		ThreadPool::Global().parallelFor(0, (tilesX * tilesY), [&](const size_t first, const size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				const size_t x = ((i % tilesX) * tileWidth);
+				const size_t y = ((i / tilesX) * tileHeight);
+				eachInRect(m_data.data(), x, y, Min((x + tileWidth), m_width), Min((y + tileHeight), m_height), f);
+			}
+		});
+
+		return *this;
+	}
+
+	template <class Type, class Allocator>
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty, const GridWindow<Type>&>>*>
+	inline auto Grid<Type, Allocator>::parallel_stencil_map(const int32 radius, Fty f) const
+	{
+		using ResultType = std::remove_cvref_t<std::invoke_result_t<Fty&, const GridWindow<Type>&>>;
+
+		Array<ResultType> new_grid(m_width * m_height);
+
+		ThreadPool::Global().parallelFor(0, m_height, [&](const size_t y0, const size_t y1)
+		{
+			stencilRows(radius, y0, y1, new_grid, f);
+		});
+
+		return Grid<ResultType>(m_width, m_height, std::move(new_grid));
+	}
+
+# endif
+
 	template <class Type, class Allocator>
 	template <class Fty, std::enable_if_t<std::is_invocable_r_v<bool, Fty, Type>>*>
 	inline bool Grid<Type, Allocator>::none(Fty f) const
@@ -1518,6 +1775,39 @@ namespace s3d
 		return IndexedGenerate(size.x, size.y, generator);
 	}
 
+	template <class Type, class Allocator>
+	template <class Pointer, class Fty>
+	inline void Grid<Type, Allocator>::eachInRect(const Pointer data, const size_t x0, const size_t y0, const size_t x1, const size_t y1, Fty& f) const
+	{
+		for (size_t y = y0; y < y1; ++y)
+		{
+			Pointer p = (data + (y * m_width) + x0);
+
+			for (size_t x = x0; x < x1; ++x)
+			{
+				f(Point{ x, y }, *p++);
+			}
+		}
+	}
+
+	template <class Type, class Allocator>
+	template <class Container, class Fty>
+	inline void Grid<Type, Allocator>::stencilRows(const int32 radius, const size_t y0, const size_t y1, Container& dst, Fty& f) const
+	{
+		GridWindow<Type> window{ m_data.data(), m_width, m_height, radius };
+
+		for (size_t y = y0; y < y1; ++y)
+		{
+			size_t index = (y * m_width);
+
+			for (size_t x = 0; x < m_width; ++x)
+			{
+				window.moveTo(Point{ x, y });
+				dst[index++] = f(window);
+			}
+		}
+	}
+
 	template <class Type, class Allocator>
 	inline void swap(Grid<Type, Allocator>& a, Grid<Type, Allocator>& b) noexcept
 	{
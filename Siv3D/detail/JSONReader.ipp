@@ -0,0 +1,800 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <bit>
+# include <charconv>
+# include <cstring>
+
+namespace s3d
+{
+	namespace detail
+	{
+		/// @brief 文字列の中で、引用符、バックスラッシュ、または制御文字の位置を探します。
+		/// @return 見つかった位置。見つからなかった場合は end
+		[[nodiscard]]
+		inline const char* FindJSONStringDelimiter(const char* p, const char* const end) noexcept
+		{
+			const __m128i quote = _mm_set1_epi8('"');
+			const __m128i backslash = _mm_set1_epi8('\\');
+			const __m128i control = _mm_set1_epi8(0x1F);
+
+			// 16 バイトずつまとめて比較する
+			while (16 <= (end - p))
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				const __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+					_mm_cmpeq_epi8(_mm_min_epu8(v, control), v));
+
+				if (const uint32 mask = static_cast<uint32>(_mm_movemask_epi8(hits)))
+				{
+					return (p + std::countr_zero(mask));
+				}
+
+				p += 16;
+			}
+
+			while ((p < end) && (*p != '"') && (*p != '\\') && (0x1F < static_cast<uint8>(*p)))
+			{
+				++p;
+			}
+
+			return p;
+		}
+
+		[[nodiscard]]
+		inline constexpr bool IsJSONNumberChar(const char c) noexcept
+		{
+			return ((('0' <= c) && (c <= '9')) || (c == '-') || (c == '+') || (c == '.') || (c == 'e') || (c == 'E'));
+		}
+
+		[[nodiscard]]
+		inline constexpr bool IsJSONNumber(const std::string_view s) noexcept
+		{
+			const auto isDigit = [](const char c) { return (('0' <= c) && (c <= '9')); };
+			size_t i = 0;
+
+			if ((i < s.size()) && (s[i] == '-'))
+			{
+				++i;
+			}
+
+			// 整数部は 0 か、0 以外で始まる数字の並び
+			if ((i < s.size()) && (s[i] == '0'))
+			{
+				++i;
+			}
+			else if ((i < s.size()) && isDigit(s[i]))
+			{
+				while ((i < s.size()) && isDigit(s[i]))
+				{
+					++i;
+				}
+			}
+			else
+			{
+				return false;
+			}
+
+			if ((i < s.size()) && (s[i] == '.'))
+			{
+				if ((++i == s.size()) || (not isDigit(s[i])))
+				{
+					return false;
+				}
+
+				while ((i < s.size()) && isDigit(s[i]))
+				{
+					++i;
+				}
+			}
+
+			if ((i < s.size()) && ((s[i] == 'e') || (s[i] == 'E')))
+			{
+				if ((++i < s.size()) && ((s[i] == '+') || (s[i] == '-')))
+				{
+					++i;
+				}
+
+				if ((i == s.size()) || (not isDigit(s[i])))
+				{
+					return false;
+				}
+
+				while ((i < s.size()) && isDigit(s[i]))
+				{
+					++i;
+				}
+			}
+
+			return (i == s.size());
+		}
+
+		[[nodiscard]]
+		inline constexpr int32 ParseJSONHex4(const char* p) noexcept
+		{
+			int32 value = 0;
+
+			for (int32 i = 0; i < 4; ++i)
+			{
+				const char c = p[i];
+				value <<= 4;
+
+				if (('0' <= c) && (c <= '9'))
+				{
+					value |= (c - '0');
+				}
+				else if (('a' <= c) && (c <= 'f'))
+				{
+					value |= (c - 'a' + 10);
+				}
+				else if (('A' <= c) && (c <= 'F'))
+				{
+					value |= (c - 'A' + 10);
+				}
+				else
+				{
+					return -1;
+				}
+			}
+
+			return value;
+		}
+	}
+
+	inline JSONReader::JSONReader(const FilePathView path)
+	{
+		open(path);
+	}
+
+	template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>*>
+	inline JSONReader::JSONReader(Reader&& reader)
+	{
+		open(std::make_unique<Reader>(std::move(reader)));
+	}
+
+	inline JSONReader::JSONReader(std::unique_ptr<IReader>&& reader)
+	{
+		open(std::move(reader));
+	}
+
+	inline bool JSONReader::open(const FilePathView path)
+	{
+		close();
+
+		if (not m_file.open(path, MapAll::Yes))
+		{
+			return false;
+		}
+
+		reset(reinterpret_cast<const char*>(m_file.data()), m_file.mappedSize());
+
+		return true;
+	}
+
+	template <class Reader, std::enable_if_t<std::is_base_of_v<IReader, Reader> && !std::is_lvalue_reference_v<Reader>>*>
+	inline bool JSONReader::open(Reader&& reader)
+	{
+		return open(std::make_unique<Reader>(std::move(reader)));
+	}
+
+	inline bool JSONReader::open(std::unique_ptr<IReader>&& reader)
+	{
+		close();
+
+		if ((not reader) || (not reader->isOpen()))
+		{
+			return false;
+		}
+
+		m_reader = std::move(reader);
+		m_buffer.resize(BufferSize);
+		reset(m_buffer.data(), 0);
+
+		return true;
+	}
+
+	inline void JSONReader::close()
+	{
+		m_file.close();
+		m_reader.reset();
+		m_buffer = std::string{};
+		m_scratch = std::string{};
+		m_stack.clear();
+		m_consumed = 0;
+		m_pos = m_end = nullptr;
+		m_value = {};
+		m_event = JSONEvent::None;
+		m_expect = Expect::Value;
+		m_newlineSkipped = false;
+		m_error = U"";
+	}
+
+	inline bool JSONReader::isOpen() const noexcept
+	{
+		return (m_file.isOpen() || static_cast<bool>(m_reader));
+	}
+
+	inline JSONReader::operator bool() const noexcept
+	{
+		return isOpen();
+	}
+
+	inline JSONEvent JSONReader::next()
+	{
+		if ((m_event == JSONEvent::End) || (m_event == JSONEvent::Error))
+		{
+			return m_event;
+		}
+
+		if (not isOpen())
+		{
+			return setError(U"JSONReader is not open");
+		}
+
+		for (;;)
+		{
+			if (not skipWhitespace())
+			{
+				if (m_expect == Expect::Done)
+				{
+					return (m_event = JSONEvent::End);
+				}
+
+				return setError(U"Unexpected end of data");
+			}
+
+			const char c = *m_pos;
+
+			switch (m_expect)
+			{
+			case Expect::Colon:
+				if (c != ':')
+				{
+					return setError(U"Expected ':'");
+				}
+
+				++m_pos;
+				m_expect = Expect::Value;
+				continue;
+			case Expect::CommaOrEnd:
+				if (c == ',')
+				{
+					++m_pos;
+					m_expect = ((m_stack.back() == '{') ? Expect::Key : Expect::Value);
+					continue;
+				}
+
+				return endContainer(c);
+			case Expect::KeyOrEnd:
+				if (c == '}')
+				{
+					return endContainer(c);
+				}
+
+				[[fallthrough]];
+			case Expect::Key:
+				if (c != '"')
+				{
+					return setError(U"Expected a string key");
+				}
+
+				++m_pos;
+
+				if (not readString())
+				{
+					return m_event;
+				}
+
+				m_expect = Expect::Colon;
+				return (m_event = JSONEvent::Key);
+			// ルートの値に続く値は、改行を挟んでいれば次のルートの値として読み込む（JSON Lines 形式）
+			case Expect::Done:
+				if (not m_newlineSkipped)
+				{
+					return setError(U"Expected a newline between root values");
+				}
+
+				return readValue(c);
+			case Expect::ValueOrEnd:
+				if (c == ']')
+				{
+					return endContainer(c);
+				}
+
+				[[fallthrough]];
+			default:
+				return readValue(c);
+			}
+		}
+	}
+
+	inline JSONEvent JSONReader::event() const noexcept
+	{
+		return m_event;
+	}
+
+	inline bool JSONReader::isValue() const noexcept
+	{
+		switch (m_event)
+		{
+		case JSONEvent::BeginObject:
+		case JSONEvent::BeginArray:
+		case JSONEvent::String:
+		case JSONEvent::Number:
+		case JSONEvent::Bool:
+		case JSONEvent::Null:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	inline size_t JSONReader::depth() const noexcept
+	{
+		return m_stack.size();
+	}
+
+	inline std::string_view JSONReader::getStringView() const noexcept
+	{
+		return m_value;
+	}
+
+	inline String JSONReader::getString() const
+	{
+		return Unicode::FromUTF8(m_value);
+	}
+
+	inline bool JSONReader::getBool() const noexcept
+	{
+		return m_bool;
+	}
+
+	inline double JSONReader::getDouble() const noexcept
+	{
+		double value = 0.0;
+		std::from_chars(m_value.data(), (m_value.data() + m_value.size()), value);
+		return value;
+	}
+
+	inline Optional<int64> JSONReader::getInt64() const noexcept
+	{
+		int64 value = 0;
+		const auto [ptr, ec] = std::from_chars(m_value.data(), (m_value.data() + m_value.size()), value);
+
+		if ((ec != std::errc{}) || (ptr != (m_value.data() + m_value.size())))
+		{
+			return none;
+		}
+
+		return value;
+	}
+
+	inline JSONEvent JSONReader::skipValue()
+	{
+		if ((m_event != JSONEvent::BeginObject) && (m_event != JSONEvent::BeginArray))
+		{
+			return m_event;
+		}
+
+		const size_t targetDepth = (m_stack.size() - 1);
+
+		while (targetDepth < m_stack.size())
+		{
+			const JSONEvent event = next();
+
+			if ((event == JSONEvent::End) || (event == JSONEvent::Error))
+			{
+				return event;
+			}
+		}
+
+		return m_event;
+	}
+
+	template <class Fty>
+	inline bool JSONReader::read(Fty f)
+	{
+		for (;;)
+		{
+			const JSONEvent event = next();
+
+			if (event == JSONEvent::End)
+			{
+				return true;
+			}
+			else if (event == JSONEvent::Error)
+			{
+				return false;
+			}
+
+			f(event, *this);
+		}
+	}
+
+	inline int64 JSONReader::offset() const noexcept
+	{
+		if (m_reader)
+		{
+			return (m_consumed + (m_pos - m_buffer.data()));
+		}
+
+		return (m_pos - reinterpret_cast<const char*>(m_file.data()));
+	}
+
+	inline StringView JSONReader::errorMessage() const noexcept
+	{
+		return m_error;
+	}
+
+	inline void JSONReader::reset(const char* data, const size_t size)
+	{
+		m_pos = data;
+		m_end = (data + size);
+
+		// UTF-8 BOM
+		if (ensure(3) && (std::memcmp(m_pos, "\xEF\xBB\xBF", 3) == 0))
+		{
+			m_pos += 3;
+		}
+	}
+
+	inline bool JSONReader::refill()
+	{
+		if (not m_reader)
+		{
+			return false;
+		}
+
+		// 読み終えていないデータをバッファの先頭に移してから、後ろに読み込む
+		const size_t remaining = static_cast<size_t>(m_end - m_pos);
+		m_consumed += (m_pos - m_buffer.data());
+		std::memmove(m_buffer.data(), m_pos, remaining);
+
+		const int64 readSize = m_reader->read((m_buffer.data() + remaining), static_cast<int64>(m_buffer.size() - remaining));
+
+		m_pos = m_buffer.data();
+		m_end = (m_pos + remaining + Max<int64>(readSize, 0));
+
+		return (0 < readSize);
+	}
+
+	inline bool JSONReader::ensure(const size_t size)
+	{
+		while (static_cast<size_t>(m_end - m_pos) < size)
+		{
+			if (not refill())
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	inline bool JSONReader::skipWhitespace()
+	{
+		for (;;)
+		{
+			while (m_pos < m_end)
+			{
+				const char c = *m_pos;
+
+				if (c == '\n')
+				{
+					m_newlineSkipped = true;
+				}
+				else if ((c != ' ') && (c != '\r') && (c != '\t'))
+				{
+					return true;
+				}
+
+				++m_pos;
+			}
+
+			if (not refill())
+			{
+				return false;
+			}
+		}
+	}
+
+	inline JSONEvent JSONReader::readValue(const char c)
+	{
+		switch (c)
+		{
+		case '{':
+			++m_pos;
+			m_stack.push_back('{');
+			m_expect = Expect::KeyOrEnd;
+			return (m_event = JSONEvent::BeginObject);
+		case '[':
+			++m_pos;
+			m_stack.push_back('[');
+			m_expect = Expect::ValueOrEnd;
+			return (m_event = JSONEvent::BeginArray);
+		case '"':
+			++m_pos;
+
+			if (not readString())
+			{
+				return m_event;
+			}
+
+			m_event = JSONEvent::String;
+			break;
+		case 't':
+		case 'f':
+			m_bool = (c == 't');
+
+			if (not readLiteral(m_bool ? "true" : "false"))
+			{
+				return setError(U"Invalid literal");
+			}
+
+			m_event = JSONEvent::Bool;
+			break;
+		case 'n':
+			if (not readLiteral("null"))
+			{
+				return setError(U"Invalid literal");
+			}
+
+			m_event = JSONEvent::Null;
+			break;
+		default:
+			if ((c != '-') && ((c < '0') || ('9' < c)))
+			{
+				return setError(U"Unexpected character");
+			}
+
+			if (not readNumber())
+			{
+				return m_event;
+			}
+
+			m_event = JSONEvent::Number;
+			break;
+		}
+
+		m_expect = (m_stack.empty() ? Expect::Done : Expect::CommaOrEnd);
+		m_newlineSkipped = false;
+
+		return m_event;
+	}
+
+	inline JSONEvent JSONReader::endContainer(const char c)
+	{
+		if (c != ((m_stack.back() == '{') ? '}' : ']'))
+		{
+			return setError((m_stack.back() == '{') ? U"Expected ',' or '}'" : U"Expected ',' or ']'");
+		}
+
+		++m_pos;
+		const bool isObject = (m_stack.back() == '{');
+		m_stack.pop_back();
+		m_expect = (m_stack.empty() ? Expect::Done : Expect::CommaOrEnd);
+		m_newlineSkipped = false;
+
+		return (m_event = (isObject ? JSONEvent::EndObject : JSONEvent::EndArray));
+	}
+
+	inline bool JSONReader::readString()
+	{
+		// エスケープを含まず、バッファをまたがない文字列は、バッファの中を直接指す
+		bool copied = false;
+		m_scratch.clear();
+
+		for (;;)
+		{
+			const char* p = detail::FindJSONStringDelimiter(m_pos, m_end);
+
+			if (p == m_end)
+			{
+				m_scratch.append(m_pos, p);
+				m_pos = p;
+				copied = true;
+
+				if (not refill())
+				{
+					setError(U"Unterminated string");
+					return false;
+				}
+
+				continue;
+			}
+
+			if (*p == '"')
+			{
+				if (copied)
+				{
+					m_scratch.append(m_pos, p);
+					m_value = m_scratch;
+				}
+				else
+				{
+					m_value = std::string_view(m_pos, (p - m_pos));
+				}
+
+				m_pos = (p + 1);
+				return true;
+			}
+
+			if (*p != '\\')
+			{
+				setError(U"Control character in string");
+				return false;
+			}
+
+			m_scratch.append(m_pos, p);
+			m_pos = p;
+			copied = true;
+
+			if (not readEscape())
+			{
+				return false;
+			}
+		}
+	}
+
+	inline bool JSONReader::readEscape()
+	{
+		if (not ensure(2))
+		{
+			setError(U"Unterminated string");
+			return false;
+		}
+
+		const char c = m_pos[1];
+
+		if (c != 'u')
+		{
+			switch (c)
+			{
+			case '"':
+			case '\\':
+			case '/':
+				m_scratch.push_back(c);
+				break;
+			case 'b':
+				m_scratch.push_back('\b');
+				break;
+			case 'f':
+				m_scratch.push_back('\f');
+				break;
+			case 'n':
+				m_scratch.push_back('\n');
+				break;
+			case 'r':
+				m_scratch.push_back('\r');
+				break;
+			case 't':
+				m_scratch.push_back('\t');
+				break;
+			default:
+				setError(U"Invalid escape sequence");
+				return false;
+			}
+
+			m_pos += 2;
+			return true;
+		}
+
+		int32 code;
+
+		if ((not ensure(6)) || ((code = detail::ParseJSONHex4(m_pos + 2)) < 0))
+		{
+			setError(U"Invalid \\u escape sequence");
+			return false;
+		}
+
+		m_pos += 6;
+
+		// サロゲートペアは 2 つの \u で表される
+		if (Unicode::IsHighSurrogate(static_cast<char16>(code)))
+		{
+			int32 low;
+
+			if ((not ensure(6)) || (m_pos[0] != '\\') || (m_pos[1] != 'u')
+				|| ((low = detail::ParseJSONHex4(m_pos + 2)) < 0)
+				|| (not Unicode::IsLowSurrogate(static_cast<char16>(low))))
+			{
+				setError(U"Invalid surrogate pair");
+				return false;
+			}
+
+			m_pos += 6;
+			code = (0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00));
+		}
+		else if (Unicode::IsLowSurrogate(static_cast<char16>(code)))
+		{
+			setError(U"Invalid surrogate pair");
+			return false;
+		}
+
+		UTF32toUTF8_Converter converter;
+		const size_t length = converter.put(static_cast<char32>(code));
+		m_scratch.append(reinterpret_cast<const char*>(converter.get().data()), length);
+
+		return true;
+	}
+
+	inline bool JSONReader::readNumber()
+	{
+		bool copied = false;
+		m_scratch.clear();
+
+		for (;;)
+		{
+			const char* p = m_pos;
+
+			while ((p < m_end) && detail::IsJSONNumberChar(*p))
+			{
+				++p;
+			}
+
+			if (p == m_end)
+			{
+				m_scratch.append(m_pos, p);
+				m_pos = p;
+				copied = true;
+
+				if (refill())
+				{
+					continue;
+				}
+
+				// データの終端。refill() はバッファの先頭に詰め直すため、p もそれに合わせる
+				p = m_pos;
+			}
+
+			if (copied)
+			{
+				m_scratch.append(m_pos, p);
+				m_value = m_scratch;
+			}
+			else
+			{
+				m_value = std::string_view(m_pos, (p - m_pos));
+			}
+
+			m_pos = p;
+			break;
+		}
+
+		if (not detail::IsJSONNumber(m_value))
+		{
+			setError(U"Invalid number");
+			return false;
+		}
+
+		return true;
+	}
+
+	inline bool JSONReader::readLiteral(const std::string_view literal)
+	{
+		if ((not ensure(literal.size())) || (std::string_view(m_pos, literal.size()) != literal))
+		{
+			return false;
+		}
+
+		m_pos += literal.size();
+
+		return true;
+	}
+
+	inline JSONEvent JSONReader::setError(const char32* message)
+	{
+		m_error = message;
+		m_value = {};
+		return (m_event = JSONEvent::Error);
+	}
+}
@@ -0,0 +1,411 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+# include <cassert>
+# include <charconv>
+# include <cmath>
+
+namespace s3d
+{
+	inline JSONWriter::JSONWriter(Blob& blob)
+		: m_blob{ &blob }
+	{
+		m_buffer.reserve(BufferSize);
+	}
+
+	inline JSONWriter::JSONWriter(IWriter& writer)
+		: m_writer{ &writer }
+	{
+		m_buffer.reserve(BufferSize);
+	}
+
+	inline JSONWriter::~JSONWriter()
+	{
+		flush();
+	}
+
+	inline JSONWriter& JSONWriter::startObject()
+	{
+		if (not beginValue())
+		{
+			return *this;
+		}
+
+		m_buffer.push_back('{');
+		m_stack.push_back('{');
+		m_hasValue = false;
+		return *this;
+	}
+
+	inline JSONWriter& JSONWriter::endObject()
+	{
+		return endContainer('{');
+	}
+
+	inline JSONWriter& JSONWriter::startArray()
+	{
+		if (not beginValue())
+		{
+			return *this;
+		}
+
+		m_buffer.push_back('[');
+		m_stack.push_back('[');
+		m_hasValue = false;
+		return *this;
+	}
+
+	inline JSONWriter& JSONWriter::endArray()
+	{
+		return endContainer('[');
+	}
+
+	inline JSONWriter& JSONWriter::key(const std::string_view name)
+	{
+		if (not beginKey())
+		{
+			return *this;
+		}
+
+		appendString(name);
+		m_buffer.push_back(':');
+		m_afterKey = true;
+		return *this;
+	}
+
+	inline JSONWriter& JSONWriter::key(const StringView name)
+	{
+		if (not beginKey())
+		{
+			return *this;
+		}
+
+		appendString(name);
+		m_buffer.push_back(':');
+		m_afterKey = true;
+		return *this;
+	}
+
+	inline JSONWriter& JSONWriter::key(const char* name)
+	{
+		return key(std::string_view{ name });
+	}
+
+	inline JSONWriter& JSONWriter::key(const char32* name)
+	{
+		return key(StringView{ name });
+	}
+
+	inline JSONWriter& JSONWriter::write(std::nullptr_t)
+	{
+		if (not beginValue())
+		{
+			return *this;
+		}
+
+		m_buffer.append("null", 4);
+		endValue();
+		return *this;
+	}
+
+	inline JSONWriter& JSONWriter::write(const bool value)
+	{
+		if (not beginValue())
+		{
+			return *this;
+		}
+
+		if (value)
+		{
+			m_buffer.append("true", 4);
+		}
+		else
+		{
+			m_buffer.append("false", 5);
+		}
+
+		endValue();
+		return *this;
+	}
+
+	SIV3D_CONCEPT_INTEGRAL_
+	inline JSONWriter& JSONWriter::write(const Int value)
+	{
+		if (not beginValue())
+		{
+			return *this;
+		}
+
+		char buffer[24];
+		const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+		m_buffer.append(buffer, result.ptr);
+
+		endValue();
+		return *this;
+	}
+
+	SIV3D_CONCEPT_FLOATING_POINT_
+	inline JSONWriter& JSONWriter::write(const Float value)
+	{
+		if (not std::isfinite(value))
+		{
+			return write(nullptr);
+		}
+
+		if (not beginValue())
+		{
+			return *this;
+		}
+
+		char buffer[32];
+		const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+		m_buffer.append(buffer, result.ptr);
+
+		endValue();
+		return *this;
+	}
+
+	inline JSONWriter& JSONWriter::write(const std::string_view value)
+	{
+		if (not beginValue())
+		{
+			return *this;
+		}
+
+		appendString(value);
+		endValue();
+		return *this;
+	}
+
+	inline JSONWriter& JSONWriter::write(const StringView value)
+	{
+		if (not beginValue())
+		{
+			return *this;
+		}
+
+		appendString(value);
+		endValue();
+		return *this;
+	}
+
+	inline JSONWriter& JSONWriter::write(const char* value)
+	{
+		return write(std::string_view{ value });
+	}
+
+	inline JSONWriter& JSONWriter::write(const char32* value)
+	{
+		return write(StringView{ value });
+	}
+
+	template <class Name, class Type>
+	inline JSONWriter& JSONWriter::write(const Name& name, const Type& value)
+	{
+		key(name);
+		return write(value);
+	}
+
+	inline bool JSONWriter::flush()
+	{
+		if (m_buffer.empty())
+		{
+			return (not m_hasError);
+		}
+
+		if (m_blob)
+		{
+			m_blob->append(m_buffer.data(), m_buffer.size());
+		}
+		else if (m_writer && (not m_hasError))
+		{
+			// 一部だけ書き込まれた場合、続きを書き出しても正しい JSON にはならない
+			if (m_writer->write(m_buffer.data(), static_cast<int64>(m_buffer.size())) != static_cast<int64>(m_buffer.size()))
+			{
+				m_hasError = true;
+			}
+		}
+
+		m_buffer.clear();
+
+		return (not m_hasError);
+	}
+
+	inline bool JSONWriter::hasError() const noexcept
+	{
+		return m_hasError;
+	}
+
+	inline size_t JSONWriter::depth() const noexcept
+	{
+		return m_stack.size();
+	}
+
+	inline bool JSONWriter::beginKey()
+	{
+		// キーは、オブジェクトの中で値を書き出す位置にだけ書き出せる
+		const bool inObject = ((not m_stack.empty()) && (m_stack.back() == '{') && (not m_afterKey));
+		assert(inObject);
+
+		if (not inObject)
+		{
+			return false;
+		}
+
+		if (m_hasValue)
+		{
+			m_buffer.push_back(',');
+		}
+
+		return true;
+	}
+
+	inline bool JSONWriter::beginValue()
+	{
+		if (m_afterKey)
+		{
+			m_afterKey = false;
+			return true;
+		}
+
+		// オブジェクトの中では、値の前にキーが必要
+		const bool needsKey = ((not m_stack.empty()) && (m_stack.back() == '{'));
+		assert(not needsKey);
+
+		if (needsKey)
+		{
+			return false;
+		}
+
+		if (m_hasValue)
+		{
+			// ルートの値は改行で区切る
+			m_buffer.push_back(m_stack.empty() ? '\n' : ',');
+		}
+
+		return true;
+	}
+
+	inline JSONWriter& JSONWriter::endContainer(const char open)
+	{
+		const bool matched = ((not m_stack.empty()) && (m_stack.back() == open) && (not m_afterKey));
+		assert(matched);
+
+		if (not matched)
+		{
+			return *this;
+		}
+
+		m_buffer.push_back((open == '{') ? '}' : ']');
+		m_stack.pop_back();
+		endValue();
+		return *this;
+	}
+
+	inline void JSONWriter::endValue()
+	{
+		m_hasValue = true;
+
+		if (BufferSize <= m_buffer.size())
+		{
+			flush();
+		}
+	}
+
+	inline void JSONWriter::appendString(const std::string_view s)
+	{
+		m_buffer.push_back('"');
+
+		const char* first = s.data();
+		const char* const last = (s.data() + s.size());
+
+		for (const char* p = first; p != last; ++p)
+		{
+			const char c = *p;
+
+			if ((c == '"') || (c == '\\') || (static_cast<uint8>(c) < 0x20))
+			{
+				m_buffer.append(first, p);
+				appendEscaped(c);
+				first = (p + 1);
+			}
+		}
+
+		m_buffer.append(first, last);
+		m_buffer.push_back('"');
+	}
+
+	inline void JSONWriter::appendString(const StringView s)
+	{
+		m_buffer.push_back('"');
+
+		for (const char32 ch : s)
+		{
+			if (ch < 0x80)
+			{
+				const char c = static_cast<char>(ch);
+
+				if ((c == '"') || (c == '\\') || (ch < 0x20))
+				{
+					appendEscaped(c);
+				}
+				else
+				{
+					m_buffer.push_back(c);
+				}
+			}
+			else
+			{
+				UTF32toUTF8_Converter converter;
+				const size_t length = converter.put(ch);
+				m_buffer.append(reinterpret_cast<const char*>(converter.get().data()), length);
+			}
+		}
+
+		m_buffer.push_back('"');
+	}
+
+	inline void JSONWriter::appendEscaped(const char c)
+	{
+		m_buffer.push_back('\\');
+
+		switch (c)
+		{
+		case '"':
+		case '\\':
+			m_buffer.push_back(c);
+			break;
+		case '\b':
+			m_buffer.push_back('b');
+			break;
+		case '\f':
+			m_buffer.push_back('f');
+			break;
+		case '\n':
+			m_buffer.push_back('n');
+			break;
+		case '\r':
+			m_buffer.push_back('r');
+			break;
+		case '\t':
+			m_buffer.push_back('t');
+			break;
+		default:
+			{
+				constexpr char Hex[] = "0123456789ABCDEF";
+				const char digits[5] = { 'u', '0', '0', Hex[(c >> 4) & 0xF], Hex[c & 0xF] };
+				m_buffer.append(digits, 5);
+			}
+			break;
+		}
+	}
+}
@@ -96,6 +96,347 @@ namespace s3d
 				return m_radius;
 			}
 		};
+
+		/// @brief nanoflann の kd-tree を、木の形を変えずに要素の現在の位置に合わせて更新します。
+		/// @remark 探索は、各ノードで左の子の要素がすべて分割面の手前（divlow 以下）、右の子の要素がすべて向こう側（divhigh 以上）にあることを前提に枝刈りします。
+		/// 要素が分割面をまたいだノードでは、前回の分割面を越えた要素だけを値の順に左右へ配り直して、この前提を保ちます。
+		template <class Index, class Adapter>
+		class KDTreeRefitter
+		{
+		public:
+
+			using Node			= typename Index::Node;
+
+			using BoundingBox	= typename Index::BoundingBox;
+
+			using ElementType	= typename Index::ElementType;
+
+			KDTreeRefitter(Index& index, const Adapter& adapter)
+				: m_index{ index }
+				, m_adapter{ adapter } {}
+
+			void refit()
+			{
+				m_nodes.clear();
+				build(m_index.root_node);
+
+				for (size_t i = 0; i < m_nodes.size(); ++i)
+				{
+					separate(i);
+				}
+
+				m_index.root_bbox = m_nodes.front().box;
+			}
+
+		private:
+
+			struct NodeInfo
+			{
+				Node* node;
+
+				// このノードが持つ要素の vAcc 上の範囲 [first, last)
+				size_t first, last;
+
+				size_t child1, child2;
+
+				BoundingBox box;
+
+				[[nodiscard]]
+				bool isLeaf() const noexcept
+				{
+					return (node->child1 == nullptr);
+				}
+			};
+
+			Index& m_index;
+
+			const Adapter& m_adapter;
+
+			Array<NodeInfo> m_nodes;
+
+			Array<size_t> m_lowSlots, m_highSlots, m_extraSlots;
+
+			Array<std::pair<ElementType, size_t>> m_candidates;
+
+			[[nodiscard]]
+			ElementType value(const size_t slot, const size_t dim) const
+			{
+				return m_adapter.kdtree_get_pt(m_index.vAcc[slot], dim);
+			}
+
+			// 前順でノードの情報を作り、範囲を下から計算する
+			size_t build(Node* node)
+			{
+				const size_t id = m_nodes.size();
+				m_nodes.push_back(NodeInfo{ node, 0, 0, 0, 0, {} });
+
+				if (node->child1 == nullptr)
+				{
+					m_nodes[id].first = node->node_type.lr.left;
+					m_nodes[id].last = node->node_type.lr.right;
+					computeLeafBox(id);
+					return id;
+				}
+
+				const size_t child1 = build(node->child1);
+				const size_t child2 = build(node->child2);
+
+				NodeInfo& info = m_nodes[id];
+				info.child1 = child1;
+				info.child2 = child2;
+				info.first = m_nodes[child1].first;
+				info.last = m_nodes[child2].last;
+				computeUnionBox(id);
+				return id;
+			}
+
+			void computeLeafBox(const size_t id)
+			{
+				NodeInfo& info = m_nodes[id];
+
+				for (size_t dim = 0; dim < info.box.size(); ++dim)
+				{
+					info.box[dim].low = std::numeric_limits<ElementType>::max();
+					info.box[dim].high = std::numeric_limits<ElementType>::lowest();
+
+					for (size_t slot = info.first; slot < info.last; ++slot)
+					{
+						const ElementType v = value(slot, dim);
+						info.box[dim].low = Min(info.box[dim].low, v);
+						info.box[dim].high = Max(info.box[dim].high, v);
+					}
+				}
+			}
+
+			void computeUnionBox(const size_t id)
+			{
+				NodeInfo& info = m_nodes[id];
+				const BoundingBox& a = m_nodes[info.child1].box;
+				const BoundingBox& b = m_nodes[info.child2].box;
+
+				for (size_t dim = 0; dim < info.box.size(); ++dim)
+				{
+					info.box[dim].low = Min(a[dim].low, b[dim].low);
+					info.box[dim].high = Max(a[dim].high, b[dim].high);
+				}
+			}
+
+			// 次元 dim の値が [low, high] にある要素の位置を集める。範囲と重ならない部分木は調べない
+			void collect(const size_t id, const size_t dim, const ElementType low, const ElementType high, Array<size_t>& slots)
+			{
+				const NodeInfo& info = m_nodes[id];
+
+				if ((info.box[dim].high < low) || (high < info.box[dim].low))
+				{
+					return;
+				}
+
+				if (info.isLeaf())
+				{
+					for (size_t slot = info.first; slot < info.last; ++slot)
+					{
+						if (const ElementType v = value(slot, dim); ((low <= v) && (v <= high)))
+						{
+							slots.push_back(slot);
+						}
+					}
+
+					return;
+				}
+
+				collect(info.child1, dim, low, high, slots);
+				collect(info.child2, dim, low, high, slots);
+			}
+
+			// 部分木 id の要素のうち、次元 dim の値が split より大きい（above が false の場合は小さい）側で split に近いものを count 個以上集める（部分木にそれだけない場合はすべて集める）
+			void collectNearest(const size_t id, const size_t dim, const ElementType split, const bool above, const size_t count, Array<size_t>& slots)
+			{
+				const NodeInfo& info = m_nodes[id];
+				const ElementType reach = (above ? (info.box[dim].high - split) : (split - info.box[dim].low));
+
+				// 要素が一様に分布しているとみなして、count 個が入りそうな幅から探し始め、足りなければ幅を広げる
+				ElementType width = ((info.box[dim].high - info.box[dim].low) * static_cast<ElementType>(2 * count) / static_cast<ElementType>(info.last - info.first));
+
+				for (;;)
+				{
+					slots.clear();
+
+					if (above)
+					{
+						collect(id, dim, split, (split + width), slots);
+					}
+					else
+					{
+						collect(id, dim, (split - width), split, slots);
+					}
+
+					if ((count <= slots.size()) || (reach <= width))
+					{
+						return;
+					}
+
+					width = ((0 < width) ? (width * 2) : reach);
+				}
+			}
+
+			// 要素を入れ替えた位置 (sortedSlots) を含む部分木の範囲を計算し直す
+			void refresh(const size_t id, const Array<size_t>& sortedSlots)
+			{
+				const NodeInfo& info = m_nodes[id];
+				const auto it = std::lower_bound(sortedSlots.begin(), sortedSlots.end(), info.first);
+
+				if ((it == sortedSlots.end()) || (info.last <= *it))
+				{
+					return;
+				}
+
+				if (info.isLeaf())
+				{
+					computeLeafBox(id);
+					return;
+				}
+
+				refresh(info.child1, sortedSlots);
+				refresh(info.child2, sortedSlots);
+				computeUnionBox(id);
+			}
+
+			void separate(const size_t id)
+			{
+				const NodeInfo& info = m_nodes[id];
+
+				if (info.isLeaf())
+				{
+					return;
+				}
+
+				auto& sub = info.node->node_type.sub;
+				const size_t dim = static_cast<size_t>(sub.divfeat);
+
+				if (m_nodes[info.child1].box[dim].high <= m_nodes[info.child2].box[dim].low)
+				{
+					sub.divlow = m_nodes[info.child1].box[dim].high;
+					sub.divhigh = m_nodes[info.child2].box[dim].low;
+					return;
+				}
+
+				// 前回の分割面より向こう側に出た要素を集める。左右の数が合わない場合は、少ない側の分割面に近い要素を加えて数をそろえる
+				const ElementType split = ((sub.divlow + sub.divhigh) / 2);
+				const ElementType lowest = std::numeric_limits<ElementType>::lowest();
+				const ElementType highest = std::numeric_limits<ElementType>::max();
+
+				m_lowSlots.clear();
+				m_highSlots.clear();
+				collect(info.child1, dim, std::nextafter(split, highest), highest, m_lowSlots);
+				collect(info.child2, dim, lowest, std::nextafter(split, lowest), m_highSlots);
+
+				if (m_highSlots.size() < m_lowSlots.size())
+				{
+					collectNearest(info.child2, dim, split, true, (m_lowSlots.size() - m_highSlots.size()), m_extraSlots);
+					selectNearest(m_extraSlots, dim, (m_lowSlots.size() - m_highSlots.size()), true);
+					m_highSlots.append(m_extraSlots);
+				}
+				else if (m_lowSlots.size() < m_highSlots.size())
+				{
+					collectNearest(info.child1, dim, split, false, (m_highSlots.size() - m_lowSlots.size()), m_extraSlots);
+					selectNearest(m_extraSlots, dim, (m_highSlots.size() - m_lowSlots.size()), false);
+					m_lowSlots.append(m_extraSlots);
+				}
+
+				// 集めた要素を値の順に並べ、小さいほうから左の子の位置に、残りを右の子の位置に入れる
+				m_candidates.clear();
+
+				for (const size_t slot : m_lowSlots)
+				{
+					m_candidates.emplace_back(value(slot, dim), m_index.vAcc[slot]);
+				}
+
+				for (const size_t slot : m_highSlots)
+				{
+					m_candidates.emplace_back(value(slot, dim), m_index.vAcc[slot]);
+				}
+
+				std::sort(m_candidates.begin(), m_candidates.end());
+				m_lowSlots.sort();
+				m_highSlots.sort();
+
+				for (size_t i = 0; i < m_lowSlots.size(); ++i)
+				{
+					m_index.vAcc[m_lowSlots[i]] = m_candidates[i].second;
+				}
+
+				for (size_t i = 0; i < m_highSlots.size(); ++i)
+				{
+					m_index.vAcc[m_highSlots[i]] = m_candidates[m_lowSlots.size() + i].second;
+				}
+
+				const size_t child1 = info.child1;
+				const size_t child2 = info.child2;
+				refresh(child1, m_lowSlots);
+				refresh(child2, m_highSlots);
+
+				sub.divlow = m_nodes[child1].box[dim].high;
+				sub.divhigh = m_nodes[child2].box[dim].low;
+			}
+
+			// slots のうち、値が分割面に近い順に count 個を残す
+			void selectNearest(Array<size_t>& slots, const size_t dim, const size_t count, const bool above)
+			{
+				if (slots.size() <= count)
+				{
+					return;
+				}
+
+				std::nth_element(slots.begin(), (slots.begin() + count), slots.end(), [&](const size_t a, const size_t b)
+					{
+						const ElementType va = value(a, dim);
+						const ElementType vb = value(b, dim);
+						return (above ? (va < vb) : (vb < va));
+					});
+
+				slots.resize(count);
+			}
+		};
+
+	# ifndef SIV3D_NO_CONCURRENT_API
+
+		template <class Adapter, class Index, class PointType, class ElementType>
+		inline void ParallelKNNSearch(const Index& index, const size_t k, const std::span<const PointType> queries, size_t* const results, ElementType* const distanceSqResults)
+		{
+			using DistanceType = typename Index::DistanceType;
+
+			ThreadPool::Global().parallelFor(0, queries.size(), [&](const size_t first, const size_t last)
+				{
+					// 距離の作業領域は、検索ごとではなく分割した範囲ごとに 1 回だけ確保する
+					Array<DistanceType> distances(k);
+
+					for (size_t i = first; i < last; ++i)
+					{
+						size_t* const pIndices = (results + i * k);
+
+						nanoflann::KNNResultSet<DistanceType, size_t, size_t> resultSet{ k };
+						resultSet.init(pIndices, distances.data());
+						index.findNeighbors(resultSet, Adapter::GetPointer(queries[i]), nanoflann::SearchParams{});
+
+						const size_t found = resultSet.size();
+						std::fill((pIndices + found), (pIndices + k), std::numeric_limits<size_t>::max());
+
+						if (distanceSqResults)
+						{
+							ElementType* const pDistances = (distanceSqResults + i * k);
+
+							for (size_t n = 0; n < found; ++n)
+							{
+								pDistances[n] = static_cast<ElementType>(distances[n]);
+							}
+
+							std::fill((pDistances + found), (pDistances + k), std::numeric_limits<ElementType>::max());
+						}
+					}
+				}, 16);
+		}
+
+	# endif
 	}
 
 	template <class DatasetAdapter>
@@ -112,6 +453,21 @@ namespace s3d
 		m_index.buildIndex();
 	}
 
+	template <class DatasetAdapter>
+	inline bool KDTree<DatasetAdapter>::refitIndex()
+	{
+		if ((m_index.root_node == nullptr)
+			|| (m_adapter.kdtree_get_point_count() != m_index.m_size_at_index_build))
+		{
+			rebuildIndex();
+			return false;
+		}
+
+		detail::KDTreeRefitter<decltype(m_index), adapter_type>{ m_index, m_adapter }.refit();
+
+		return true;
+	}
+
 	template <class DatasetAdapter>
 	inline void KDTree<DatasetAdapter>::release()
 	{
@@ -204,4 +560,185 @@ namespace s3d
 			m_index.radiusSearchCustomCallback(adapter_type::GetPointer(point), resultSet, searchParams);
 		}
 	}
+
+# ifndef SIV3D_NO_CONCURRENT_API
+
+	template <class DatasetAdapter>
+	inline void KDTree<DatasetAdapter>::parallel_knnSearch(Array<size_t>& results, const size_t k, const std::span<const point_type> queries) const
+	{
+		results.resize(queries.size() * k);
+
+		if (k == 0)
+		{
+			return;
+		}
+
+		detail::ParallelKNNSearch<adapter_type>(m_index, k, queries, results.data(), static_cast<element_type*>(nullptr));
+	}
+
+	template <class DatasetAdapter>
+	inline void KDTree<DatasetAdapter>::parallel_knnSearch(Array<size_t>& results, Array<element_type>& distanceSqResults, const size_t k, const std::span<const point_type> queries) const
+	{
+		results.resize(queries.size() * k);
+		distanceSqResults.resize(queries.size() * k);
+
+		if (k == 0)
+		{
+			return;
+		}
+
+		detail::ParallelKNNSearch<adapter_type>(m_index, k, queries, results.data(), distanceSqResults.data());
+	}
+
+# endif
+
+	template <class DatasetAdapter>
+	inline DynamicKDTree<DatasetAdapter>::Index::Index(const dataset_type& dataset)
+		: adapter{ dataset }
+		, index{ Dimensions, adapter, nanoflann::KDTreeSingleIndexAdaptorParams(10) } {}
+
+	template <class DatasetAdapter>
+	inline DynamicKDTree<DatasetAdapter>::DynamicKDTree(const dataset_type& dataset)
+		: m_index{ std::make_unique<Index>(dataset) }
+		, m_removed(m_index->adapter.kdtree_get_point_count(), false) {}
+
+	template <class DatasetAdapter>
+	inline void DynamicKDTree<DatasetAdapter>::addPoints()
+	{
+		if (not m_index)
+		{
+			return;
+		}
+
+		const size_t first = m_removed.size();
+		const size_t count = m_index->adapter.kdtree_get_point_count();
+
+		if (count <= first)
+		{
+			return;
+		}
+
+		m_index->index.addPoints(first, (count - 1));
+		m_removed.resize(count, false);
+	}
+
+	template <class DatasetAdapter>
+	inline void DynamicKDTree<DatasetAdapter>::removePoint(const size_t index)
+	{
+		if ((m_removed.size() <= index) || m_removed[index])
+		{
+			return;
+		}
+
+		m_index->index.removePoint(index);
+		m_removed[index] = true;
+		++m_removedCount;
+	}
+
+	template <class DatasetAdapter>
+	inline size_t DynamicKDTree<DatasetAdapter>::size() const noexcept
+	{
+		return (m_removed.size() - m_removedCount);
+	}
+
+	template <class DatasetAdapter>
+	inline Array<size_t> DynamicKDTree<DatasetAdapter>::knnSearch(const size_t k, const point_type& point) const
+	{
+		Array<size_t> results;
+
+		knnSearch(results, k, point);
+
+		return results;
+	}
+
+	template <class DatasetAdapter>
+	inline void DynamicKDTree<DatasetAdapter>::knnSearch(Array<size_t>& results, const size_t k, const point_type& point) const
+	{
+		if ((not m_index) || (k == 0))
+		{
+			results.clear();
+			return;
+		}
+
+		results.resize(k);
+
+		Array<typename index_type::DistanceType> distanceSqs(k);
+
+		nanoflann::KNNResultSet<typename index_type::DistanceType, size_t, size_t> resultSet{ k };
+		resultSet.init(results.data(), distanceSqs.data());
+		m_index->index.findNeighbors(resultSet, adapter_type::GetPointer(point), nanoflann::SearchParams{});
+
+		results.resize(resultSet.size());
+	}
+
+	template <class DatasetAdapter>
+	inline void DynamicKDTree<DatasetAdapter>::radiusSearch(Array<size_t>& results, const point_type& point, const element_type radius, const SortByDistance sortByDistance) const
+	{
+		results.clear();
+
+		if (not m_index)
+		{
+			return;
+		}
+
+		const nanoflann::SearchParams searchParams{ 32, 0.0f, sortByDistance.getBool() };
+
+		if (sortByDistance)
+		{
+			std::vector<std::pair<size_t, typename index_type::DistanceType>> matches;
+
+			nanoflann::RadiusResultSet<typename index_type::DistanceType, size_t> resultSet{ (radius * radius), matches };
+
+			m_index->index.findNeighbors(resultSet, adapter_type::GetPointer(point), searchParams);
+
+			std::sort(matches.begin(), matches.end(), nanoflann::IndexDist_Sorter());
+
+			results.reserve(matches.size());
+
+			for (const auto& match : matches)
+			{
+				results.push_back(match.first);
+			}
+		}
+		else
+		{
+			detail::RadiusResultsAdapter<typename index_type::DistanceType> resultSet{ (radius * radius), results };
+
+			m_index->index.findNeighbors(resultSet, adapter_type::GetPointer(point), searchParams);
+		}
+	}
+
+# ifndef SIV3D_NO_CONCURRENT_API
+
+	template <class DatasetAdapter>
+	inline void DynamicKDTree<DatasetAdapter>::parallel_knnSearch(Array<size_t>& results, const size_t k, const std::span<const point_type> queries) const
+	{
+		results.resize(queries.size() * k);
+
+		if ((not m_index) || (k == 0))
+		{
+			std::fill(results.begin(), results.end(), InvalidIndex);
+			return;
+		}
+
+		detail::ParallelKNNSearch<adapter_type>(m_index->index, k, queries, results.data(), static_cast<element_type*>(nullptr));
+	}
+
+	template <class DatasetAdapter>
+	inline void DynamicKDTree<DatasetAdapter>::parallel_knnSearch(Array<size_t>& results, Array<element_type>& distanceSqResults, const size_t k, const std::span<const point_type> queries) const
+	{
+		results.resize(queries.size() * k);
+		distanceSqResults.resize(queries.size() * k);
+
+		if ((not m_index) || (k == 0))
+		{
+			std::fill(results.begin(), results.end(), InvalidIndex);
+			std::fill(distanceSqResults.begin(), distanceSqResults.end(), std::numeric_limits<element_type>::max());
+			return;
+		}
+
+		detail::ParallelKNNSearch<adapter_type>(m_index->index, k, queries, results.data(), distanceSqResults.data());
+	}
+
+# endif
 }
@@ -0,0 +1,337 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+
+namespace s3d
+{
+	namespace detail
+	{
+		/// @brief 4 レーンのうち、マスクのビットが立っているレーンを前に詰める _mm_shuffle_epi8 の制御値
+		alignas(16) inline constexpr std::array<std::array<uint8, 16>, 16> ParticleCompactionShuffle = []()
+		{
+			std::array<std::array<uint8, 16>, 16> table{};
+
+			for (size_t mask = 0; mask < 16; ++mask)
+			{
+				size_t n = 0;
+
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					if ((mask >> lane) & 1)
+					{
+						for (size_t byte = 0; byte < 4; ++byte)
+						{
+							table[mask][n * 4 + byte] = static_cast<uint8>(lane * 4 + byte);
+						}
+
+						++n;
+					}
+				}
+
+				// 残りのレーンは使われないので 0 にする（最上位ビットが立っているバイトは 0 になる）
+				for (size_t byte = (n * 4); byte < 16; ++byte)
+				{
+					table[mask][byte] = 0x80;
+				}
+			}
+
+			return table;
+		}();
+	}
+
+	template <class Type>
+	inline LifeTimeCurve<Type>::LifeTimeCurve(Array<Type> samples)
+		: m_samples{ std::move(samples) } {}
+
+	template <class Type>
+	inline Type LifeTimeCurve<Type>::operator ()(const float t) const noexcept
+	{
+		if (m_samples.isEmpty())
+		{
+			if constexpr (std::is_arithmetic_v<Type>)
+			{
+				return Type{ 1 };
+			}
+			else
+			{
+				return Type::All(1);
+			}
+		}
+
+		if (m_samples.size() == 1)
+		{
+			return m_samples.front();
+		}
+
+		const float position = (Clamp(t, 0.0f, 1.0f) * (m_samples.size() - 1));
+		const size_t index = Min(static_cast<size_t>(position), (m_samples.size() - 2));
+		const float fraction = (position - index);
+
+		return (m_samples[index] + (m_samples[index + 1] - m_samples[index]) * fraction);
+	}
+
+	template <class Type>
+	inline bool LifeTimeCurve<Type>::isEmpty() const noexcept
+	{
+		return m_samples.isEmpty();
+	}
+
+	template <class Type>
+	template <class Fty, std::enable_if_t<std::is_invocable_r_v<Type, Fty, float>>*>
+	inline LifeTimeCurve<Type> LifeTimeCurve<Type>::Generate(const size_t resolution, Fty f)
+	{
+		Array<Type> samples(Arg::reserve = resolution);
+
+		for (size_t i = 0; i < resolution; ++i)
+		{
+			samples.push_back(f((resolution == 1) ? 0.0f : (static_cast<float>(i) / (resolution - 1))));
+		}
+
+		return LifeTimeCurve{ std::move(samples) };
+	}
+
+	inline void ParticleBuffer2D::add(const Emission2D& emission, const Float4& startColor, const float startSize, const float rotation, const float angularVelocity, const float lifeTime)
+	{
+		m_positionX.push_back(static_cast<float>(emission.position.x));
+		m_positionY.push_back(static_cast<float>(emission.position.y));
+		m_velocityX.push_back(static_cast<float>(emission.velocity.x));
+		m_velocityY.push_back(static_cast<float>(emission.velocity.y));
+		m_rotation.push_back(rotation);
+		m_angularVelocity.push_back(angularVelocity);
+		m_startLifeTime.push_back(lifeTime);
+		m_remainingLifeTime.push_back(lifeTime);
+		m_startSize.push_back(startSize);
+		m_startColor.push_back(startColor);
+	}
+
+	inline void ParticleBuffer2D::append(const std::span<const Emission2D> emissions, const Float4& startColor, const float startSize, const float rotation, const float angularVelocity, const float lifeTime)
+	{
+		const size_t oldSize = size();
+		const size_t newSize = (oldSize + emissions.size());
+
+		m_positionX.resize(newSize);
+		m_positionY.resize(newSize);
+		m_velocityX.resize(newSize);
+		m_velocityY.resize(newSize);
+		m_rotation.resize(newSize, rotation);
+		m_angularVelocity.resize(newSize, angularVelocity);
+		m_startLifeTime.resize(newSize, lifeTime);
+		m_remainingLifeTime.resize(newSize, lifeTime);
+		m_startSize.resize(newSize, startSize);
+		m_startColor.resize(newSize, startColor);
+
+		for (size_t i = 0; i < emissions.size(); ++i)
+		{
+			const Emission2D& emission = emissions[i];
+			m_positionX[oldSize + i] = static_cast<float>(emission.position.x);
+			m_positionY[oldSize + i] = static_cast<float>(emission.position.y);
+			m_velocityX[oldSize + i] = static_cast<float>(emission.velocity.x);
+			m_velocityY[oldSize + i] = static_cast<float>(emission.velocity.y);
+		}
+	}
+
+	inline void ParticleBuffer2D::update(const float deltaTime, const Float2& deltaVelocity) noexcept
+	{
+		const size_t count = size();
+
+		float* const px = m_positionX.data();
+		float* const py = m_positionY.data();
+		float* const vx = m_velocityX.data();
+		float* const vy = m_velocityY.data();
+		float* const rotation = m_rotation.data();
+		float* const angularVelocity = m_angularVelocity.data();
+		float* const remaining = m_remainingLifeTime.data();
+		float* const startLifeTime = m_startLifeTime.data();
+		float* const startSize = m_startSize.data();
+		Float4* const startColor = m_startColor.data();
+
+		const __m128 dt = _mm_set1_ps(deltaTime);
+		const __m128 dvx = _mm_set1_ps(deltaVelocity.x);
+		const __m128 dvy = _mm_set1_ps(deltaVelocity.y);
+		const __m128 zero = _mm_setzero_ps();
+
+		// 生きているパーティクルを詰めて書き込む位置
+		size_t write = 0;
+		size_t i = 0;
+
+		for (; (i + 4) <= count; i += 4)
+		{
+			const __m128 newVX = _mm_add_ps(_mm_loadu_ps(vx + i), dvx);
+			const __m128 newVY = _mm_add_ps(_mm_loadu_ps(vy + i), dvy);
+			const __m128 newPX = _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(newVX, dt));
+			const __m128 newPY = _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(newVY, dt));
+			const __m128 newRotation = _mm_add_ps(_mm_loadu_ps(rotation + i), _mm_mul_ps(_mm_loadu_ps(angularVelocity + i), dt));
+			const __m128 newRemaining = _mm_sub_ps(_mm_loadu_ps(remaining + i), dt);
+			const int aliveMask = _mm_movemask_ps(_mm_cmpgt_ps(newRemaining, zero));
+
+			// 4 つとも生きていて、まだ詰める必要が無ければそのまま書き戻す
+			if ((aliveMask == 0b1111) && (write == i))
+			{
+				_mm_storeu_ps(vx + i, newVX);
+				_mm_storeu_ps(vy + i, newVY);
+				_mm_storeu_ps(px + i, newPX);
+				_mm_storeu_ps(py + i, newPY);
+				_mm_storeu_ps(rotation + i, newRotation);
+				_mm_storeu_ps(remaining + i, newRemaining);
+				write += 4;
+				continue;
+			}
+
+			// 生きているレーンを前に詰めて write に書き込む。書き込み先は読み込み済みの範囲 [write, i + 4) に収まる
+			const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(detail::ParticleCompactionShuffle[aliveMask].data()));
+			const auto compact = [shuffle](const __m128 v) { return _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(v), shuffle)); };
+
+			_mm_storeu_ps(vx + write, compact(newVX));
+			_mm_storeu_ps(vy + write, compact(newVY));
+			_mm_storeu_ps(px + write, compact(newPX));
+			_mm_storeu_ps(py + write, compact(newPY));
+			_mm_storeu_ps(rotation + write, compact(newRotation));
+			_mm_storeu_ps(remaining + write, compact(newRemaining));
+			_mm_storeu_ps(angularVelocity + write, compact(_mm_loadu_ps(angularVelocity + i)));
+			_mm_storeu_ps(startLifeTime + write, compact(_mm_loadu_ps(startLifeTime + i)));
+			_mm_storeu_ps(startSize + write, compact(_mm_loadu_ps(startSize + i)));
+
+			for (size_t lane = 0; lane < 4; ++lane)
+			{
+				if ((aliveMask >> lane) & 1)
+				{
+					startColor[write++] = startColor[i + lane];
+				}
+			}
+		}
+
+		for (; i < count; ++i)
+		{
+			const float newRemaining = (remaining[i] - deltaTime);
+
+			if (newRemaining <= 0.0f)
+			{
+				continue;
+			}
+
+			const float newVX = (vx[i] + deltaVelocity.x);
+			const float newVY = (vy[i] + deltaVelocity.y);
+			const float newPX = (px[i] + newVX * deltaTime);
+			const float newPY = (py[i] + newVY * deltaTime);
+			const float newRotation = (rotation[i] + angularVelocity[i] * deltaTime);
+
+			angularVelocity[write] = angularVelocity[i];
+			startLifeTime[write] = startLifeTime[i];
+			startSize[write] = startSize[i];
+			startColor[write] = startColor[i];
+			vx[write] = newVX;
+			vy[write] = newVY;
+			px[write] = newPX;
+			py[write] = newPY;
+			rotation[write] = newRotation;
+			remaining[write] = newRemaining;
+			++write;
+		}
+
+		if (write != count)
+		{
+			resize(write);
+		}
+	}
+
+	inline void ParticleBuffer2D::reserve(const size_t n)
+	{
+		m_positionX.reserve(n);
+		m_positionY.reserve(n);
+		m_velocityX.reserve(n);
+		m_velocityY.reserve(n);
+		m_rotation.reserve(n);
+		m_angularVelocity.reserve(n);
+		m_startLifeTime.reserve(n);
+		m_remainingLifeTime.reserve(n);
+		m_startSize.reserve(n);
+		m_startColor.reserve(n);
+	}
+
+	inline void ParticleBuffer2D::clear() noexcept
+	{
+		m_positionX.clear();
+		m_positionY.clear();
+		m_velocityX.clear();
+		m_velocityY.clear();
+		m_rotation.clear();
+		m_angularVelocity.clear();
+		m_startLifeTime.clear();
+		m_remainingLifeTime.clear();
+		m_startSize.clear();
+		m_startColor.clear();
+	}
+
+	inline size_t ParticleBuffer2D::size() const noexcept
+	{
+		return m_positionX.size();
+	}
+
+	inline bool ParticleBuffer2D::isEmpty() const noexcept
+	{
+		return m_positionX.isEmpty();
+	}
+
+	inline void ParticleBuffer2D::setSizeOverLifeTime(const LifeTimeCurve<float>& curve)
+	{
+		m_sizeOverLifeTime = curve;
+	}
+
+	inline void ParticleBuffer2D::setColorOverLifeTime(const LifeTimeCurve<Float4>& curve)
+	{
+		m_colorOverLifeTime = curve;
+	}
+
+	inline Float2 ParticleBuffer2D::position(const size_t i) const noexcept
+	{
+		return{ m_positionX[i], m_positionY[i] };
+	}
+
+	inline Float2 ParticleBuffer2D::velocity(const size_t i) const noexcept
+	{
+		return{ m_velocityX[i], m_velocityY[i] };
+	}
+
+	inline float ParticleBuffer2D::rotation(const size_t i) const noexcept
+	{
+		return m_rotation[i];
+	}
+
+	inline float ParticleBuffer2D::normalizedAge(const size_t i) const noexcept
+	{
+		return (1.0f - (m_remainingLifeTime[i] / m_startLifeTime[i]));
+	}
+
+	inline float ParticleBuffer2D::currentSize(const size_t i) const noexcept
+	{
+		return (m_startSize[i] * m_sizeOverLifeTime(normalizedAge(i)));
+	}
+
+	inline Float4 ParticleBuffer2D::currentColor(const size_t i) const noexcept
+	{
+		return (m_startColor[i] * m_colorOverLifeTime(normalizedAge(i)));
+	}
+
+	inline void ParticleBuffer2D::resize(const size_t n)
+	{
+		m_positionX.resize(n);
+		m_positionY.resize(n);
+		m_velocityX.resize(n);
+		m_velocityY.resize(n);
+		m_rotation.resize(n);
+		m_angularVelocity.resize(n);
+		m_startLifeTime.resize(n);
+		m_remainingLifeTime.resize(n);
+		m_startSize.resize(n);
+		m_startColor.resize(n);
+	}
+}
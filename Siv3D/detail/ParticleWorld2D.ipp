@@ -0,0 +1,358 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+
+namespace s3d
+{
+	inline ParticleWorld2D::ParticleWorld2D(const uint64 seed)
+		: m_seed{ seed }
+	{
+		// インデックスはすべてのバッチで共通なので、最初に 1 回だけ作る
+		m_buffer.indices.resize(MaxQuadsPerBatch * 2);
+
+		for (size_t i = 0; i < MaxQuadsPerBatch; ++i)
+		{
+			const auto base = static_cast<TriangleIndex::value_type>(i * 4);
+			m_buffer.indices[i * 2] = { base, static_cast<TriangleIndex::value_type>(base + 1), static_cast<TriangleIndex::value_type>(base + 2) };
+			m_buffer.indices[i * 2 + 1] = { base, static_cast<TriangleIndex::value_type>(base + 2), static_cast<TriangleIndex::value_type>(base + 3) };
+		}
+	}
+
+	template <class Emitter, std::enable_if_t<std::is_base_of_v<IEmitter2D, Emitter>>*>
+	inline ParticleWorld2D::EffectID ParticleWorld2D::add(const Vec2& position, const Emitter& emitter, const ParticleSystem2DParameters& parameters, const Texture& texture, const Vec2& force)
+	{
+		return add(position, std::make_unique<Emitter>(emitter), parameters, texture, force);
+	}
+
+	inline ParticleWorld2D::EffectID ParticleWorld2D::add(const Vec2& position, std::unique_ptr<IEmitter2D>&& emitter, const ParticleSystem2DParameters& parameters, const Texture& texture, const Vec2& force)
+	{
+		if (not emitter)
+		{
+			throw Error{ U"ParticleWorld2D::add(): emitter is null" };
+		}
+
+		EffectID id;
+
+		if (m_freeIDs)
+		{
+			id = m_freeIDs.back();
+			m_freeIDs.pop_back();
+		}
+		else
+		{
+			id = static_cast<EffectID>(m_effects.size());
+			m_effects.emplace_back();
+		}
+
+		auto effect = std::make_unique<Effect>();
+		effect->position = position;
+		effect->force = force;
+		effect->emitter = std::move(emitter);
+		effect->parameters = parameters;
+		effect->texture = texture;
+
+		// 乱数の系列はワールドのシード値とエフェクト ID だけで決まる
+		effect->rng = SmallRNG{ m_seed + (0x9E37'79B9'7F4A'7C15ull * (static_cast<uint64>(id) + 1)) };
+
+		// パーティクルごとに std::function を呼ばないよう、出現時の値を 1 としたときの係数を標本化しておく
+		if (const auto& f = parameters.sizeOverLifeTimeFunc)
+		{
+			effect->particles.setSizeOverLifeTime(LifeTimeCurve<float>::Generate(CurveResolution,
+				[&](const float t) { return f(1.0f, 1.0f, (1.0f - t)); }));
+		}
+
+		if (const auto& f = parameters.colorOverLifeTimeFunc)
+		{
+			effect->particles.setColorOverLifeTime(LifeTimeCurve<Float4>::Generate(CurveResolution,
+				[&](const float t) { return f(Float4{ 1.0f, 1.0f, 1.0f, 1.0f }, 1.0f, (1.0f - t)); }));
+		}
+
+		effect->particles.reserve(static_cast<size_t>(Max(parameters.maxParticles, 0.0)));
+
+		m_effects[id] = std::move(effect);
+
+		return id;
+	}
+
+	inline void ParticleWorld2D::remove(const EffectID id)
+	{
+		if (not contains(id))
+		{
+			return;
+		}
+
+		m_effects[id].reset();
+		m_freeIDs.push_back(id);
+	}
+
+	inline void ParticleWorld2D::clear()
+	{
+		m_effects.clear();
+		m_freeIDs.clear();
+	}
+
+	inline bool ParticleWorld2D::contains(const EffectID id) const noexcept
+	{
+		return ((id < m_effects.size()) && m_effects[id]);
+	}
+
+	inline void ParticleWorld2D::setPosition(const EffectID id, const Vec2& position)
+	{
+		get(id).position = position;
+	}
+
+	inline void ParticleWorld2D::setForce(const EffectID id, const Vec2& force)
+	{
+		get(id).force = force;
+	}
+
+	inline void ParticleWorld2D::setEmitting(const EffectID id, const bool emitting)
+	{
+		Effect& effect = get(id);
+		effect.emitting = emitting;
+
+		if (not emitting)
+		{
+			effect.emissionAccumulator = 0.0;
+		}
+	}
+
+	inline void ParticleWorld2D::burst(const EffectID id, const size_t count)
+	{
+		get(id).pendingBurst += count;
+	}
+
+	inline void ParticleWorld2D::update(const double deltaTime)
+	{
+		const float dt = static_cast<float>(deltaTime);
+
+		// エフェクトどうしは状態を共有しないので、エフェクト単位で分けて更新できる
+		const auto updateRange = [&](const size_t first, const size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					if (m_effects[i])
+					{
+						UpdateEffect(*m_effects[i], dt);
+					}
+				}
+			};
+
+	# ifndef SIV3D_NO_CONCURRENT_API
+
+		ThreadPool::Global().parallelFor(0, m_effects.size(), updateRange);
+
+	# else
+
+		updateRange(0, m_effects.size());
+
+	# endif
+	}
+
+	inline void ParticleWorld2D::draw() const
+	{
+		m_drawOrder.clear();
+
+		for (EffectID id = 0; id < m_effects.size(); ++id)
+		{
+			if (m_effects[id] && (not m_effects[id]->particles.isEmpty()))
+			{
+				m_drawOrder.push_back(id);
+			}
+		}
+
+		if (not m_drawOrder)
+		{
+			return;
+		}
+
+		// 同じブレンドステートとテクスチャのエフェクトを隣り合わせ、まとめて描けるようにする
+		std::sort(m_drawOrder.begin(), m_drawOrder.end(), [&](const EffectID a, const EffectID b)
+			{
+				const Effect& ea = *m_effects[a];
+				const Effect& eb = *m_effects[b];
+				const auto ka = std::make_tuple(ea.parameters.blendState.asValue(), ea.texture.id().value(), a);
+				const auto kb = std::make_tuple(eb.parameters.blendState.asValue(), eb.texture.id().value(), b);
+				return (ka < kb);
+			});
+
+		m_drawOffsets.resize(m_drawOrder.size() + 1);
+		m_drawOffsets[0] = 0;
+
+		for (size_t i = 0; i < m_drawOrder.size(); ++i)
+		{
+			m_drawOffsets[i + 1] = (m_drawOffsets[i] + m_effects[m_drawOrder[i]]->particles.size());
+		}
+
+		m_vertices.resize(m_drawOffsets.back() * 4);
+
+		// 頂点の生成はエフェクトごとに書き込み先が決まっているので並列に行い、描画だけをメインスレッドで行う
+		const auto writeRange = [&](const size_t first, const size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					WriteQuads(*m_effects[m_drawOrder[i]], (m_vertices.data() + m_drawOffsets[i] * 4));
+				}
+			};
+
+	# ifndef SIV3D_NO_CONCURRENT_API
+
+		ThreadPool::Global().parallelFor(0, m_drawOrder.size(), writeRange);
+
+	# else
+
+		writeRange(0, m_drawOrder.size());
+
+	# endif
+
+		for (size_t first = 0; first < m_drawOrder.size();)
+		{
+			const Effect& effect = *m_effects[m_drawOrder[first]];
+			size_t last = (first + 1);
+
+			while ((last < m_drawOrder.size())
+				&& (m_effects[m_drawOrder[last]]->parameters.blendState == effect.parameters.blendState)
+				&& (m_effects[m_drawOrder[last]]->texture.id() == effect.texture.id()))
+			{
+				++last;
+			}
+
+			const ScopedRenderStates2D blend{ effect.parameters.blendState };
+
+			for (size_t quad = m_drawOffsets[first]; quad < m_drawOffsets[last]; quad += MaxQuadsPerBatch)
+			{
+				drawBatch(effect.texture, quad, Min(MaxQuadsPerBatch, (m_drawOffsets[last] - quad)));
+			}
+
+			first = last;
+		}
+	}
+
+	inline size_t ParticleWorld2D::num_effects() const noexcept
+	{
+		return (m_effects.size() - m_freeIDs.size());
+	}
+
+	inline size_t ParticleWorld2D::num_particles() const noexcept
+	{
+		size_t count = 0;
+
+		for (const auto& effect : m_effects)
+		{
+			if (effect)
+			{
+				count += effect->particles.size();
+			}
+		}
+
+		return count;
+	}
+
+	inline ParticleWorld2D::Effect& ParticleWorld2D::get(const EffectID id)
+	{
+		if (not contains(id))
+		{
+			throw Error{ U"ParticleWorld2D: unknown effect ID" };
+		}
+
+		return *m_effects[id];
+	}
+
+	inline void ParticleWorld2D::UpdateEffect(Effect& effect, const float deltaTime)
+	{
+		const ParticleSystem2DParameters& parameters = effect.parameters;
+
+		effect.particles.update(deltaTime, Float2{ (effect.force.x * deltaTime), (effect.force.y * deltaTime) });
+
+		size_t count = effect.pendingBurst;
+		effect.pendingBurst = 0;
+
+		if (effect.emitting)
+		{
+			effect.emissionAccumulator += (parameters.rate * deltaTime);
+			const double n = std::floor(effect.emissionAccumulator);
+			effect.emissionAccumulator -= n;
+			count += static_cast<size_t>(n);
+		}
+
+		const size_t maxParticles = static_cast<size_t>(Max(parameters.maxParticles, 0.0));
+		const size_t current = effect.particles.size();
+		count = Min(count, ((current < maxParticles) ? (maxParticles - current) : 0));
+
+		if (count == 0)
+		{
+			return;
+		}
+
+		effect.emissions.resize(count);
+		EmitN(effect.emissions, *effect.emitter, effect.position, parameters.startSpeed, effect.rng);
+
+		const Float4 startColor = parameters.startColor.toFloat4();
+		const float startSize = static_cast<float>(parameters.startSize);
+		const float lifeTime = static_cast<float>(parameters.startLifeTime);
+
+		if ((parameters.randomStartRotationDeg == 0.0) && (parameters.randomStartAngularVelocityDeg == 0.0))
+		{
+			effect.particles.append(effect.emissions, startColor, startSize,
+				static_cast<float>(Math::ToRadians(parameters.startRotationDeg)),
+				static_cast<float>(Math::ToRadians(parameters.startAngularVelocityDeg)), lifeTime);
+			return;
+		}
+
+		for (const auto& emission : effect.emissions)
+		{
+			const double rotation = (parameters.startRotationDeg + parameters.randomStartRotationDeg * (detail::EmitterUniform(effect.rng) * 2.0 - 1.0));
+			const double angularVelocity = (parameters.startAngularVelocityDeg + parameters.randomStartAngularVelocityDeg * (detail::EmitterUniform(effect.rng) * 2.0 - 1.0));
+
+			effect.particles.add(emission, startColor, startSize,
+				static_cast<float>(Math::ToRadians(rotation)), static_cast<float>(Math::ToRadians(angularVelocity)), lifeTime);
+		}
+	}
+
+	inline void ParticleWorld2D::WriteQuads(const Effect& effect, Vertex2D* pVertex) noexcept
+	{
+		const ParticleBuffer2D& particles = effect.particles;
+
+		for (size_t i = 0; i < particles.size(); ++i)
+		{
+			const Float2 position = particles.position(i);
+			const float half = (particles.currentSize(i) * 0.5f);
+			const Float4 color = particles.currentColor(i);
+			const auto [s, c] = FastMath::SinCos(particles.rotation(i));
+
+			// 回転した (half, 0) と (0, half)
+			const Float2 ax{ (half * c), (half * s) };
+			const Float2 ay{ (-half * s), (half * c) };
+
+			pVertex[0] = { (position - ax - ay), Float2{ 0.0f, 0.0f }, color };
+			pVertex[1] = { (position + ax - ay), Float2{ 1.0f, 0.0f }, color };
+			pVertex[2] = { (position + ax + ay), Float2{ 1.0f, 1.0f }, color };
+			pVertex[3] = { (position - ax + ay), Float2{ 0.0f, 1.0f }, color };
+			pVertex += 4;
+		}
+	}
+
+	inline void ParticleWorld2D::drawBatch(const Texture& texture, const size_t firstQuad, const size_t numQuads) const
+	{
+		const auto first = (m_vertices.begin() + firstQuad * 4);
+		m_buffer.vertices.assign(first, (first + numQuads * 4));
+
+		if (texture.isEmpty())
+		{
+			m_buffer.drawSubset(0, (numQuads * 2));
+		}
+		else
+		{
+			m_buffer.drawSubset(0, (numQuads * 2), texture);
+		}
+	}
+}
@@ -13,6 +13,111 @@
 
 namespace s3d
 {
+	namespace detail
+	{
+		/// @brief `BasicPerlinNoise::generate2D()` で、複数の点をまとめて計算するための SIMD 演算
+		template <class Float>
+		struct PerlinNoiseLanes;
+
+		template <>
+		struct PerlinNoiseLanes<float>
+		{
+			using vector_type = __m128;
+
+			static constexpr size_t Size = 4;
+
+			static vector_type Set(const float value) noexcept { return _mm_set1_ps(value); }
+
+			static vector_type Indices(const size_t first) noexcept
+			{
+				const float f = static_cast<float>(first);
+				return _mm_setr_ps(f, static_cast<float>(first + 1), static_cast<float>(first + 2), static_cast<float>(first + 3));
+			}
+
+			static vector_type Load(const float* p) noexcept { return _mm_loadu_ps(p); }
+
+			static void Store(float* p, const vector_type v) noexcept { _mm_storeu_ps(p, v); }
+
+			static vector_type Add(const vector_type a, const vector_type b) noexcept { return _mm_add_ps(a, b); }
+
+			static vector_type Sub(const vector_type a, const vector_type b) noexcept { return _mm_sub_ps(a, b); }
+
+			static vector_type Mul(const vector_type a, const vector_type b) noexcept { return _mm_mul_ps(a, b); }
+
+			static vector_type Floor(const vector_type v) noexcept { return _mm_floor_ps(v); }
+
+			static void ToCells(const vector_type floored, int32* cells) noexcept
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(cells), _mm_and_si128(_mm_cvttps_epi32(floored), _mm_set1_epi32(255)));
+			}
+		};
+
+		template <>
+		struct PerlinNoiseLanes<double>
+		{
+			using vector_type = __m128d;
+
+			static constexpr size_t Size = 2;
+
+			static vector_type Set(const double value) noexcept { return _mm_set1_pd(value); }
+
+			static vector_type Indices(const size_t first) noexcept { return _mm_setr_pd(static_cast<double>(first), static_cast<double>(first + 1)); }
+
+			static vector_type Load(const double* p) noexcept { return _mm_loadu_pd(p); }
+
+			static void Store(double* p, const vector_type v) noexcept { _mm_storeu_pd(p, v); }
+
+			static vector_type Add(const vector_type a, const vector_type b) noexcept { return _mm_add_pd(a, b); }
+
+			static vector_type Sub(const vector_type a, const vector_type b) noexcept { return _mm_sub_pd(a, b); }
+
+			static vector_type Mul(const vector_type a, const vector_type b) noexcept { return _mm_mul_pd(a, b); }
+
+			static vector_type Floor(const vector_type v) noexcept { return _mm_floor_pd(v); }
+
+			static void ToCells(const vector_type floored, int32* cells) noexcept
+			{
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(cells), _mm_and_si128(_mm_cvttpd_epi32(floored), _mm_set1_epi32(255)));
+			}
+		};
+
+		/// @brief ある行のあるセルの 8 つの頂点の勾配の寄与を、x 方向の係数 s と定数 c に分けたもの
+		/// @remark 頂点 k の寄与は s[k] * (fx - dx) + c[k] で、`BasicPerlinNoise::Grad()` と同じ値になります。
+		template <class Float>
+		struct PerlinNoiseCell
+		{
+			std::array<Float, 8> s;
+
+			std::array<Float, 8> c;
+		};
+
+		/// @brief `BasicPerlinNoise::Grad()` を、x 方向の係数と、y, z から決まる定数に分けます。
+		template <class Float>
+		inline constexpr void SplitPerlinGrad(const uint8 hash, const Float y, const Float z, Float& s, Float& c) noexcept
+		{
+			const uint8 h = (hash & 15);
+
+			if (h < 8)
+			{
+				// u = x
+				s = ((h & 1) ? Float(-1) : Float(1));
+				const Float v = ((h < 4) ? y : z);
+				c = ((h & 2) ? -v : v);
+			}
+			else if ((h == 12) || (h == 14))
+			{
+				// u = y, v = x
+				c = ((h & 1) ? -y : y);
+				s = ((h & 2) ? Float(-1) : Float(1));
+			}
+			else
+			{
+				// u = y, v = z
+				s = 0;
+				c = (((h & 1) ? -y : y) + ((h & 2) ? -z : z));
+			}
+		}
+	}
 	template <class Float>
 	inline constexpr BasicPerlinNoise<Float>::BasicPerlinNoise() noexcept
 		: m_perm{ 151,160,137,91,90,15,
@@ -289,6 +394,25 @@ namespace s3d
 	}
 
 
+	template <class Float>
+	inline void BasicPerlinNoise<Float>::generate2D(Grid<value_type>& grid, const Vector2D<value_type> origin, const value_type step, const int32 octaves, const value_type persistence) const
+	{
+		generateRows(grid, origin, step, octaves, persistence, 0, grid.height());
+	}
+
+# ifndef SIV3D_NO_CONCURRENT_API
+
+	template <class Float>
+	inline void BasicPerlinNoise<Float>::parallel_generate2D(Grid<value_type>& grid, const Vector2D<value_type> origin, const value_type step, const int32 octaves, const value_type persistence) const
+	{
+		ThreadPool::Global().parallelFor(0, grid.height(), [&](const size_t firstRow, const size_t lastRow)
+			{
+				generateRows(grid, origin, step, octaves, persistence, firstRow, lastRow);
+			});
+	}
+
+# endif
+
 	template <class Float>
 	inline constexpr const typename BasicPerlinNoise<Float>::state_type& BasicPerlinNoise<Float>::serialize() const noexcept
 	{
@@ -321,4 +445,179 @@ namespace s3d
 		const Float v = h < 4 ? y : h == 12 || h == 14 ? x : z;
 		return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
 	}
+
+	template <class Float>
+	inline void BasicPerlinNoise<Float>::generateRows(Grid<value_type>& grid, const Vector2D<value_type> origin, const value_type step, const int32 octaves, const value_type persistence, const size_t firstRow, const size_t lastRow) const
+	{
+		const size_t width = grid.width();
+
+		if constexpr (not (std::is_same_v<Float, float> || std::is_same_v<Float, double>))
+		{
+			for (size_t y = firstRow; y < lastRow; ++y)
+			{
+				for (size_t x = 0; x < width; ++x)
+				{
+					grid[y][x] = octave2D((origin.x + static_cast<value_type>(x) * step), (origin.y + static_cast<value_type>(y) * step), octaves, persistence);
+				}
+			}
+		}
+		else
+		{
+			using Lanes = detail::PerlinNoiseLanes<Float>;
+			using Vector = typename Lanes::vector_type;
+			constexpr size_t L = Lanes::Size;
+
+			// noise2D() と同じく z は固定
+			const value_type z = static_cast<value_type>(0.12345678901234567890);
+			const value_type _z = std::floor(z);
+			const int32 iz = (static_cast<int32>(_z) & 255);
+			const value_type fz = (z - _z);
+			const Vector w = Lanes::Set(Fade(fz));
+
+			const Vector one = Lanes::Set(1);
+			const Vector fadeA = Lanes::Set(6);
+			const Vector fadeB = Lanes::Set(15);
+			const Vector fadeC = Lanes::Set(10);
+
+			const auto fade = [&](const Vector t)
+				{
+					// t * t * t * (t * (t * 6 - 15) + 10)
+					return Lanes::Mul(Lanes::Mul(Lanes::Mul(t, t), t), Lanes::Add(Lanes::Mul(t, Lanes::Sub(Lanes::Mul(t, fadeA), fadeB)), fadeC));
+				};
+
+			const auto lerp = [](const Vector a, const Vector b, const Vector t)
+				{
+					return Lanes::Add(a, Lanes::Mul(Lanes::Sub(b, a), t));
+				};
+
+			// 行とオクターブごとに、使うセルの勾配だけを計算して使い回す
+			Array<detail::PerlinNoiseCell<Float>> cells(256);
+			Array<uint32> cellStamps(256, 0);
+			uint32 stamp = 0;
+
+			alignas(16) int32 cellIndices[L] = {};
+			alignas(16) Float gather[16][L] = {};
+			alignas(16) Float tail[L] = {};
+
+			for (size_t row = firstRow; row < lastRow; ++row)
+			{
+				value_type* const out = grid[row];
+				std::fill(out, (out + width), value_type(0));
+
+				value_type y = (origin.y + static_cast<value_type>(row) * step);
+				value_type scale = 1;
+				value_type amplitude = 1;
+
+				for (int32 octave = 0; octave < octaves; ++octave)
+				{
+					++stamp;
+
+					const value_type _y = std::floor(y);
+					const int32 iy = (static_cast<int32>(_y) & 255);
+					const value_type fy = (y - _y);
+					const Vector v = Lanes::Set(Fade(fy));
+					const Vector scaleV = Lanes::Set(scale);
+					const Vector amplitudeV = Lanes::Set(amplitude);
+
+					const auto getCell = [&](const int32 ix) -> const detail::PerlinNoiseCell<Float>&
+						{
+							detail::PerlinNoiseCell<Float>& cell = cells[ix];
+
+							if (cellStamps[ix] == stamp)
+							{
+								return cell;
+							}
+
+							cellStamps[ix] = stamp;
+
+							const uint8 A = (m_perm[ix] + iy) & 255;
+							const uint8 B = (m_perm[(ix + 1) & 255] + iy) & 255;
+							const uint8 AA = (m_perm[A] + iz) & 255;
+							const uint8 AB = (m_perm[(A + 1) & 255] + iz) & 255;
+							const uint8 BA = (m_perm[B] + iz) & 255;
+							const uint8 BB = (m_perm[(B + 1) & 255] + iz) & 255;
+
+							// noise3D() の p0 ~ p7 と同じ順
+							const uint8 hashes[8] = { m_perm[AA], m_perm[BA], m_perm[AB], m_perm[BB],
+								m_perm[(AA + 1) & 255], m_perm[(BA + 1) & 255], m_perm[(AB + 1) & 255], m_perm[(BB + 1) & 255] };
+
+							for (size_t k = 0; k < 8; ++k)
+							{
+								detail::SplitPerlinGrad<Float>(hashes[k], ((k & 2) ? (fy - 1) : fy), ((k & 4) ? (fz - 1) : fz), cell.s[k], cell.c[k]);
+							}
+
+							return cell;
+						};
+
+					for (size_t x = 0; x < width; x += L)
+					{
+						const Vector px = Lanes::Mul(Lanes::Add(Lanes::Set(origin.x), Lanes::Mul(Lanes::Indices(x), Lanes::Set(step))), scaleV);
+						const Vector floored = Lanes::Floor(px);
+						const Vector fx = Lanes::Sub(px, floored);
+						const Vector fx1 = Lanes::Sub(fx, one);
+						const Vector u = fade(fx);
+
+						Lanes::ToCells(floored, cellIndices);
+
+						Vector p[8];
+
+						if (std::all_of(cellIndices, (cellIndices + L), [&](const int32 i) { return (i == cellIndices[0]); }))
+						{
+							// すべての点が同じセルにある
+							const auto& cell = getCell(cellIndices[0]);
+
+							for (size_t k = 0; k < 8; ++k)
+							{
+								p[k] = Lanes::Add(Lanes::Mul(Lanes::Set(cell.s[k]), ((k & 1) ? fx1 : fx)), Lanes::Set(cell.c[k]));
+							}
+						}
+						else
+						{
+							for (size_t lane = 0; lane < L; ++lane)
+							{
+								const auto& cell = getCell(cellIndices[lane]);
+
+								for (size_t k = 0; k < 8; ++k)
+								{
+									gather[k][lane] = cell.s[k];
+									gather[8 + k][lane] = cell.c[k];
+								}
+							}
+
+							for (size_t k = 0; k < 8; ++k)
+							{
+								p[k] = Lanes::Add(Lanes::Mul(Lanes::Load(gather[k]), ((k & 1) ? fx1 : fx)), Lanes::Load(gather[8 + k]));
+							}
+						}
+
+						const Vector q0 = lerp(p[0], p[1], u);
+						const Vector q1 = lerp(p[2], p[3], u);
+						const Vector q2 = lerp(p[4], p[5], u);
+						const Vector q3 = lerp(p[6], p[7], u);
+						const Vector r0 = lerp(q0, q1, v);
+						const Vector r1 = lerp(q2, q3, v);
+						const Vector noise = lerp(r0, r1, w);
+
+						if ((x + L) <= width)
+						{
+							Lanes::Store((out + x), Lanes::Add(Lanes::Load(out + x), Lanes::Mul(noise, amplitudeV)));
+						}
+						else
+						{
+							Lanes::Store(tail, Lanes::Mul(noise, amplitudeV));
+
+							for (size_t i = x; i < width; ++i)
+							{
+								out[i] += tail[i - x];
+							}
+						}
+					}
+
+					y *= 2;
+					scale *= 2;
+					amplitude *= persistence;
+				}
+			}
+		}
+	}
 }
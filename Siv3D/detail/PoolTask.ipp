@@ -0,0 +1,307 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+
+namespace s3d
+{
+	namespace detail
+	{
+		struct PoolTaskVoid {};
+
+		template <class Type>
+		using PoolTaskStorage = std::conditional_t<std::is_void_v<Type>, PoolTaskVoid, Type>;
+
+		template <class Type, class Fty>
+		struct PoolTaskThenResult
+		{
+			using type = std::invoke_result_t<Fty, Type>;
+		};
+
+		template <class Fty>
+		struct PoolTaskThenResult<void, Fty>
+		{
+			using type = std::invoke_result_t<Fty>;
+		};
+
+		template <class Type>
+		struct PoolTaskState
+		{
+			std::mutex mutex;
+
+			std::condition_variable condition;
+
+			bool ready = false;
+
+			std::optional<PoolTaskStorage<Type>> value;
+
+			std::exception_ptr exception;
+
+			// 完了時に呼ばれる関数。完了したスレッドでそのまま呼ばれるため、軽い処理だけを登録する
+			std::vector<std::function<void()>> callbacks;
+
+			void complete()
+			{
+				std::vector<std::function<void()>> callbacksToRun;
+
+				{
+					std::lock_guard lock{ mutex };
+					ready = true;
+					callbacksToRun.swap(callbacks);
+				}
+
+				condition.notify_all();
+
+				for (auto& callback : callbacksToRun)
+				{
+					callback();
+				}
+			}
+
+			void setValue(PoolTaskStorage<Type>&& _value)
+			{
+				value.emplace(std::move(_value));
+				complete();
+			}
+
+			void setException(std::exception_ptr _exception)
+			{
+				exception = std::move(_exception);
+				complete();
+			}
+
+			void onReady(std::function<void()> callback)
+			{
+				{
+					std::lock_guard lock{ mutex };
+
+					if (not ready)
+					{
+						callbacks.push_back(std::move(callback));
+						return;
+					}
+				}
+
+				callback();
+			}
+
+			[[nodiscard]]
+			bool isReady()
+			{
+				std::lock_guard lock{ mutex };
+				return ready;
+			}
+
+			void wait()
+			{
+				ThreadPool& pool = ThreadPool::Global();
+
+				for (;;)
+				{
+					if (isReady())
+					{
+						return;
+					}
+
+					// ワーカースレッドから待っても詰まらないよう、待つ間は未実行のタスクを進める
+					if (pool.tryRunPendingTask())
+					{
+						continue;
+					}
+
+					std::unique_lock lock{ mutex };
+					condition.wait_for(lock, std::chrono::milliseconds{ 1 }, [this]() { return ready; });
+				}
+			}
+		};
+
+		/// @brief f(args...) を実行し、その結果または例外を state に格納します。
+		template <class Type, class Fty, class... Args>
+		void RunPoolTask(PoolTaskState<Type>& state, Fty&& f, Args&&... args)
+		{
+			// 完了時に呼ばれる関数が投げた例外を f の例外として扱わないよう、完了の通知は try の外で行う
+			std::optional<PoolTaskStorage<Type>> result;
+
+			try
+			{
+				if constexpr (std::is_void_v<Type>)
+				{
+					std::invoke(std::forward<Fty>(f), std::forward<Args>(args)...);
+					result.emplace();
+				}
+				else
+				{
+					result.emplace(std::invoke(std::forward<Fty>(f), std::forward<Args>(args)...));
+				}
+			}
+			catch (...)
+			{
+				state.setException(std::current_exception());
+				return;
+			}
+
+			state.setValue(std::move(*result));
+		}
+	}
+
+	template <class Type>
+	inline PoolTask<Type>::PoolTask(std::shared_ptr<detail::PoolTaskState<Type>> state) noexcept
+		: m_state{ std::move(state) } {}
+
+	template <class Type>
+	inline bool PoolTask<Type>::isValid() const noexcept
+	{
+		return static_cast<bool>(m_state);
+	}
+
+	template <class Type>
+	inline bool PoolTask<Type>::isReady() const
+	{
+		return (m_state && m_state->isReady());
+	}
+
+	template <class Type>
+	inline void PoolTask<Type>::wait() const
+	{
+		if (m_state)
+		{
+			m_state->wait();
+		}
+	}
+
+	template <class Type>
+	inline Type PoolTask<Type>::get()
+	{
+		const auto state = std::move(m_state);
+		state->wait();
+
+		if (state->exception)
+		{
+			std::rethrow_exception(state->exception);
+		}
+
+		if constexpr (not std::is_void_v<Type>)
+		{
+			return std::move(*state->value);
+		}
+	}
+
+	template <class Type>
+	template <class Fty>
+	inline auto PoolTask<Type>::then(Fty&& f)
+	{
+		using Result = typename detail::PoolTaskThenResult<Type, std::decay_t<Fty>>::type;
+
+		auto antecedent = std::move(m_state);
+		auto next = std::make_shared<detail::PoolTaskState<Result>>();
+
+		antecedent->onReady([antecedent, next, f = std::decay_t<Fty>(std::forward<Fty>(f))]() mutable
+			{
+				if (antecedent->exception)
+				{
+					next->setException(antecedent->exception);
+					return;
+				}
+
+				ThreadPool::Global().submit([antecedent = std::move(antecedent), next = std::move(next), f = std::move(f)]() mutable
+					{
+						if constexpr (std::is_void_v<Type>)
+						{
+							detail::RunPoolTask(*next, std::move(f));
+						}
+						else
+						{
+							detail::RunPoolTask(*next, std::move(f), std::move(*antecedent->value));
+						}
+					});
+			});
+
+		return PoolTask<Result>{ std::move(next) };
+	}
+
+	template <class Fty, class... Args, std::enable_if_t<std::is_invocable_v<std::decay_t<Fty>, std::decay_t<Args>...>>*>
+	inline auto PoolAsync(Fty&& f, Args&&... args)
+	{
+		using Result = std::invoke_result_t<std::decay_t<Fty>, std::decay_t<Args>...>;
+
+		auto state = std::make_shared<detail::PoolTaskState<Result>>();
+
+		ThreadPool::Global().submit([state, f = std::forward<Fty>(f), ...args = std::forward<Args>(args)]() mutable
+			{
+				detail::RunPoolTask(*state, std::move(f), std::move(args)...);
+			});
+
+		return PoolTask<Result>{ std::move(state) };
+	}
+
+	template <class Type>
+	inline auto WhenAll(Array<PoolTask<Type>> tasks)
+	{
+		using Result = std::conditional_t<std::is_void_v<Type>, void, Array<Type>>;
+
+		auto next = std::make_shared<detail::PoolTaskState<Result>>();
+
+		if (not tasks)
+		{
+			next->setValue(detail::PoolTaskStorage<Result>{});
+			return PoolTask<Result>{ std::move(next) };
+		}
+
+		// 最後に完了したタスクが結果をまとめる
+		auto remaining = std::make_shared<std::atomic<size_t>>(tasks.size());
+		auto states = std::make_shared<Array<std::shared_ptr<detail::PoolTaskState<Type>>>>();
+		states->reserve(tasks.size());
+
+		for (auto& task : tasks)
+		{
+			states->push_back(std::move(task.m_state));
+		}
+
+		for (const auto& state : *states)
+		{
+			state->onReady([next, remaining, states]()
+				{
+					if (remaining->fetch_sub(1, std::memory_order_acq_rel) != 1)
+					{
+						return;
+					}
+
+					for (const auto& s : *states)
+					{
+						if (s->exception)
+						{
+							next->setException(s->exception);
+							return;
+						}
+					}
+
+					if constexpr (std::is_void_v<Type>)
+					{
+						next->setValue(detail::PoolTaskVoid{});
+					}
+					else
+					{
+						Array<Type> results;
+						results.reserve(states->size());
+
+						for (const auto& s : *states)
+						{
+							results.push_back(std::move(*s->value));
+						}
+
+						next->setValue(std::move(results));
+					}
+				});
+		}
+
+		return PoolTask<Result>{ std::move(next) };
+	}
+}
@@ -0,0 +1,206 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+
+namespace s3d
+{
+	inline ScopeProfiler::ScopeID ScopeProfiler::Register(const char* name)
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard lock{ registry.mutex };
+
+		const size_t scopeCount = registry.scopeCount.load(std::memory_order_relaxed);
+
+		for (size_t i = 0; i < scopeCount; ++i)
+		{
+			if (std::strcmp(registry.names[i], name) == 0)
+			{
+				return static_cast<ScopeID>(i);
+			}
+		}
+
+		// 登録数の上限を超えたスコープは計測しない
+		if (scopeCount == MaxScopes)
+		{
+			return static_cast<ScopeID>(MaxScopes);
+		}
+
+		registry.names[scopeCount] = name;
+		registry.scopeCount.store((scopeCount + 1), std::memory_order_release);
+
+		return static_cast<ScopeID>(scopeCount);
+	}
+
+	inline void ScopeProfiler::Record(const ScopeID id, const uint64 nanoseconds) noexcept
+	{
+		if (MaxScopes <= id)
+		{
+			return;
+		}
+
+		ThreadBuffer* threadBuffer = GetThreadBuffer();
+
+		if (not threadBuffer)
+		{
+			return;
+		}
+
+		Ring& ring = threadBuffer->rings[id];
+
+		// このリングに書き込むのは所有スレッドだけなので、インデックスの更新に RMW 操作は要らない
+		const uint32 index = ring.writeIndex.load(std::memory_order_relaxed);
+		const uint32 sample = static_cast<uint32>(Min<uint64>(nanoseconds, UINT32_MAX));
+		ring.samples[index % BufferSize].store(sample, std::memory_order_relaxed);
+		ring.writeIndex.store((index + 1), std::memory_order_release);
+	}
+
+	inline const char* ScopeProfiler::GetName(const ScopeID id) noexcept
+	{
+		const Registry& registry = GetRegistry();
+
+		if (registry.scopeCount.load(std::memory_order_acquire) <= id)
+		{
+			return "";
+		}
+
+		return registry.names[id];
+	}
+
+	inline Array<ScopeProfiler::Stat> ScopeProfiler::GetStats()
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard lock{ registry.mutex };
+
+		const size_t scopeCount = registry.scopeCount.load(std::memory_order_acquire);
+		Array<Stat> stats(scopeCount);
+		Array<uint32> samples;
+
+		for (size_t scopeIndex = 0; scopeIndex < scopeCount; ++scopeIndex)
+		{
+			samples.clear();
+
+			for (const auto& threadBuffer : registry.threadBuffers)
+			{
+				const Ring& ring = threadBuffer->rings[scopeIndex];
+				const uint32 writeIndex = ring.writeIndex.load(std::memory_order_acquire);
+				const uint32 count = Min<uint32>(writeIndex, static_cast<uint32>(BufferSize));
+
+				for (uint32 i = 0; i < count; ++i)
+				{
+					samples.push_back(ring.samples[(writeIndex - 1 - i) % BufferSize].load(std::memory_order_relaxed));
+				}
+			}
+
+			Stat& stat = stats[scopeIndex];
+			stat.name = registry.names[scopeIndex];
+			stat.count = samples.size();
+
+			if (not samples)
+			{
+				continue;
+			}
+
+			const auto percentile = [&](const size_t percent) -> uint64
+				{
+					const size_t n = Min(((samples.size() * percent) / 100), (samples.size() - 1));
+					std::nth_element(samples.begin(), (samples.begin() + n), samples.end());
+					return samples[n];
+				};
+
+			stat.p50NS = percentile(50);
+			stat.p95NS = percentile(95);
+			stat.p99NS = percentile(99);
+			stat.maxNS = *std::max_element(samples.begin(), samples.end());
+		}
+
+		return stats;
+	}
+
+	inline void ScopeProfiler::Clear() noexcept
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard lock{ registry.mutex };
+
+		for (auto& threadBuffer : registry.threadBuffers)
+		{
+			for (Ring& ring : threadBuffer->rings)
+			{
+				ring.writeIndex.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	inline ScopeProfiler::Registry& ScopeProfiler::GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	inline ScopeProfiler::ThreadBuffer* ScopeProfiler::GetThreadBuffer()
+	{
+		// 他の thread_local 変数のデストラクタから呼ばれても参照できるよう、自明なデストラクタを持つ型で保持する
+		thread_local ThreadBuffer* threadBuffer = nullptr;
+		thread_local bool released = false;
+
+		if (threadBuffer || released)
+		{
+			return threadBuffer;
+		}
+
+		{
+			Registry& registry = GetRegistry();
+			std::lock_guard lock{ registry.mutex };
+
+			// バッファの数はスレッドの総数ではなく、同時に計測するスレッドの最大数で済む
+			if (registry.freeThreadBuffers)
+			{
+				threadBuffer = registry.freeThreadBuffers.back();
+				registry.freeThreadBuffers.pop_back();
+			}
+			else
+			{
+				registry.threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+				threadBuffer = registry.threadBuffers.back().get();
+			}
+		}
+
+		thread_local const ThreadBufferReleaser releaser{ threadBuffer, released };
+
+		return threadBuffer;
+	}
+
+	inline ScopeProfiler::ThreadBufferReleaser::~ThreadBufferReleaser()
+	{
+		// バッファは計測結果を残したまま返し、以降このスレッドでの計測は破棄する
+		Registry& registry = GetRegistry();
+		std::lock_guard lock{ registry.mutex };
+
+		registry.freeThreadBuffers.push_back(threadBuffer);
+		threadBuffer = nullptr;
+		released = true;
+	}
+
+	inline ScopeProfilerTimer::ScopeProfilerTimer(const ScopeProfiler::ScopeID id) noexcept
+		: m_id{ id }
+		, m_begin{ TraceRecorder::Clock::now() } {}
+
+	inline ScopeProfilerTimer::~ScopeProfilerTimer()
+	{
+		const auto end = TraceRecorder::Clock::now();
+		ScopeProfiler::Record(m_id, static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_begin).count()));
+
+		if (TraceRecorder::IsRecording())
+		{
+			TraceRecorder::RecordScope(ScopeProfiler::GetName(m_id), m_begin, end);
+		}
+	}
+}
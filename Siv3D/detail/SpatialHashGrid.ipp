@@ -0,0 +1,273 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+
+namespace s3d
+{
+	template <class Type>
+	inline SpatialHashGrid<Type>::SpatialHashGrid(const double cellSize)
+		: m_cellSize{ cellSize }
+		, m_inverseCellSize{ (1.0 / cellSize) }
+	{
+		assert(0.0 < cellSize);
+	}
+
+	template <class Type>
+	inline SpatialHashGrid<Type>::operator bool() const noexcept
+	{
+		return (not m_entries.empty());
+	}
+
+	template <class Type>
+	inline bool SpatialHashGrid<Type>::isEmpty() const noexcept
+	{
+		return m_entries.empty();
+	}
+
+	template <class Type>
+	inline size_t SpatialHashGrid<Type>::size() const noexcept
+	{
+		return m_entries.size();
+	}
+
+	template <class Type>
+	inline double SpatialHashGrid<Type>::cellSize() const noexcept
+	{
+		return m_cellSize;
+	}
+
+	template <class Type>
+	inline void SpatialHashGrid<Type>::reserve(const size_t n)
+	{
+		m_entries.reserve(n);
+		m_pending.reserve(n);
+		m_keys.reserve(n);
+	}
+
+	template <class Type>
+	inline void SpatialHashGrid<Type>::clear()
+	{
+		m_starts.clear();
+		m_entries.clear();
+		m_pending.clear();
+	}
+
+	template <class Type>
+	inline void SpatialHashGrid<Type>::add(const Vec2& position, const Type& value)
+	{
+		m_pending.push_back(Entry{ position, ToKey(toCell(position)), value });
+	}
+
+	template <class Type>
+	inline void SpatialHashGrid<Type>::build()
+	{
+		buildFrom(m_pending.size(),
+			[this](const size_t i) { return m_pending[i].key; },
+			[this](const size_t i, uint32) -> const Entry& { return m_pending[i]; });
+
+		m_pending.clear();
+	}
+
+	template <class Type>
+	template <class T, std::enable_if_t<std::is_integral_v<T>>*>
+	inline void SpatialHashGrid<Type>::build(const std::span<const Vec2> positions)
+	{
+		buildFrom(positions.size(),
+			[this, positions](const size_t i) { return ToKey(toCell(positions[i])); },
+			[positions](const size_t i, const uint32 key) { return Entry{ positions[i], key, static_cast<Type>(i) }; });
+	}
+
+	template <class Type>
+	inline void SpatialHashGrid<Type>::query(const Circle& circle, Array<Type>& results) const
+	{
+		results.clear();
+
+		forEach(circle, [&results](const Vec2&, const Type& value) { results.push_back(value); });
+	}
+
+	template <class Type>
+	inline void SpatialHashGrid<Type>::query(const RectF& rect, Array<Type>& results) const
+	{
+		results.clear();
+
+		forEach(rect, [&results](const Vec2&, const Type& value) { results.push_back(value); });
+	}
+
+	template <class Type>
+	template <class Fty>
+	inline void SpatialHashGrid<Type>::forEach(const Circle& circle, Fty f) const
+	{
+		const Vec2 extent{ circle.r, circle.r };
+
+		forEachCell(toCell(circle.center - extent), toCell(circle.center + extent), [&](const Entry& entry)
+			{
+				if (Geometry2D::Intersect(entry.position, circle))
+				{
+					f(entry.position, entry.value);
+				}
+			});
+	}
+
+	template <class Type>
+	template <class Fty>
+	inline void SpatialHashGrid<Type>::forEach(const RectF& rect, Fty f) const
+	{
+		forEachCell(toCell(rect.pos), toCell(rect.br()), [&](const Entry& entry)
+			{
+				if (Geometry2D::Intersect(entry.position, rect))
+				{
+					f(entry.position, entry.value);
+				}
+			});
+	}
+
+	template <class Type>
+	template <class Fty>
+	inline void SpatialHashGrid<Type>::forEachPair(const double distance, Fty f) const
+	{
+		const double distanceSq = (distance * distance);
+
+		// distance が届くセルの範囲
+		const int32 reach = static_cast<int32>(std::ceil(distance * m_inverseCellSize));
+
+		const auto visitCell = [&](const Entry& a, const Point cell, size_t first)
+			{
+				const uint32 key = ToKey(cell);
+				const uint32 h = (key & m_tableMask);
+				first = Max<size_t>(first, m_starts[h]);
+
+				for (size_t k = first; k < m_starts[h + 1]; ++k)
+				{
+					const Entry& b = m_entries[k];
+
+					if ((b.key == key) && (a.position.distanceFromSq(b.position) <= distanceSq))
+					{
+						f(a.value, b.value);
+					}
+				}
+			};
+
+		for (size_t i = 0; i < m_entries.size(); ++i)
+		{
+			const Entry& a = m_entries[i];
+			const Point cell = toCell(a.position);
+
+			// 同じセルの要素とは、後ろに並んでいる要素とだけ組にする
+			visitCell(a, cell, (i + 1));
+
+			// 隣のセルとは、各セルの組を 1 度だけ調べるように、前方の半分のセルだけを調べる
+			for (int32 dy = 0; dy <= reach; ++dy)
+			{
+				for (int32 dx = ((dy == 0) ? 1 : -reach); dx <= reach; ++dx)
+				{
+					visitCell(a, (cell + Point{ dx, dy }), 0);
+				}
+			}
+		}
+	}
+
+	template <class Type>
+	inline Point SpatialHashGrid<Type>::toCell(const Vec2& position) const noexcept
+	{
+		return{ static_cast<int32>(std::floor(position.x * m_inverseCellSize)),
+			static_cast<int32>(std::floor(position.y * m_inverseCellSize)) };
+	}
+
+	template <class Type>
+	inline uint32 SpatialHashGrid<Type>::ToKey(const Point cell) noexcept
+	{
+		// ハッシュ値にはモートン順序の下位ビットを使うため、近くのセルは近いハッシュ値になる。
+		// セルの座標は 65536 ごとに同じキーになるが、その距離の要素は検索や組の判定で座標によって除かれる
+		return Morton::Encode2D32(static_cast<uint16>(cell.x), static_cast<uint16>(cell.y));
+	}
+
+	template <class Type>
+	template <class GetKey, class GetEntry>
+	inline void SpatialHashGrid<Type>::buildFrom(const size_t count, GetKey getKey, GetEntry getEntry)
+	{
+		// ハッシュ値の範囲は要素数の 2 倍程度にする。毎フレームの作り直しでメモリを確保し直さないよう、範囲は縮めない
+		const size_t tableSize = Min(std::bit_ceil(Max<size_t>((count * 2), 64)), MaxTableSize);
+
+		if ((m_tableMask + size_t{ 1 }) < tableSize)
+		{
+			m_tableMask = static_cast<uint32>(tableSize - 1);
+		}
+
+		// 計数ソート: m_starts[h + 2] で数え、累積和をとった m_starts[h + 1] を書き込み位置として進めると、
+		// 最後に m_starts[h] がハッシュ値 h の先頭、m_starts[h + 1] が終端になる
+		m_starts.assign((m_tableMask + size_t{ 3 }), 0);
+		m_keys.resize(count);
+		m_entries.resize(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint32 key = getKey(i);
+			m_keys[i] = key;
+			++m_starts[(key & m_tableMask) + 2];
+		}
+
+		for (size_t h = 2; h < m_starts.size(); ++h)
+		{
+			m_starts[h] += m_starts[h - 1];
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint32 key = m_keys[i];
+			m_entries[m_starts[(key & m_tableMask) + 1]++] = getEntry(i, key);
+		}
+	}
+
+	template <class Type>
+	template <class Fty>
+	inline void SpatialHashGrid<Type>::forEachCell(const Point minCell, const Point maxCell, Fty f) const
+	{
+		if (m_entries.empty())
+		{
+			return;
+		}
+
+		const int64 cellCount = ((static_cast<int64>(maxCell.x) - minCell.x + 1) * (static_cast<int64>(maxCell.y) - minCell.y + 1));
+
+		// 要素の数よりも多くのセルにまたがる場合は、すべての要素を調べたほうが速い
+		if (static_cast<int64>(m_entries.size()) <= cellCount)
+		{
+			for (const auto& entry : m_entries)
+			{
+				if (const Point cell = toCell(entry.position);
+					InRange(cell.x, minCell.x, maxCell.x) && InRange(cell.y, minCell.y, maxCell.y))
+				{
+					f(entry);
+				}
+			}
+
+			return;
+		}
+
+		for (int32 y = minCell.y; y <= maxCell.y; ++y)
+		{
+			for (int32 x = minCell.x; x <= maxCell.x; ++x)
+			{
+				const uint32 key = ToKey(Point{ x, y });
+				const uint32 h = (key & m_tableMask);
+
+				for (size_t i = m_starts[h]; i < m_starts[h + 1]; ++i)
+				{
+					if (const Entry& entry = m_entries[i]; (entry.key == key))
+					{
+						f(entry);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,244 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+
+namespace s3d
+{
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty&>>*>
+	inline TaskGraph::NodeID TaskGraph::add(const char* name, Fty&& f, const TaskAffinity affinity)
+	{
+		m_nodes.push_back(Node{ name, ScopeProfiler::Register(name), std::function<void()>(std::forward<Fty>(f)), affinity, {}, 0 });
+		m_validated = false;
+		return (m_nodes.size() - 1);
+	}
+
+	inline TaskGraph& TaskGraph::precede(const NodeID before, const NodeID after)
+	{
+		m_nodes[before].successors.push_back(after);
+		++m_nodes[after].dependencyCount;
+		m_validated = false;
+		return *this;
+	}
+
+	inline TaskGraph& TaskGraph::succeed(const NodeID node, const std::initializer_list<NodeID> dependencies)
+	{
+		for (const NodeID dependency : dependencies)
+		{
+			precede(dependency, node);
+		}
+
+		return *this;
+	}
+
+	inline void TaskGraph::run()
+	{
+		if (m_nodes.isEmpty())
+		{
+			return;
+		}
+
+		validate();
+
+		const size_t numNodes = m_nodes.size();
+
+		if (m_remainingDependenciesSize != numNodes)
+		{
+			m_remainingDependencies = std::make_unique<std::atomic<size_t>[]>(numNodes);
+			m_remainingDependenciesSize = numNodes;
+		}
+
+		for (size_t i = 0; i < numNodes; ++i)
+		{
+			m_remainingDependencies[i].store(m_nodes[i].dependencyCount, std::memory_order_relaxed);
+		}
+
+		m_unfinishedCount.store(numNodes, std::memory_order_relaxed);
+		m_failed.store(false, std::memory_order_relaxed);
+		m_exception = nullptr;
+
+		for (size_t i = 0; i < numNodes; ++i)
+		{
+			if (m_nodes[i].dependencyCount == 0)
+			{
+				schedule(i);
+			}
+		}
+
+		ThreadPool& pool = ThreadPool::Global();
+
+		for (;;)
+		{
+			NodeID id = 0;
+			bool hasMainTask = false;
+
+			{
+				// 完了の判定は、ワーカーが最後の通知を終えてロックを手放した後に行う
+				std::lock_guard lock{ m_mainMutex };
+
+				if (m_unfinishedCount.load(std::memory_order_acquire) == 0)
+				{
+					break;
+				}
+
+				if (not m_mainQueue.empty())
+				{
+					id = m_mainQueue.front();
+					m_mainQueue.pop_front();
+					hasMainTask = true;
+				}
+			}
+
+			if (hasMainTask)
+			{
+				execute(id);
+				continue;
+			}
+
+			// メインスレッドのタスクが無い間は、スレッドプールのタスクを手伝う
+			if (pool.tryRunPendingTask())
+			{
+				continue;
+			}
+
+			std::unique_lock lock{ m_mainMutex };
+			m_mainCondition.wait(lock, [this]()
+				{
+					return ((not m_mainQueue.empty()) || (m_unfinishedCount.load(std::memory_order_acquire) == 0));
+				});
+		}
+
+		if (m_exception)
+		{
+			std::rethrow_exception(m_exception);
+		}
+	}
+
+	inline size_t TaskGraph::size() const noexcept
+	{
+		return m_nodes.size();
+	}
+
+	inline bool TaskGraph::isEmpty() const noexcept
+	{
+		return m_nodes.isEmpty();
+	}
+
+	inline void TaskGraph::clear()
+	{
+		m_nodes.clear();
+		m_validated = false;
+	}
+
+	inline void TaskGraph::validate()
+	{
+		if (m_validated)
+		{
+			return;
+		}
+
+		// 入次数が 0 のタスクから辿り、すべてのタスクに到達できなければ循環している
+		Array<size_t> inDegrees = m_nodes.map([](const Node& node) { return node.dependencyCount; });
+		Array<NodeID> ready;
+
+		for (size_t i = 0; i < m_nodes.size(); ++i)
+		{
+			if (inDegrees[i] == 0)
+			{
+				ready.push_back(i);
+			}
+		}
+
+		size_t visitedCount = 0;
+
+		while (ready)
+		{
+			const NodeID id = ready.back();
+			ready.pop_back();
+			++visitedCount;
+
+			for (const NodeID successor : m_nodes[id].successors)
+			{
+				if (--inDegrees[successor] == 0)
+				{
+					ready.push_back(successor);
+				}
+			}
+		}
+
+		if (visitedCount != m_nodes.size())
+		{
+			throw Error{ U"TaskGraph::run(): The task graph has a cycle" };
+		}
+
+		m_validated = true;
+	}
+
+	inline void TaskGraph::schedule(const NodeID id)
+	{
+		if (m_nodes[id].affinity == TaskAffinity::MainThread)
+		{
+			{
+				std::lock_guard lock{ m_mainMutex };
+				m_mainQueue.push_back(id);
+			}
+
+			m_mainCondition.notify_one();
+		}
+		else
+		{
+			ThreadPool::Global().submit([this, id]() { execute(id); });
+		}
+	}
+
+	inline void TaskGraph::execute(const NodeID id)
+	{
+		const Node& node = m_nodes[id];
+
+		// 例外が起きた後のタスクは実行せず、完了として扱う
+		if (not m_failed.load(std::memory_order_acquire))
+		{
+			const ScopeProfilerTimer timer{ node.scopeID };
+
+			try
+			{
+				node.f();
+			}
+			catch (...)
+			{
+				std::lock_guard lock{ m_mainMutex };
+
+				if (not m_exception)
+				{
+					m_exception = std::current_exception();
+				}
+
+				m_failed.store(true, std::memory_order_release);
+			}
+		}
+
+		for (const NodeID successor : node.successors)
+		{
+			if (m_remainingDependencies[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				schedule(successor);
+			}
+		}
+
+		// 最後の減算と通知をロック内で行うことで、run() が戻った後（グラフの破棄後）にワーカーがメンバへ触れないようにする
+		std::lock_guard lock{ m_mainMutex };
+
+		if (m_unfinishedCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			m_mainCondition.notify_all();
+		}
+	}
+}
@@ -0,0 +1,400 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+
+namespace s3d
+{
+	namespace detail
+	{
+		/// @brief `ThreadPool::parallelFor()` で、分割されていない範囲を参加スレッド間で共有する状態
+		struct ParallelForState
+		{
+			std::atomic<size_t> next;
+
+			std::atomic<size_t> done{ 0 };
+
+			size_t last;
+
+			size_t count;
+
+			// 残りの範囲をこの数で割った大きさずつ取り出す
+			size_t divisor;
+
+			size_t minChunkSize;
+
+			std::atomic<bool> failed{ false };
+
+			std::mutex exceptionMutex;
+
+			std::exception_ptr exception;
+
+			ParallelForState(const size_t _first, const size_t _last, const size_t _divisor, const size_t _minChunkSize)
+				: next{ _first }
+				, last{ _last }
+				, count{ _last - _first }
+				, divisor{ _divisor }
+				, minChunkSize{ _minChunkSize } {}
+
+			[[nodiscard]]
+			bool grab(size_t& chunkFirst, size_t& chunkLast) noexcept
+			{
+				size_t current = next.load(std::memory_order_relaxed);
+
+				for (;;)
+				{
+					const size_t remaining = (last - current);
+
+					if (remaining == 0)
+					{
+						return false;
+					}
+
+					const size_t n = Min(remaining, Max(minChunkSize, (remaining / divisor)));
+
+					if (next.compare_exchange_weak(current, (current + n), std::memory_order_relaxed))
+					{
+						chunkFirst = current;
+						chunkLast = (current + n);
+						return true;
+					}
+				}
+			}
+
+			template <class Fty>
+			void run(Fty& f)
+			{
+				size_t chunkFirst, chunkLast;
+
+				while (grab(chunkFirst, chunkLast))
+				{
+					// 例外が起きた後の範囲は処理せず、完了として数えるだけにする
+					if (not failed.load(std::memory_order_relaxed))
+					{
+						try
+						{
+							f(chunkFirst, chunkLast);
+						}
+						catch (...)
+						{
+							std::lock_guard lock{ exceptionMutex };
+
+							if (not exception)
+							{
+								exception = std::current_exception();
+							}
+
+							failed.store(true, std::memory_order_relaxed);
+						}
+					}
+
+					const size_t n = (chunkLast - chunkFirst);
+
+					if ((done.fetch_add(n, std::memory_order_acq_rel) + n) == count)
+					{
+						done.notify_all();
+					}
+				}
+			}
+
+			void wait() noexcept
+			{
+				for (size_t current = done.load(std::memory_order_acquire); current != count; current = done.load(std::memory_order_acquire))
+				{
+					done.wait(current, std::memory_order_acquire);
+				}
+			}
+		};
+	}
+
+	inline ThreadPool::ThreadPool(const size_t numWorkers)
+	{
+		const size_t workerCount = (numWorkers ? numWorkers : DefaultWorkerCount());
+
+		m_workers.reserve(workerCount);
+
+		for (size_t i = 0; i < workerCount; ++i)
+		{
+			m_workers.push_back(std::make_unique<Worker>());
+		}
+
+		m_threads.reserve(workerCount);
+
+		for (size_t i = 0; i < workerCount; ++i)
+		{
+			m_threads.emplace_back([this, i]() { workerLoop(i); });
+		}
+	}
+
+	inline ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard lock{ m_sleepMutex };
+			m_stopping = true;
+		}
+
+		m_sleepCondition.notify_all();
+
+		for (auto& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	inline size_t ThreadPool::numWorkers() const noexcept
+	{
+		return m_threads.size();
+	}
+
+	template <class Fty, std::enable_if_t<std::is_invocable_v<std::decay_t<Fty>>>*>
+	inline void ThreadPool::submit(Fty&& f)
+	{
+		push(std::make_unique<Task<std::decay_t<Fty>>>(std::decay_t<Fty>(std::forward<Fty>(f))));
+	}
+
+	template <class Fty, class... Args, std::enable_if_t<std::is_invocable_v<std::decay_t<Fty>, std::decay_t<Args>...>>*>
+	inline auto ThreadPool::async(Fty&& f, Args&&... args)
+	{
+		using Result = std::invoke_result_t<std::decay_t<Fty>, std::decay_t<Args>...>;
+
+		std::packaged_task<Result()> task{
+			[f = std::forward<Fty>(f), ...args = std::forward<Args>(args)]() mutable -> Result
+			{
+				return std::invoke(std::move(f), std::move(args)...);
+			} };
+
+		std::future<Result> future = task.get_future();
+
+		submit([task = std::move(task)]() mutable { task(); });
+
+		return future;
+	}
+
+	template <class Fty, std::enable_if_t<std::is_invocable_v<Fty&, size_t, size_t>>*>
+	inline void ThreadPool::parallelFor(const size_t first, const size_t last, Fty&& f, size_t minChunkSize)
+	{
+		if (last <= first)
+		{
+			return;
+		}
+
+		minChunkSize = Max<size_t>(minChunkSize, 1);
+
+		const size_t count = (last - first);
+		const size_t numChunks = ((count + minChunkSize - 1) / minChunkSize);
+		const size_t numHelpers = Min(numWorkers(), (numChunks - 1));
+
+		if (numHelpers == 0)
+		{
+			f(first, last);
+			return;
+		}
+
+		// 参加スレッドあたり 4 回程度に分けて取り出すと、終盤の負荷の偏りが小さくなる
+		const auto state = std::make_shared<detail::ParallelForState>(first, last, ((numHelpers + 1) * 4), minChunkSize);
+		auto* pf = &f;
+
+		// 遅れて実行されたヘルパーは範囲を取り出せずに終わるため、f が破棄された後に呼ばれることはない
+		for (size_t i = 0; i < numHelpers; ++i)
+		{
+			submit([state, pf]() { state->run(*pf); });
+		}
+
+		state->run(f);
+		state->wait();
+
+		if (state->exception)
+		{
+			std::rethrow_exception(state->exception);
+		}
+	}
+
+	inline bool ThreadPool::isWorkerThread() const noexcept
+	{
+		return (CurrentPool() == this);
+	}
+
+	inline bool ThreadPool::tryRunPendingTask()
+	{
+		if (TaskPtr task = pop(isWorkerThread() ? CurrentWorkerIndex() : m_workers.size()))
+		{
+			task->run();
+			return true;
+		}
+
+		return false;
+	}
+
+	inline ThreadPool& ThreadPool::Global()
+	{
+		static ThreadPool pool{ [] { GlobalCreated() = true; return GlobalWorkerCount().load(); }() };
+		return pool;
+	}
+
+	inline bool ThreadPool::SetGlobalWorkerCount(const size_t numWorkers)
+	{
+		if (GlobalCreated())
+		{
+			return false;
+		}
+
+		GlobalWorkerCount() = numWorkers;
+		return true;
+	}
+
+	inline size_t ThreadPool::DefaultWorkerCount() noexcept
+	{
+		return (Max<size_t>(std::thread::hardware_concurrency(), 2) - 1);
+	}
+
+	inline void ThreadPool::push(TaskPtr task)
+	{
+		// 先に数えておくことで、取り出したワーカーが数を負にすることがない
+		m_pendingCount.fetch_add(1, std::memory_order_release);
+
+		if (isWorkerThread())
+		{
+			Worker& worker = *m_workers[CurrentWorkerIndex()];
+			std::lock_guard lock{ worker.mutex };
+			worker.tasks.push_back(std::move(task));
+		}
+		else
+		{
+			std::lock_guard lock{ m_injectionMutex };
+			m_injectedTasks.push_back(std::move(task));
+		}
+
+		{
+			// 待機に入ろうとしているワーカーが通知を取りこぼさないようにする
+			std::lock_guard lock{ m_sleepMutex };
+		}
+
+		m_sleepCondition.notify_one();
+	}
+
+	inline ThreadPool::TaskPtr ThreadPool::pop(const size_t workerIndex)
+	{
+		if (m_pendingCount.load(std::memory_order_acquire) == 0)
+		{
+			return nullptr;
+		}
+
+		TaskPtr task;
+
+		const auto found = [&]()
+			{
+				m_pendingCount.fetch_sub(1, std::memory_order_relaxed);
+				return std::move(task);
+			};
+
+		const size_t numWorkers = m_workers.size();
+
+		// 自分のキューの末尾（最も新しく、キャッシュに残っている可能性が高いタスク）
+		if (workerIndex < numWorkers)
+		{
+			Worker& worker = *m_workers[workerIndex];
+			std::lock_guard lock{ worker.mutex };
+
+			if (not worker.tasks.empty())
+			{
+				task = std::move(worker.tasks.back());
+				worker.tasks.pop_back();
+				return found();
+			}
+		}
+
+		{
+			std::lock_guard lock{ m_injectionMutex };
+
+			if (not m_injectedTasks.empty())
+			{
+				task = std::move(m_injectedTasks.front());
+				m_injectedTasks.pop_front();
+				return found();
+			}
+		}
+
+		// ほかのワーカーのキューの先頭から盗む
+		for (size_t i = 1; i <= numWorkers; ++i)
+		{
+			const size_t victimIndex = ((workerIndex + i) % numWorkers);
+
+			if (victimIndex == workerIndex)
+			{
+				continue;
+			}
+
+			Worker& victim = *m_workers[victimIndex];
+			std::lock_guard lock{ victim.mutex };
+
+			if (not victim.tasks.empty())
+			{
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				return found();
+			}
+		}
+
+		return nullptr;
+	}
+
+	inline void ThreadPool::workerLoop(const size_t workerIndex)
+	{
+		CurrentPool() = this;
+		CurrentWorkerIndex() = workerIndex;
+
+		for (;;)
+		{
+			if (TaskPtr task = pop(workerIndex))
+			{
+				task->run();
+				continue;
+			}
+
+			std::unique_lock lock{ m_sleepMutex };
+
+			m_sleepCondition.wait(lock, [this]()
+				{
+					return (m_stopping || (m_pendingCount.load(std::memory_order_acquire) != 0));
+				});
+
+			// 終了はキューが空になってから
+			if (m_stopping && (m_pendingCount.load(std::memory_order_acquire) == 0))
+			{
+				return;
+			}
+		}
+	}
+
+	inline size_t& ThreadPool::CurrentWorkerIndex() noexcept
+	{
+		thread_local size_t workerIndex = 0;
+		return workerIndex;
+	}
+
+	inline const ThreadPool*& ThreadPool::CurrentPool() noexcept
+	{
+		thread_local const ThreadPool* pool = nullptr;
+		return pool;
+	}
+
+	inline std::atomic<size_t>& ThreadPool::GlobalWorkerCount() noexcept
+	{
+		static std::atomic<size_t> numWorkers{ 0 };
+		return numWorkers;
+	}
+
+	inline std::atomic<bool>& ThreadPool::GlobalCreated() noexcept
+	{
+		static std::atomic<bool> created{ false };
+		return created;
+	}
+}
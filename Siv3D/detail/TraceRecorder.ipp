@@ -0,0 +1,331 @@
+﻿//-----------------------------------------------
+//
+//	This file is part of the Siv3D Engine.
+//
+//	Copyright (c) 2008-2025 Ryo Suzuki
+//	Copyright (c) 2016-2025 OpenSiv3D Project
+//
+//	Licensed under the MIT License.
+//
+//-----------------------------------------------
+
+# pragma once
+
+namespace s3d
+{
+	namespace detail
+	{
+		inline void AppendTraceNumber(std::string& output, const uint64 value)
+		{
+			char buffer[24];
+			const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+			output.append(buffer, result.ptr);
+		}
+
+		inline void AppendTraceNumber(std::string& output, const int64 value)
+		{
+			char buffer[24];
+			const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+			output.append(buffer, result.ptr);
+		}
+
+		/// @brief ナノ秒をマイクロ秒単位の小数として追加します。
+		inline void AppendTraceMicroseconds(std::string& output, const uint64 nanoseconds)
+		{
+			AppendTraceNumber(output, (nanoseconds / 1000));
+
+			const uint64 fraction = (nanoseconds % 1000);
+			output.push_back('.');
+			output.push_back(static_cast<char>('0' + (fraction / 100)));
+			output.push_back(static_cast<char>('0' + ((fraction / 10) % 10)));
+			output.push_back(static_cast<char>('0' + (fraction % 10)));
+		}
+
+		inline void AppendTraceString(std::string& output, const char* s)
+		{
+			output.push_back('"');
+
+			for (; *s; ++s)
+			{
+				const char ch = *s;
+
+				if ((ch == '"') || (ch == '\\'))
+				{
+					output.push_back('\\');
+					output.push_back(ch);
+				}
+				else if (static_cast<unsigned char>(ch) < 0x20)
+				{
+					output.push_back(' ');
+				}
+				else
+				{
+					output.push_back(ch);
+				}
+			}
+
+			output.push_back('"');
+		}
+	}
+
+	inline void TraceRecorder::Start(const size_t capacity)
+	{
+		State& state = GetState();
+		StopAndWait(state);
+
+		if (state.capacity != capacity)
+		{
+			state.events = std::make_unique<Event[]>(capacity);
+			state.capacity = capacity;
+		}
+
+		state.writeIndex.store(0, std::memory_order_relaxed);
+		state.droppedCount.store(0, std::memory_order_relaxed);
+		state.startTime = Clock::now();
+		state.recording.store(true, std::memory_order_release);
+	}
+
+	inline void TraceRecorder::Stop() noexcept
+	{
+		StopAndWait(GetState());
+	}
+
+	inline bool TraceRecorder::IsRecording() noexcept
+	{
+		return GetState().recording.load(std::memory_order_relaxed);
+	}
+
+	inline void TraceRecorder::Clear()
+	{
+		State& state = GetState();
+		StopAndWait(state);
+		state.events.reset();
+		state.capacity = 0;
+		state.writeIndex.store(0, std::memory_order_relaxed);
+		state.droppedCount.store(0, std::memory_order_relaxed);
+	}
+
+	inline void TraceRecorder::RecordScope(const char* name, const Clock::time_point begin, const Clock::time_point end) noexcept
+	{
+		State& state = GetState();
+
+		// 記録していないときに共有のカウンタを書き換えないよう、先に確認する
+		if (not state.recording.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		const WriteGuard guard{ state };
+
+		if (not guard)
+		{
+			return;
+		}
+
+		// 記録開始をまたぐスコープは開始時刻を切り詰める
+		const auto beginTime = Max(begin, state.startTime);
+		const auto timeNS = std::chrono::duration_cast<std::chrono::nanoseconds>(beginTime - state.startTime).count();
+		const auto durationNS = std::chrono::duration_cast<std::chrono::nanoseconds>(end - beginTime).count();
+
+		Push(state, Event{ name, static_cast<uint64>(timeNS), static_cast<int64>(Max<int64>(durationNS, 0)), GetThreadID(), 'X' });
+	}
+
+	inline void TraceRecorder::MarkFrame(const uint64 frameIndex) noexcept
+	{
+		State& state = GetState();
+
+		if (not state.recording.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		const WriteGuard guard{ state };
+
+		if (not guard)
+		{
+			return;
+		}
+
+		const auto timeNS = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - state.startTime).count();
+
+		Push(state, Event{ "Frame", static_cast<uint64>(timeNS), static_cast<int64>(frameIndex), GetThreadID(), 'i' });
+	}
+
+	inline void TraceRecorder::Counter(const char* name, const int64 value) noexcept
+	{
+		State& state = GetState();
+
+		if (not state.recording.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		const WriteGuard guard{ state };
+
+		if (not guard)
+		{
+			return;
+		}
+
+		const auto timeNS = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - state.startTime).count();
+
+		Push(state, Event{ name, static_cast<uint64>(timeNS), value, GetThreadID(), 'C' });
+	}
+
+	inline size_t TraceRecorder::Count() noexcept
+	{
+		const State& state = GetState();
+		return Min(state.writeIndex.load(std::memory_order_acquire), state.capacity);
+	}
+
+	inline size_t TraceRecorder::DroppedCount() noexcept
+	{
+		return GetState().droppedCount.load(std::memory_order_relaxed);
+	}
+
+	inline std::string TraceRecorder::ToJSON()
+	{
+		std::string output;
+
+		WriteJSON([&](const std::string& chunk)
+			{
+				output.append(chunk);
+			});
+
+		return output;
+	}
+
+	inline bool TraceRecorder::Save(const FilePathView path)
+	{
+		TextWriter writer{ path, TextEncoding::UTF8_NO_BOM };
+
+		if (not writer)
+		{
+			return false;
+		}
+
+		WriteJSON([&](const std::string& chunk)
+			{
+				writer.writeUTF8(chunk);
+			});
+
+		return true;
+	}
+
+	inline TraceRecorder::State& TraceRecorder::GetState() noexcept
+	{
+		static State state;
+		return state;
+	}
+
+	inline uint32 TraceRecorder::GetThreadID() noexcept
+	{
+		static std::atomic<uint32> nextThreadID{ 1 };
+		thread_local const uint32 threadID = nextThreadID.fetch_add(1, std::memory_order_relaxed);
+		return threadID;
+	}
+
+	inline TraceRecorder::WriteGuard::WriteGuard(State& state) noexcept
+		: m_state{ state }
+	{
+		// 書き込み中として数えてから記録中かを確認する。StopAndWait() は逆の順で確認するため、
+		// どちらの順で実行されても、記録の停止後にバッファへ書き込むことはない
+		m_state.activeWriters.fetch_add(1, std::memory_order_seq_cst);
+		m_recording = m_state.recording.load(std::memory_order_seq_cst);
+	}
+
+	inline TraceRecorder::WriteGuard::~WriteGuard()
+	{
+		m_state.activeWriters.fetch_sub(1, std::memory_order_release);
+	}
+
+	inline TraceRecorder::WriteGuard::operator bool() const noexcept
+	{
+		return m_recording;
+	}
+
+	inline void TraceRecorder::StopAndWait(State& state) noexcept
+	{
+		state.recording.store(false, std::memory_order_seq_cst);
+
+		while (state.activeWriters.load(std::memory_order_seq_cst) != 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	inline void TraceRecorder::Push(State& state, const Event& event) noexcept
+	{
+		const size_t index = state.writeIndex.fetch_add(1, std::memory_order_acq_rel);
+
+		if (state.capacity <= index)
+		{
+			state.droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		state.events[index] = event;
+	}
+
+	template <class Writer>
+	inline void TraceRecorder::WriteJSON(Writer&& writer)
+	{
+		// 巨大なトレースでも一度に全体を文字列にしないよう、一定の大きさごとに書き出す
+		constexpr size_t ChunkSize = (64 * 1024);
+
+		const State& state = GetState();
+		const size_t count = Count();
+
+		std::string chunk;
+		chunk.reserve(ChunkSize + 256);
+		chunk.append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const Event& event = state.events[i];
+
+			if (i != 0)
+			{
+				chunk.push_back(',');
+			}
+
+			chunk.append("\n{\"name\":");
+			detail::AppendTraceString(chunk, event.name);
+			chunk.append(",\"ph\":\"");
+			chunk.push_back(event.phase);
+			chunk.append("\",\"pid\":1,\"tid\":");
+			detail::AppendTraceNumber(chunk, static_cast<uint64>(event.threadID));
+			chunk.append(",\"ts\":");
+			detail::AppendTraceMicroseconds(chunk, event.timeNS);
+
+			switch (event.phase)
+			{
+			case 'X':
+				chunk.append(",\"dur\":");
+				detail::AppendTraceMicroseconds(chunk, static_cast<uint64>(event.value));
+				break;
+			case 'C':
+				chunk.append(",\"args\":{\"value\":");
+				detail::AppendTraceNumber(chunk, event.value);
+				chunk.push_back('}');
+				break;
+			default:
+				chunk.append(",\"s\":\"g\",\"args\":{\"frame\":");
+				detail::AppendTraceNumber(chunk, event.value);
+				chunk.push_back('}');
+				break;
+			}
+
+			chunk.push_back('}');
+
+			if (ChunkSize <= chunk.size())
+			{
+				writer(chunk);
+				chunk.clear();
+			}
+		}
+
+		chunk.append("\n]}\n");
+		writer(chunk);
+	}
+}
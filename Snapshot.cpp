@@ -0,0 +1,406 @@
+﻿# include <Siv3D/BinaryReader.hpp>
+# include <Siv3D/BinaryWriter.hpp>
+# include <Siv3D/Compression.hpp>
+# include <Siv3D/Zlib.hpp>
+# include "Snapshot.hpp"
+
+namespace
+{
+	// Changed bytes separated by fewer unchanged bytes than this are merged into one run,
+	// since a new pair of run lengths would cost about as much as the bytes it skips
+	constexpr size_t MinUnchangedRun = 4;
+
+	constexpr size_t MaxVarintBytes = 10;
+
+	struct SnapshotFileHeader
+	{
+		static constexpr s3d::uint32 MagicNumber = 0x50414E53; // "SNAP"
+
+		static constexpr s3d::uint16 CurrentVersion = 1;
+
+		s3d::uint32 magic = MagicNumber;
+
+		s3d::uint16 version = CurrentVersion;
+
+		SnapshotCompression compression = SnapshotCompression::None;
+
+		s3d::uint8 unused = 0;
+
+		// Size of the snapshot before compression
+		s3d::uint64 size = 0;
+	};
+
+	// The header is written as raw bytes, so it must not contain padding
+	static_assert(sizeof(SnapshotFileHeader) == 16);
+
+	[[nodiscard]]
+	s3d::uint64 Load64(const s3d::Byte* p) noexcept
+	{
+		s3d::uint64 value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	// Length of the run of equal bytes of a and b starting at i
+	[[nodiscard]]
+	size_t EqualRun(const s3d::Byte* a, const s3d::Byte* b, const size_t i, const size_t size) noexcept
+	{
+		size_t k = i;
+
+		while (((k + 8) <= size) && (Load64(a + k) == Load64(b + k)))
+		{
+			k += 8;
+		}
+
+		while ((k < size) && (a[k] == b[k]))
+		{
+			++k;
+		}
+
+		return (k - i);
+	}
+
+	s3d::Byte* WriteVarint(s3d::Byte* p, size_t value) noexcept
+	{
+		while (0x80 <= value)
+		{
+			*p++ = static_cast<s3d::Byte>((value & 0x7F) | 0x80);
+			value >>= 7;
+		}
+
+		*p++ = static_cast<s3d::Byte>(value);
+		return p;
+	}
+
+	[[nodiscard]]
+	bool ReadVarint(const s3d::Byte*& p, const s3d::Byte* const end, size_t& value) noexcept
+	{
+		value = 0;
+
+		for (s3d::int32 shift = 0; (p < end) && (shift < 64); shift += 7)
+		{
+			const s3d::uint8 byte = static_cast<s3d::uint8>(*p++);
+			value |= (static_cast<size_t>(byte & 0x7F) << shift);
+
+			if ((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+SnapshotWriter::SnapshotWriter(s3d::Blob& blob)
+	: m_blob{ blob }
+{
+	m_blob.clear();
+}
+
+SnapshotReader::SnapshotReader(const s3d::Blob& blob)
+	: m_blob{ blob } {}
+
+size_t SnapshotReader::remaining() const noexcept
+{
+	return (m_blob.size() - m_pos);
+}
+
+bool SnapshotReader::take(void* dst, const size_t size)
+{
+	if (remaining() < size)
+	{
+		return false;
+	}
+
+	std::memcpy(dst, (m_blob.data() + m_pos), size);
+	m_pos += size;
+	return true;
+}
+
+bool EncodeSnapshotDelta(const s3d::Blob& from, const s3d::Blob& to, s3d::Blob& delta)
+{
+	if (from.size() != to.size())
+	{
+		return false;
+	}
+
+	const size_t size = to.size();
+	const s3d::Byte* a = from.data();
+	const s3d::Byte* b = to.data();
+
+	// Encoded through a local buffer; growing the blob up front would zero-fill more than the delta usually takes
+	s3d::Byte buffer[1024];
+	size_t used = 0;
+	delta.clear();
+
+	for (size_t i = 0; i < size;)
+	{
+		const size_t unchanged = EqualRun(a, b, i, size);
+		const size_t first = (i + unchanged);
+
+		if (first == size)
+		{
+			// Trailing unchanged bytes are implied
+			break;
+		}
+
+		size_t last = first;
+
+		while (last < size)
+		{
+			if (a[last] != b[last])
+			{
+				++last;
+				continue;
+			}
+
+			const size_t run = EqualRun(a, b, last, size);
+
+			if ((MinUnchangedRun <= run) || ((last + run) == size))
+			{
+				break;
+			}
+
+			last += run;
+		}
+
+		if ((sizeof(buffer) - used) < (MaxVarintBytes * 2))
+		{
+			delta.append(buffer, used);
+			used = 0;
+		}
+
+		used = (WriteVarint((buffer + used), unchanged) - buffer);
+		used = (WriteVarint((buffer + used), (last - first)) - buffer);
+
+		for (size_t k = first; k < last; ++k)
+		{
+			if (used == sizeof(buffer))
+			{
+				delta.append(buffer, used);
+				used = 0;
+			}
+
+			buffer[used++] = (a[k] ^ b[k]);
+		}
+
+		i = last;
+	}
+
+	delta.append(buffer, used);
+	return true;
+}
+
+bool ApplySnapshotDelta(const s3d::Blob& delta, s3d::Blob& snapshot)
+{
+	const s3d::Byte* p = delta.data();
+	const s3d::Byte* const end = (p + delta.size());
+	s3d::Byte* dst = snapshot.data();
+	const size_t size = snapshot.size();
+	size_t pos = 0;
+
+	while (p < end)
+	{
+		size_t unchanged, changed;
+
+		if ((not ReadVarint(p, end, unchanged))
+			|| (not ReadVarint(p, end, changed))
+			|| (static_cast<size_t>(end - p) < changed)
+			|| ((size - pos) < unchanged)
+			|| ((size - pos - unchanged) < changed))
+		{
+			return false;
+		}
+
+		pos += unchanged;
+
+		for (size_t k = 0; k < changed; ++k)
+		{
+			dst[pos + k] ^= p[k];
+		}
+
+		p += changed;
+		pos += changed;
+	}
+
+	return true;
+}
+
+SnapshotRing::SnapshotRing(const size_t capacity)
+	: m_entries(capacity) {}
+
+void SnapshotRing::push(const s3d::Blob& snapshot)
+{
+	if (m_entries.isEmpty())
+	{
+		return;
+	}
+
+	if (m_count == 0)
+	{
+		m_latest = snapshot;
+		m_count = 1;
+		return;
+	}
+
+	// When the ring is full, the slot after the newest one holds the oldest snapshot, which is dropped
+	m_newest = ((m_newest + 1) % m_entries.size());
+	Entry& entry = m_entries[m_newest];
+
+	if (EncodeSnapshotDelta(snapshot, m_latest, entry.toPrevious))
+	{
+		entry.isDelta = true;
+	}
+	else
+	{
+		entry.toPrevious = m_latest;
+		entry.isDelta = false;
+	}
+
+	m_latest = snapshot;
+	m_count = s3d::Min((m_count + 1), m_entries.size());
+}
+
+bool SnapshotRing::rewind()
+{
+	if (m_count < 2)
+	{
+		return false;
+	}
+
+	Entry& entry = m_entries[m_newest];
+
+	if (entry.isDelta)
+	{
+		ApplySnapshotDelta(entry.toPrevious, m_latest);
+	}
+	else
+	{
+		// Swapping keeps the capacity of both buffers
+		std::swap(m_latest, entry.toPrevious);
+	}
+
+	m_newest = ((m_newest + m_entries.size() - 1) % m_entries.size());
+	--m_count;
+	return true;
+}
+
+const s3d::Blob& SnapshotRing::latest() const noexcept
+{
+	return m_latest;
+}
+
+size_t SnapshotRing::size() const noexcept
+{
+	return m_count;
+}
+
+size_t SnapshotRing::capacity() const noexcept
+{
+	return m_entries.size();
+}
+
+bool SnapshotRing::isEmpty() const noexcept
+{
+	return (m_count == 0);
+}
+
+void SnapshotRing::clear()
+{
+	m_newest = 0;
+	m_count = 0;
+}
+
+size_t SnapshotRing::storedBytes() const noexcept
+{
+	size_t bytes = ((m_count == 0) ? 0 : m_latest.size());
+
+	for (size_t i = 1; i < m_count; ++i)
+	{
+		bytes += m_entries[(m_newest + m_entries.size() - i + 1) % m_entries.size()].toPrevious.size();
+	}
+
+	return bytes;
+}
+
+bool SaveSnapshot(const s3d::FilePathView path, const s3d::Blob& snapshot, const SnapshotCompression compression)
+{
+	SnapshotFileHeader header;
+	header.compression = compression;
+	header.size = snapshot.size();
+
+	s3d::Blob compressed;
+
+	if (compression == SnapshotCompression::Zlib)
+	{
+		compressed = s3d::Zlib::Compress(snapshot);
+	}
+	else if (compression == SnapshotCompression::Zstd)
+	{
+		compressed = s3d::Compression::Compress(snapshot);
+	}
+
+	const s3d::Blob& body = ((compression == SnapshotCompression::None) ? snapshot : compressed);
+
+	if (snapshot && (not body))
+	{
+		return false;
+	}
+
+	s3d::BinaryWriter writer{ path };
+
+	if (not writer)
+	{
+		return false;
+	}
+
+	return (writer.write(header)
+		&& (writer.write(body.data(), body.size()) == static_cast<s3d::int64>(body.size())));
+}
+
+bool LoadSnapshot(const s3d::FilePathView path, s3d::Blob& snapshot)
+{
+	s3d::BinaryReader reader{ path };
+	SnapshotFileHeader header;
+
+	if ((not reader)
+		|| (not reader.read(header))
+		|| (header.magic != SnapshotFileHeader::MagicNumber)
+		|| (header.version != SnapshotFileHeader::CurrentVersion))
+	{
+		return false;
+	}
+
+	const s3d::int64 bodySize = (reader.size() - reader.getPos());
+
+	// An uncompressed body is the snapshot itself
+	if ((header.compression == SnapshotCompression::None) && (static_cast<s3d::uint64>(bodySize) != header.size))
+	{
+		return false;
+	}
+
+	s3d::Blob body(static_cast<size_t>(bodySize));
+
+	if (reader.read(body.data(), static_cast<s3d::int64>(body.size())) != static_cast<s3d::int64>(body.size()))
+	{
+		return false;
+	}
+
+	switch (header.compression)
+	{
+	case SnapshotCompression::None:
+		snapshot = std::move(body);
+		break;
+	case SnapshotCompression::Zlib:
+		snapshot = s3d::Zlib::Decompress(body);
+		break;
+	case SnapshotCompression::Zstd:
+		snapshot = s3d::Compression::Decompress(body);
+		break;
+	default:
+		return false;
+	}
+
+	return (snapshot.size() == header.size);
+}
@@ -0,0 +1,158 @@
+﻿# pragma once
+# include <Siv3D/Array.hpp>
+# include <Siv3D/Blob.hpp>
+
+// Writes plain values into a reusable byte buffer.
+// The buffer keeps its capacity between snapshots, so capturing a state of the same size does not allocate.
+class SnapshotWriter
+{
+public:
+
+	// Clears blob and writes from its start
+	explicit SnapshotWriter(s3d::Blob& blob);
+
+	template <class Type>
+	void write(const Type& value)
+	{
+		static_assert(std::is_trivially_copyable_v<Type>, "Snapshots can only contain trivially copyable values");
+		m_blob.append(&value, sizeof(Type));
+	}
+
+	// Writes the element count followed by the elements
+	template <class Type>
+	void write(const s3d::Array<Type>& values)
+	{
+		static_assert(std::is_trivially_copyable_v<Type>, "Snapshots can only contain trivially copyable values");
+		write(static_cast<s3d::uint64>(values.size()));
+		m_blob.append(values.data(), values.size_bytes());
+	}
+
+private:
+
+	s3d::Blob& m_blob;
+};
+
+// Reads values in the order SnapshotWriter wrote them
+class SnapshotReader
+{
+public:
+
+	explicit SnapshotReader(const s3d::Blob& blob);
+
+	// Returns false without modifying value if the snapshot has too few bytes left
+	template <class Type>
+	bool read(Type& value)
+	{
+		static_assert(std::is_trivially_copyable_v<Type>, "Snapshots can only contain trivially copyable values");
+		return take(&value, sizeof(Type));
+	}
+
+	template <class Type>
+	bool read(s3d::Array<Type>& values)
+	{
+		static_assert(std::is_trivially_copyable_v<Type>, "Snapshots can only contain trivially copyable values");
+		s3d::uint64 count = 0;
+
+		if ((not read(count)) || ((remaining() / sizeof(Type)) < count))
+		{
+			return false;
+		}
+
+		values.resize(static_cast<size_t>(count));
+		return take(values.data(), values.size_bytes());
+	}
+
+	// Number of bytes not read yet
+	[[nodiscard]]
+	size_t remaining() const noexcept;
+
+private:
+
+	const s3d::Blob& m_blob;
+
+	size_t m_pos = 0;
+
+	bool take(void* dst, size_t size);
+};
+
+// A delta between two snapshots of the same size is the XOR of their bytes, stored as alternating
+// runs of unchanged bytes (length only) and changed bytes (length and XORed bytes).
+// Because of the XOR, applying the delta to either snapshot yields the other one.
+
+// Overwrites delta with the delta between from and to; returns false if their sizes differ
+bool EncodeSnapshotDelta(const s3d::Blob& from, const s3d::Blob& to, s3d::Blob& delta);
+
+// Applies delta to snapshot in place; returns false if delta does not fit snapshot
+bool ApplySnapshotDelta(const s3d::Blob& delta, s3d::Blob& snapshot);
+
+// Keeps the most recent snapshots for rewinding.
+// Only the newest snapshot is stored in full; each older one is kept as the delta from the snapshot after it,
+// so a ring covering several seconds of steps costs about as much as the bytes that actually changed.
+class SnapshotRing
+{
+public:
+
+	SnapshotRing() = default;
+
+	explicit SnapshotRing(size_t capacity);
+
+	// Adds snapshot as the newest one, dropping the oldest one when the ring is full
+	void push(const s3d::Blob& snapshot);
+
+	// Discards the newest snapshot so that the one before it becomes latest(); returns false if fewer than two are stored
+	bool rewind();
+
+	// The newest snapshot
+	[[nodiscard]]
+	const s3d::Blob& latest() const noexcept;
+
+	// Number of snapshots that can be restored, including latest()
+	[[nodiscard]]
+	size_t size() const noexcept;
+
+	[[nodiscard]]
+	size_t capacity() const noexcept;
+
+	[[nodiscard]]
+	bool isEmpty() const noexcept;
+
+	void clear();
+
+	// Bytes taken by latest() and the deltas
+	[[nodiscard]]
+	size_t storedBytes() const noexcept;
+
+private:
+
+	struct Entry
+	{
+		// Turns this snapshot back into the one pushed before it: a delta, or that snapshot itself if the size changed
+		s3d::Blob toPrevious;
+
+		bool isDelta = true;
+	};
+
+	s3d::Array<Entry> m_entries;
+
+	size_t m_newest = 0;
+
+	size_t m_count = 0;
+
+	s3d::Blob m_latest;
+};
+
+enum class SnapshotCompression : s3d::uint8
+{
+	None,
+
+	Zlib,
+
+	// s3d::Compression
+	Zstd,
+};
+
+// Writes a snapshot to a file, e.g. for quicksaves; returns false if compression or a write fails
+bool SaveSnapshot(s3d::FilePathView path, const s3d::Blob& snapshot, SnapshotCompression compression = SnapshotCompression::Zstd);
+
+// Reads a snapshot written by SaveSnapshot(); returns false for another file version or if the size does not match the header
+bool LoadSnapshot(s3d::FilePathView path, s3d::Blob& snapshot);
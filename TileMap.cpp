@@ -0,0 +1,403 @@
+﻿# include "TileMap.hpp"
+# include "TileRects.hpp"
+
+namespace
+{
+	[[nodiscard]]
+	size_t ChunkBytes(const TileMapHeader& header) noexcept
+	{
+		return (static_cast<size_t>(header.chunkSize) * header.chunkSize * sizeof(s3d::uint16));
+	}
+}
+
+StreamedTileMap::StreamedTileMap(const s3d::FilePathView path)
+{
+	open(path);
+}
+
+bool StreamedTileMap::open(const s3d::FilePathView path)
+{
+	close();
+
+	// Nothing but the header and chunk table is mapped up front
+	if (not m_file.open(path, s3d::MapAll::No))
+	{
+		return false;
+	}
+
+	const s3d::int64 fileSize = m_file.fileSize();
+
+	if (fileSize < static_cast<s3d::int64>(sizeof(TileMapHeader)))
+	{
+		close();
+		return false;
+	}
+
+	m_file.map(0, sizeof(TileMapHeader));
+	std::memcpy(static_cast<void*>(&m_header), m_file.data(), sizeof(TileMapHeader));
+	m_file.unmap();
+
+	if ((m_header.magic != TileMapHeader::MagicNumber)
+		|| (m_header.version != TileMapHeader::CurrentVersion)
+		|| (m_header.tileSize == 0)
+		|| (m_header.chunkSize == 0))
+	{
+		close();
+		return false;
+	}
+
+	// The chunk grid must cover the map exactly, so that every tile coordinate maps into the chunk table
+	if ((m_header.chunksX != ((static_cast<s3d::uint64>(m_header.width) + m_header.chunkSize - 1) / m_header.chunkSize))
+		|| (m_header.chunksY != ((static_cast<s3d::uint64>(m_header.height) + m_header.chunkSize - 1) / m_header.chunkSize)))
+	{
+		close();
+		return false;
+	}
+
+	// chunkCount * sizeof(uint64) can wrap around for a corrupted header, so the count is compared against what the file can hold
+	const s3d::uint64 chunkCount = (static_cast<s3d::uint64>(m_header.chunksX) * m_header.chunksY);
+	const s3d::uint64 tableCapacity = ((static_cast<s3d::uint64>(fileSize) - sizeof(TileMapHeader)) / sizeof(s3d::uint64));
+
+	if (tableCapacity < chunkCount)
+	{
+		close();
+		return false;
+	}
+
+	const size_t tableBytes = static_cast<size_t>(chunkCount * sizeof(s3d::uint64));
+	m_chunkOffsets.resize(static_cast<size_t>(chunkCount));
+
+	if (tableBytes)
+	{
+		m_file.map(sizeof(TileMapHeader), tableBytes);
+		std::memcpy(m_chunkOffsets.data(), m_file.data(), tableBytes);
+		m_file.unmap();
+	}
+
+	return true;
+}
+
+void StreamedTileMap::close()
+{
+	m_file.close();
+	m_header = TileMapHeader{};
+	m_chunkOffsets.clear();
+	m_chunks.clear();
+}
+
+bool StreamedTileMap::isOpen() const noexcept
+{
+	return (m_header.chunkSize != 0);
+}
+
+StreamedTileMap::operator bool() const noexcept
+{
+	return isOpen();
+}
+
+void StreamedTileMap::update(const s3d::RectF& region, const double margin)
+{
+	if (not isOpen())
+	{
+		return;
+	}
+
+	const s3d::RectF area = region.stretched(margin);
+	const double chunkPixels = (static_cast<double>(m_header.tileSize) * m_header.chunkSize);
+	const s3d::int32 x0 = s3d::Max(static_cast<s3d::int32>(std::floor(area.x / chunkPixels)), 0);
+	const s3d::int32 y0 = s3d::Max(static_cast<s3d::int32>(std::floor(area.y / chunkPixels)), 0);
+	const s3d::int32 x1 = s3d::Min(static_cast<s3d::int32>(std::floor((area.x + area.w) / chunkPixels)), static_cast<s3d::int32>(m_header.chunksX) - 1);
+	const s3d::int32 y1 = s3d::Min(static_cast<s3d::int32>(std::floor((area.y + area.h) / chunkPixels)), static_cast<s3d::int32>(m_header.chunksY) - 1);
+
+	// Release chunks that went out of range
+	for (auto it = m_chunks.begin(); it != m_chunks.end();)
+	{
+		const s3d::Point chunk = it->first;
+
+		if (s3d::InRange(chunk.x, x0, x1) && s3d::InRange(chunk.y, y0, y1))
+		{
+			++it;
+		}
+		else
+		{
+			m_chunks.erase(it++);
+		}
+	}
+
+	for (s3d::int32 y = y0; y <= y1; ++y)
+	{
+		for (s3d::int32 x = x0; x <= x1; ++x)
+		{
+			if (not m_chunks.contains(s3d::Point{ x, y }))
+			{
+				loadChunk(s3d::Point{ x, y });
+			}
+		}
+	}
+}
+
+s3d::uint16 StreamedTileMap::getTile(const s3d::Point tile) const
+{
+	if ((tile.x < 0) || (tile.y < 0)
+		|| (static_cast<s3d::int32>(m_header.width) <= tile.x)
+		|| (static_cast<s3d::int32>(m_header.height) <= tile.y))
+	{
+		return EmptyTile;
+	}
+
+	const s3d::int32 chunkSize = static_cast<s3d::int32>(m_header.chunkSize);
+	const auto it = m_chunks.find(s3d::Point{ (tile.x / chunkSize), (tile.y / chunkSize) });
+
+	if (it == m_chunks.end())
+	{
+		return EmptyTile;
+	}
+
+	return it->second[s3d::Point{ (tile.x % chunkSize), (tile.y % chunkSize) }];
+}
+
+const s3d::HashTable<s3d::Point, s3d::Grid<s3d::uint16>>& StreamedTileMap::chunks() const noexcept
+{
+	return m_chunks;
+}
+
+s3d::Rect StreamedTileMap::chunkRegion(const s3d::Point chunk) const noexcept
+{
+	const s3d::int32 chunkPixels = static_cast<s3d::int32>(m_header.tileSize * m_header.chunkSize);
+	return{ (chunk * chunkPixels), chunkPixels };
+}
+
+s3d::int32 StreamedTileMap::tileSize() const noexcept
+{
+	return static_cast<s3d::int32>(m_header.tileSize);
+}
+
+s3d::int32 StreamedTileMap::chunkSize() const noexcept
+{
+	return static_cast<s3d::int32>(m_header.chunkSize);
+}
+
+s3d::Size StreamedTileMap::size() const noexcept
+{
+	return{ static_cast<s3d::int32>(m_header.width), static_cast<s3d::int32>(m_header.height) };
+}
+
+void StreamedTileMap::loadChunk(const s3d::Point chunk)
+{
+	const s3d::uint64 offset = m_chunkOffsets[static_cast<size_t>(chunk.y) * m_header.chunksX + chunk.x];
+
+	// Chunks without any tile are not stored in the file
+	if (offset == 0)
+	{
+		return;
+	}
+
+	const size_t chunkBytes = ChunkBytes(m_header);
+	const s3d::uint64 fileSize = static_cast<s3d::uint64>(m_file.fileSize());
+
+	// offset comes from the file; offset + chunkBytes could wrap around
+	if ((fileSize < offset) || ((fileSize - offset) < chunkBytes))
+	{
+		return;
+	}
+
+	s3d::Grid<s3d::uint16> tiles(m_header.chunkSize, m_header.chunkSize);
+
+	m_file.map(static_cast<size_t>(offset), chunkBytes);
+	std::memcpy(tiles.data(), m_file.data(), chunkBytes);
+	m_file.unmap();
+
+	m_chunks.emplace(chunk, std::move(tiles));
+}
+
+bool SaveTileMap(const s3d::FilePathView path, const s3d::Grid<s3d::uint16>& tiles, const s3d::int32 tileSize, const s3d::int32 chunkSize)
+{
+	if ((tileSize <= 0) || (chunkSize <= 0))
+	{
+		return false;
+	}
+
+	TileMapHeader header;
+	header.tileSize = static_cast<s3d::uint32>(tileSize);
+	header.chunkSize = static_cast<s3d::uint32>(chunkSize);
+	header.width = static_cast<s3d::uint32>(tiles.width());
+	header.height = static_cast<s3d::uint32>(tiles.height());
+	header.chunksX = ((header.width + header.chunkSize - 1) / header.chunkSize);
+	header.chunksY = ((header.height + header.chunkSize - 1) / header.chunkSize);
+
+	// Copies one chunk out of tiles, padding beyond the map edge with EmptyTile
+	s3d::Array<s3d::uint16> chunkTiles(static_cast<size_t>(chunkSize) * chunkSize);
+	const auto gatherChunk = [&](const s3d::int32 cx, const s3d::int32 cy)
+		{
+			bool hasTile = false;
+
+			for (s3d::int32 y = 0; y < chunkSize; ++y)
+			{
+				for (s3d::int32 x = 0; x < chunkSize; ++x)
+				{
+					const s3d::Point pos{ (cx * chunkSize + x), (cy * chunkSize + y) };
+					const s3d::uint16 tile = (tiles.inBounds(pos) ? tiles[pos] : StreamedTileMap::EmptyTile);
+					chunkTiles[static_cast<size_t>(y) * chunkSize + x] = tile;
+					hasTile |= (tile != StreamedTileMap::EmptyTile);
+				}
+			}
+
+			return hasTile;
+		};
+
+	const size_t chunkBytes = ChunkBytes(header);
+	s3d::Array<s3d::uint64> chunkOffsets(static_cast<size_t>(header.chunksX) * header.chunksY, 0);
+	s3d::uint64 offset = (sizeof(TileMapHeader) + chunkOffsets.size_bytes());
+
+	for (s3d::uint32 cy = 0; cy < header.chunksY; ++cy)
+	{
+		for (s3d::uint32 cx = 0; cx < header.chunksX; ++cx)
+		{
+			if (gatherChunk(cx, cy))
+			{
+				chunkOffsets[static_cast<size_t>(cy) * header.chunksX + cx] = offset;
+				offset += chunkBytes;
+			}
+		}
+	}
+
+	s3d::BinaryWriter writer{ path };
+
+	if (not writer)
+	{
+		return false;
+	}
+
+	// A short write (e.g. a full disk) leaves a truncated file; report it instead of claiming success
+	if ((not writer.write(header))
+		|| (writer.write(chunkOffsets.data(), chunkOffsets.size_bytes()) != static_cast<s3d::int64>(chunkOffsets.size_bytes())))
+	{
+		return false;
+	}
+
+	for (s3d::uint32 cy = 0; cy < header.chunksY; ++cy)
+	{
+		for (s3d::uint32 cx = 0; cx < header.chunksX; ++cx)
+		{
+			if (chunkOffsets[static_cast<size_t>(cy) * header.chunksX + cx])
+			{
+				gatherChunk(cx, cy);
+
+				if (writer.write(chunkTiles.data(), chunkTiles.size_bytes()) != static_cast<s3d::int64>(chunkTiles.size_bytes()))
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+s3d::Array<s3d::Rect> LoadTileMapLevel(const s3d::FilePathView path)
+{
+	StreamedTileMap map{ path };
+
+	if (not map)
+	{
+		return{};
+	}
+
+	const s3d::int32 tileSize = map.tileSize();
+	const s3d::int32 chunkSize = map.chunkSize();
+	map.update(s3d::RectF{ (map.size() * tileSize) });
+
+	s3d::Array<s3d::Rect> rects;
+
+	// Chunks are visited in row-major order so that the rects, and thus the simulation, do not depend on hash table order
+	for (s3d::int32 cy = 0; (cy * chunkSize) < map.size().y; ++cy)
+	{
+		for (s3d::int32 cx = 0; (cx * chunkSize) < map.size().x; ++cx)
+		{
+			const auto it = map.chunks().find(s3d::Point{ cx, cy });
+
+			if (it == map.chunks().end())
+			{
+				continue;
+			}
+
+			// Runs are merged within a chunk only, so that a single chunk is enough to build its rects
+			rects.append(MergeSolidTiles(it->second, [](const s3d::uint16 tile) { return (tile != StreamedTileMap::EmptyTile); },
+				tileSize, map.chunkRegion(it->first).pos));
+		}
+	}
+
+	return rects;
+}
+
+bool ConvertTileMapFromCSV(const s3d::FilePathView csvPath, const s3d::FilePathView outputPath, const s3d::int32 tileSize, const s3d::int32 chunkSize)
+{
+	// Rows are read straight from the mapped file; s3d::CSV would keep every cell as a String
+	s3d::CSVReader reader{ csvPath };
+
+	if (not reader)
+	{
+		return false;
+	}
+
+	s3d::CSVReader::Row row;
+	size_t width = 0;
+	size_t height = 0;
+
+	while (reader.readRow(row))
+	{
+		width = s3d::Max(width, row.size());
+		++height;
+	}
+
+	if (height == 0)
+	{
+		return false;
+	}
+
+	s3d::Grid<s3d::uint16> tiles(width, height, StreamedTileMap::EmptyTile);
+	reader.rewind();
+
+	for (size_t y = 0; reader.readRow(row); ++y)
+	{
+		for (size_t x = 0; x < row.size(); ++x)
+		{
+			tiles[y][x] = row.getOr<s3d::uint16>(x, StreamedTileMap::EmptyTile);
+		}
+	}
+
+	return SaveTileMap(outputPath, tiles, tileSize, chunkSize);
+}
+
+bool ConvertTileMapFromJSON(const s3d::FilePathView jsonPath, const s3d::FilePathView outputPath, const s3d::int32 chunkSize)
+{
+	const s3d::JSON json = s3d::JSON::Load(jsonPath);
+
+	if ((not json) || (not json[U"tiles"].isArray()))
+	{
+		return false;
+	}
+
+	const s3d::int32 tileSize = json[U"tileSize"].getOr<s3d::int32>(0);
+	const s3d::JSON rows = json[U"tiles"];
+	size_t width = 0;
+
+	for (const auto& row : rows.arrayView())
+	{
+		width = s3d::Max(width, row.size());
+	}
+
+	s3d::Grid<s3d::uint16> tiles(width, rows.size(), StreamedTileMap::EmptyTile);
+
+	for (size_t y = 0; y < tiles.height(); ++y)
+	{
+		const s3d::JSON row = rows[y];
+
+		for (size_t x = 0; x < row.size(); ++x)
+		{
+			tiles[y][x] = row[x].getOr<s3d::uint16>(StreamedTileMap::EmptyTile);
+		}
+	}
+
+	return SaveTileMap(outputPath, tiles, tileSize, chunkSize);
+}
@@ -0,0 +1,112 @@
+﻿# pragma once
+# include <Siv3D.hpp>
+
+// Binary tilemap format (little endian)
+//
+//	TileMapHeader
+//	uint64 chunkOffsets[chunksX * chunksY]	// Byte offset of each chunk, 0 for a chunk with no tiles
+//	uint16 tiles[chunkSize * chunkSize]		// One block per non-empty chunk, row-major, padded with 0
+//
+// Chunks are fixed-size so that any of them can be mapped and decoded on its own.
+struct TileMapHeader
+{
+	static constexpr s3d::uint32 MagicNumber = 0x50414D54; // "TMAP"
+
+	static constexpr s3d::uint32 CurrentVersion = 1;
+
+	s3d::uint32 magic = MagicNumber;
+
+	s3d::uint32 version = CurrentVersion;
+
+	// Size of a tile in pixels
+	s3d::uint32 tileSize = 0;
+
+	// Width and height of a chunk in tiles
+	s3d::uint32 chunkSize = 0;
+
+	// Size of the whole map in tiles
+	s3d::uint32 width = 0;
+
+	s3d::uint32 height = 0;
+
+	s3d::uint32 chunksX = 0;
+
+	s3d::uint32 chunksY = 0;
+};
+
+// A tilemap file whose chunks are mapped and decoded only while they are near a region of interest,
+// so that startup time and resident memory do not depend on the size of the level
+class StreamedTileMap
+{
+public:
+
+	// Tile value meaning "no tile"
+	static constexpr s3d::uint16 EmptyTile = 0;
+
+	StreamedTileMap() = default;
+
+	explicit StreamedTileMap(s3d::FilePathView path);
+
+	// Reads the header and chunk table; no chunk is decoded yet
+	bool open(s3d::FilePathView path);
+
+	void close();
+
+	[[nodiscard]]
+	bool isOpen() const noexcept;
+
+	[[nodiscard]]
+	explicit operator bool() const noexcept;
+
+	// Decodes the chunks overlapping region grown by margin pixels and releases the others
+	void update(const s3d::RectF& region, double margin = 0.0);
+
+	// Returns the tile at the given tile coordinates, or EmptyTile if its chunk is not loaded
+	[[nodiscard]]
+	s3d::uint16 getTile(s3d::Point tile) const;
+
+	// Decoded chunks keyed by chunk coordinates
+	[[nodiscard]]
+	const s3d::HashTable<s3d::Point, s3d::Grid<s3d::uint16>>& chunks() const noexcept;
+
+	// Pixel region covered by a chunk
+	[[nodiscard]]
+	s3d::Rect chunkRegion(s3d::Point chunk) const noexcept;
+
+	[[nodiscard]]
+	s3d::int32 tileSize() const noexcept;
+
+	[[nodiscard]]
+	s3d::int32 chunkSize() const noexcept;
+
+	// Size of the whole map in tiles
+	[[nodiscard]]
+	s3d::Size size() const noexcept;
+
+private:
+
+	s3d::MemoryMappedFileView m_file;
+
+	TileMapHeader m_header;
+
+	s3d::Array<s3d::uint64> m_chunkOffsets;
+
+	s3d::HashTable<s3d::Point, s3d::Grid<s3d::uint16>> m_chunks;
+
+	void loadChunk(s3d::Point chunk);
+};
+
+// Writes tiles in the binary tilemap format; returns false if the file cannot be created or a write fails
+bool SaveTileMap(s3d::FilePathView path, const s3d::Grid<s3d::uint16>& tiles, s3d::int32 tileSize, s3d::int32 chunkSize = 64);
+
+// Reads a tilemap file through StreamedTileMap and returns the collision rects of its non-empty tiles in pixels,
+// merged with MergeSolidTiles() within each chunk;
+// tile (0, 0) is at pixel (0, 0). Returns an empty array if the file cannot be opened
+[[nodiscard]]
+s3d::Array<s3d::Rect> LoadTileMapLevel(s3d::FilePathView path);
+
+// Converts a CSV file with one row of tile values per line into the binary tilemap format
+bool ConvertTileMapFromCSV(s3d::FilePathView csvPath, s3d::FilePathView outputPath, s3d::int32 tileSize, s3d::int32 chunkSize = 64);
+
+// Converts a JSON file of the form { "tileSize": 32, "tiles": [ [ 0, 1, ... ], ... ] } into the binary tilemap format
+bool ConvertTileMapFromJSON(s3d::FilePathView jsonPath, s3d::FilePathView outputPath, s3d::int32 chunkSize = 64);
@@ -0,0 +1,93 @@
+﻿# pragma once
+# include <Siv3D/Array.hpp>
+# include <Siv3D/Grid.hpp>
+# include <Siv3D/2DShapes.hpp>
+
+// Merges the solid tiles of a tile map into a small set of rects (greedy meshing).
+// Each run of solid tiles in a row is grown downwards while the rows below contain the same run,
+// so a level needs far fewer collision primitives and draw calls than one rect per tile.
+//
+// tiles		Tile map; a tile is solid when isSolid(tile) returns true
+// tileSize		Size of a tile in pixels
+// offset		Pixel position of tile (0, 0)
+template <class Type, class Predicate>
+[[nodiscard]]
+s3d::Array<s3d::Rect> MergeSolidTiles(const s3d::Grid<Type>& tiles, Predicate isSolid, const s3d::int32 tileSize = 1, const s3d::Point offset = s3d::Point{ 0, 0 })
+{
+	const s3d::int32 width = static_cast<s3d::int32>(tiles.width());
+	const s3d::int32 height = static_cast<s3d::int32>(tiles.height());
+
+	// Tiles that are solid and not yet covered by an emitted rect
+	s3d::Grid<bool> open(tiles.size());
+
+	for (s3d::int32 y = 0; y < height; ++y)
+	{
+		for (s3d::int32 x = 0; x < width; ++x)
+		{
+			open[y][x] = static_cast<bool>(isSolid(tiles[y][x]));
+		}
+	}
+
+	s3d::Array<s3d::Rect> rects;
+
+	for (s3d::int32 y = 0; y < height; ++y)
+	{
+		const bool* row = open[y];
+
+		for (s3d::int32 x = 0; x < width; ++x)
+		{
+			if (not row[x])
+			{
+				continue;
+			}
+
+			// Row run
+			s3d::int32 w = 1;
+
+			while (((x + w) < width) && row[x + w])
+			{
+				++w;
+			}
+
+			// Grow downwards while the next row has the whole run open
+			s3d::int32 h = 1;
+
+			while ((y + h) < height)
+			{
+				const bool* below = open[y + h];
+
+				if (not std::all_of(below + x, below + x + w, [](const bool b) { return b; }))
+				{
+					break;
+				}
+
+				++h;
+			}
+
+			for (s3d::int32 dy = 0; dy < h; ++dy)
+			{
+				std::fill_n(open[y + dy] + x, w, false);
+			}
+
+			rects.emplace_back((offset.x + x * tileSize), (offset.y + y * tileSize), (w * tileSize), (h * tileSize));
+
+			x += (w - 1);
+		}
+	}
+
+	return rects;
+}
+
+// Merges the tiles that are true
+[[nodiscard]]
+inline s3d::Array<s3d::Rect> MergeSolidTiles(const s3d::Grid<bool>& tiles, const s3d::int32 tileSize = 1, const s3d::Point offset = s3d::Point{ 0, 0 })
+{
+	return MergeSolidTiles(tiles, [](const bool tile) { return tile; }, tileSize, offset);
+}
+
+// Merges the tiles that are not 0
+[[nodiscard]]
+inline s3d::Array<s3d::Rect> MergeSolidTiles(const s3d::Grid<s3d::uint8>& tiles, const s3d::int32 tileSize = 1, const s3d::Point offset = s3d::Point{ 0, 0 })
+{
+	return MergeSolidTiles(tiles, [](const s3d::uint8 tile) { return (tile != 0); }, tileSize, offset);
+}